@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/dict.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+
+using SymEngine::Basic;
+using SymEngine::integer;
+using SymEngine::RCP;
+using SymEngine::set_basic;
+using SymEngine::symbol;
+using SymEngine::vec_basic;
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    int N = 1000, K = 500;
+    if (argc == 3) {
+        N = std::atoi(argv[1]);
+        K = std::atoi(argv[2]);
+    }
+
+    // N sums of K terms with the same size and coefficient, which only differ
+    // in the coefficient of `y`, so that comparing them has to walk the terms
+    vec_basic xs;
+    for (int i = 0; i < K; i++) {
+        xs.push_back(symbol("x" + std::to_string(i)));
+    }
+    RCP<const Basic> s = add(xs), y = symbol("y");
+    vec_basic sums;
+    for (int i = 0; i < N; i++) {
+        sums.push_back(add(s, mul(integer(i + 1), y)));
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    set_basic set;
+    for (int r = 0; r < 10; r++) {
+        for (const auto &e : sums) {
+            set.insert(e);
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "set_basic insertion: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < 10; r++) {
+        std::reverse(sums.begin(), sums.end());
+        std::sort(sums.begin(), sums.end(),
+                  [](const RCP<const Basic> &a, const RCP<const Basic> &b) {
+                      return a->__cmp__(*b) < 0;
+                  });
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "sort by __cmp__: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+    std::cout << "number of sums: " << set.size() << std::endl;
+
+    return 0;
+}
@@ -7,9 +7,12 @@
 #include <symengine/mul.h>
 #include <symengine/pow.h>
 #include <symengine/eval_double.h>
+#include <symengine/lambda_double.h>
 
 using SymEngine::Basic;
 using SymEngine::integer;
+using SymEngine::LambdaRealDoubleBytecode;
+using SymEngine::LambdaRealDoubleVisitor;
 using SymEngine::RCP;
 using SymEngine::symbol;
 
@@ -55,8 +58,37 @@ void eval_double_single_dispatch(benchmark::State &state)
     state.SetComplexityN(state.range(0));
 }
 
+// The same expression with sin(x) instead of sin(1), evaluated by a visitor
+// compiled once
+template <typename Visitor>
+void lambda_double_call(benchmark::State &state)
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> e = sin(x);
+    for (int i = 0; i < state.range(0); i++) {
+        e = pow(add(mul(add(e, pow(integer(2), integer(-3))), integer(3)),
+                    integer(1)),
+                div(integer(2), integer(3)));
+    }
+    Visitor v;
+    v.init({x}, *e);
+    double r{0}, d;
+    double xs[] = {1.0};
+    for (auto _ : state) {
+        v.call(&d, xs);
+        r += d;
+    }
+    state.SetComplexityN(state.range(0));
+}
+
 BENCHMARK(eval_double)->Range(1 << 1, 1 << 14)->Complexity();
 BENCHMARK(eval_double_visitor_pattern)->Range(1 << 1, 1 << 14)->Complexity();
 BENCHMARK(eval_double_single_dispatch)->Range(1 << 1, 1 << 14)->Complexity();
+BENCHMARK_TEMPLATE(lambda_double_call, LambdaRealDoubleVisitor)
+    ->Range(1 << 1, 1 << 14)
+    ->Complexity();
+BENCHMARK_TEMPLATE(lambda_double_call, LambdaRealDoubleBytecode)
+    ->Range(1 << 1, 1 << 14)
+    ->Complexity();
 
 BENCHMARK_MAIN();
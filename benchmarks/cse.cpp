@@ -0,0 +1,112 @@
+#include <iostream>
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+
+using SymEngine::add;
+using SymEngine::Basic;
+using SymEngine::integer;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::RCP;
+using SymEngine::sin;
+using SymEngine::symbol;
+using SymEngine::uset_basic;
+using SymEngine::vec_basic;
+using SymEngine::vec_pair;
+
+// Peak resident set size in MB, or 0 if it is not known
+static long peak_memory()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024 * 1024);
+#else
+    return usage.ru_maxrss / 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+static size_t count_nodes(const vec_basic &exprs)
+{
+    uset_basic seen;
+    vec_basic stack(exprs);
+    while (not stack.empty()) {
+        RCP<const Basic> e = stack.back();
+        stack.pop_back();
+        if (seen.insert(e).second) {
+            for (const auto &arg : e->get_args()) {
+                stack.push_back(arg);
+            }
+        }
+    }
+    return seen.size();
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    // A model with N equations, like the right hand side of a large reaction
+    // network: each equation is a sum of K rate terms, which are products of
+    // state variables and shared rate expressions
+    int N = 20000, K = 4;
+    size_t budget = 100000000;
+    if (argc >= 2) {
+        N = std::atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        budget = std::strtoull(argv[2], nullptr, 10);
+    }
+    const int M = N / 4 + 1;
+
+    vec_basic states, rates;
+    for (int i = 0; i < M; i++) {
+        states.push_back(symbol("y" + std::to_string(i)));
+    }
+    for (int i = 0; i < M; i++) {
+        rates.push_back(
+            mul(symbol("k" + std::to_string(i)),
+                pow(sin(add(states[i], states[(i + 1) % M])), integer(2))));
+    }
+    vec_basic exprs;
+    for (int i = 0; i < N; i++) {
+        vec_basic terms;
+        for (int k = 0; k < K; k++) {
+            terms.push_back(mul({integer((i + k) % 5 - 2), rates[(i + k) % M],
+                                 states[(7 * i + k) % M],
+                                 states[(3 * i + 2 * k + 1) % M]}));
+        }
+        exprs.push_back(add(terms));
+    }
+    std::cout << "nodes: " << count_nodes(exprs) << std::endl;
+    std::cout << "memory before cse: " << peak_memory() << "MB" << std::endl;
+
+    vec_pair replacements;
+    vec_basic reduced;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    SymEngine::cse(replacements, reduced, exprs, budget);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "cse: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+    std::cout << "replacements: " << replacements.size() << std::endl;
+    std::cout << "peak memory: " << peak_memory() << "MB" << std::endl;
+
+    return 0;
+}
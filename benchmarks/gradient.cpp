@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+#include <symengine/derivative.h>
+
+using SymEngine::add;
+using SymEngine::Basic;
+using SymEngine::gradient;
+using SymEngine::integer;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::RCP;
+using SymEngine::sin;
+using SymEngine::symbol;
+using SymEngine::vec_basic;
+using SymEngine::vec_sym;
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    int N = 500;
+    if (argc == 2) {
+        N = std::atoi(argv[1]);
+    }
+
+    // A scalar objective of N parameters, whose terms share a weighted sum of
+    // all the parameters
+    vec_sym p;
+    vec_basic terms;
+    for (int i = 0; i < N; i++) {
+        p.push_back(symbol("p" + std::to_string(i)));
+        terms.push_back(mul(integer(i + 1), p.back()));
+    }
+    RCP<const Basic> inner = add(terms);
+    terms.clear();
+    for (int i = 0; i < N; i++) {
+        terms.push_back(
+            mul(sin(mul(p[i], inner)), pow(p[(i + 1) % N], integer(2))));
+    }
+    RCP<const Basic> f = add(terms);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    vec_basic g1 = gradient(f, p);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "gradient: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    vec_basic g2;
+    for (int i = 0; i < N; i++) {
+        g2.push_back(f->diff(p[i]));
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "diff for each parameter: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <memory>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/pool_allocator.h>
+
+using SymEngine::Add;
+using SymEngine::Basic;
+using SymEngine::ExprArena;
+using SymEngine::Integer;
+using SymEngine::integer;
+using SymEngine::Mul;
+using SymEngine::NodePool;
+using SymEngine::Pow;
+using SymEngine::RCP;
+using SymEngine::Symbol;
+using SymEngine::symbol;
+
+// Allocates and frees `n` blocks with the sizes of the most common nodes,
+// `rounds` times, and returns the elapsed time in milliseconds.
+template <typename Alloc, typename Free>
+long time_blocks(Alloc alloc, Free dealloc, size_t n, int rounds)
+{
+    const size_t sizes[] = {sizeof(Integer), sizeof(Symbol), sizeof(Add),
+                            sizeof(Mul), sizeof(Pow)};
+    std::vector<void *> blocks(n);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < n; i++) {
+            blocks[i] = alloc(sizes[i % 5]);
+        }
+        // Free in a different order than allocated, like a real expression
+        // DAG does
+        for (size_t i = 0; i < n; i += 2) {
+            dealloc(blocks[i], sizes[i % 5]);
+        }
+        for (size_t i = 1; i < n; i += 2) {
+            dealloc(blocks[i], sizes[i % 5]);
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+        .count();
+}
+
+long time_expand(int N, bool use_arena)
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+    RCP<const Basic> e, f, r;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    {
+        std::unique_ptr<ExprArena> arena;
+        if (use_arena)
+            arena.reset(new ExprArena());
+        e = pow(add(add(add(x, y), z), w), integer(N));
+        f = mul(e, add(e, w));
+        r = expand(f);
+        e = f = r = RCP<const Basic>();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+        .count();
+}
+
+int main(int argc, char *argv[])
+{
+    int N;
+    if (argc == 2) {
+        N = std::atoi(argv[1]);
+    } else {
+        N = 15;
+    }
+    SymEngine::print_stack_on_segfault();
+
+    const size_t n = 1000000;
+    const int rounds = 10;
+    std::cout << "malloc: "
+              << time_blocks([](size_t s) { return ::operator new(s); },
+                             [](void *p, size_t) { ::operator delete(p); }, n,
+                             rounds)
+              << "ms" << std::endl;
+    NodePool pool;
+    std::cout << "pool:   "
+              << time_blocks([&](size_t s) { return pool.allocate(s); },
+                             [](void *p, size_t s) {
+                                 NodePool::deallocate(p, s);
+                             },
+                             n, rounds)
+              << "ms" << std::endl;
+
+#ifdef WITH_SYMENGINE_POOL_ALLOCATOR
+    std::cout << "expand2 (global pool): " << time_expand(N, false) << "ms"
+              << std::endl;
+    std::cout << "expand2 (ExprArena):   " << time_expand(N, true) << "ms"
+              << std::endl;
+#else
+    std::cout << "expand2 (malloc): " << time_expand(N, false) << "ms"
+              << std::endl;
+    std::cout << "Build with WITH_SYMENGINE_POOL_ALLOCATOR=yes to time expand2 "
+                 "with the node pool"
+              << std::endl;
+#endif
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <chrono>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/functions.h>
+
+using SymEngine::add;
+using SymEngine::Basic;
+using SymEngine::integer;
+using SymEngine::mul;
+using SymEngine::pow;
+using SymEngine::RCP;
+using SymEngine::sin;
+using SymEngine::symbol;
+using SymEngine::vec_basic;
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    int N = 2000;
+    if (argc >= 2) {
+        N = std::atoi(argv[1]);
+    }
+
+    // A sum of terms that share their factors, with a few large coefficients
+    vec_basic syms, terms;
+    for (int i = 0; i < 50; i++) {
+        syms.push_back(symbol("x" + std::to_string(i)));
+    }
+    RCP<const Basic> big = pow(integer(3), integer(200));
+    for (int i = 0; i < N; i++) {
+        RCP<const Basic> t = mul(pow(syms[i % 50], integer(i / 50 + 1)),
+                                 sin(syms[(7 * i) % 50]));
+        RCP<const Basic> c = big;
+        if (i % 10 != 0) {
+            c = integer(i);
+        }
+        terms.push_back(mul(c, t));
+    }
+    RCP<const Basic> e = SymEngine::add(terms);
+
+    std::string cereal_data, compact_data;
+    RCP<const Basic> r;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    cereal_data = e->dumps();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "dumps:          "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms, " << cereal_data.size() << " bytes" << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    compact_data = e->dumps_compact();
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "dumps_compact:  "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms, " << compact_data.size() << " bytes" << std::endl;
+
+    t1 = std::chrono::high_resolution_clock::now();
+    r = Basic::loads(cereal_data);
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "loads:          "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+    if (not eq(*r, *e)) {
+        std::cout << "Round trip failed" << std::endl;
+        return 1;
+    }
+
+    t1 = std::chrono::high_resolution_clock::now();
+    r = Basic::loads(compact_data);
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "loads compact:  "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+    if (not eq(*r, *e)) {
+        std::cout << "Round trip failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -4,6 +4,8 @@
 #include <symengine/series_generic.h>
 
 using SymEngine::Basic;
+using SymEngine::div;
+using SymEngine::exp;
 using SymEngine::Expression;
 using SymEngine::integer;
 using SymEngine::integer_class;
@@ -11,6 +13,8 @@ using SymEngine::map_int_Expr;
 using SymEngine::pow;
 using SymEngine::RCP;
 using SymEngine::rcp_dynamic_cast;
+using SymEngine::sin;
+using SymEngine::sub;
 using SymEngine::Symbol;
 using SymEngine::symbol;
 using SymEngine::UExprDict;
@@ -40,5 +44,25 @@ int main(int argc, char *argv[])
                      .count()
               << "ms" << std::endl;
 
+    // A perturbation style expansion to high order
+    RCP<const Basic> ex
+        = div(exp(sin(x)), sub(sub(integer(1), x), pow(x, integer(2))));
+    t1 = std::chrono::high_resolution_clock::now();
+    UnivariateSeries::series(ex, "x", 200);
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "exp(sin(x))/(1 - x - x**2) to O(x**200): "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+
+    UExprDict q({{0, 1}, {1, 1}, {2, Expression(1) / 2}});
+    t1 = std::chrono::high_resolution_clock::now();
+    UnivariateSeries::pow(q, 300, 300);
+    t2 = std::chrono::high_resolution_clock::now();
+    std::cout << "(1 + x + x**2/2)**300 to O(x**300): "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+
     return 0;
 }
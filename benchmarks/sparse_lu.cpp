@@ -0,0 +1,119 @@
+#include <iostream>
+#include <chrono>
+
+#include <symengine/matrix.h>
+#include <symengine/add.h>
+#include <symengine/mul.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+
+using SymEngine::add;
+using SymEngine::Basic;
+using SymEngine::CSRMatrix;
+using SymEngine::DenseMatrix;
+using SymEngine::integer;
+using SymEngine::mul;
+using SymEngine::RCP;
+using SymEngine::SparseLU;
+using SymEngine::SparseLUAnalysis;
+using SymEngine::symbol;
+using SymEngine::vec_basic;
+
+// The Jacobian of a chain of reactions, where each species also feeds a
+// species further down the chain
+CSRMatrix chain_jacobian(unsigned n)
+{
+    std::vector<unsigned> i, j;
+    vec_basic v;
+    for (unsigned k = 0; k < n; k++) {
+        RCP<const Basic> kf = symbol("kf" + std::to_string(k));
+        RCP<const Basic> kb = symbol("kb" + std::to_string(k));
+        i.push_back(k);
+        j.push_back(k);
+        v.push_back(add(mul(integer(-1), kf), mul(integer(-1), kb)));
+        if (k + 1 < n) {
+            i.push_back(k + 1);
+            j.push_back(k);
+            v.push_back(kf);
+            i.push_back(k);
+            j.push_back(k + 1);
+            v.push_back(kb);
+        }
+        if (k + 7 < n and k % 4 == 0) {
+            i.push_back(k + 7);
+            j.push_back(k);
+            v.push_back(symbol("c" + std::to_string(k)));
+        }
+    }
+    return CSRMatrix::from_coo(n, n, i, j, v);
+}
+
+DenseMatrix to_dense(const CSRMatrix &A)
+{
+    DenseMatrix D(A.nrows(), A.ncols());
+    for (unsigned i = 0; i < A.nrows(); i++) {
+        for (unsigned j = 0; j < A.ncols(); j++) {
+            D.set(i, j, A.get(i, j));
+        }
+    }
+    return D;
+}
+
+double seconds_since(std::chrono::high_resolution_clock::time_point t)
+{
+    return std::chrono::duration<double>(
+               std::chrono::high_resolution_clock::now() - t)
+        .count();
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    unsigned n = 60;
+    if (argc >= 2) {
+        n = std::atoi(argv[1]);
+    }
+
+    CSRMatrix A = chain_jacobian(n);
+    DenseMatrix D = to_dense(A);
+    DenseMatrix b(n, 1), x(n, 1);
+    for (unsigned i = 0; i < n; i++) {
+        b.set(i, 0, symbol("b" + std::to_string(i)));
+    }
+
+    auto t = std::chrono::high_resolution_clock::now();
+    SparseLUAnalysis analysis(A);
+    std::cout << "analysis:       " << seconds_since(t) << "s, nnz(A) = "
+              << std::get<1>(A.as_vectors()).size()
+              << ", nnz(L+U) = " << analysis.nnz() << std::endl;
+
+    t = std::chrono::high_resolution_clock::now();
+    SparseLU lu(analysis, A);
+    std::cout << "factorization:  " << seconds_since(t) << "s" << std::endl;
+
+    t = std::chrono::high_resolution_clock::now();
+    lu.det();
+    lu.solve(b, x);
+    std::cout << "det + solve:    " << seconds_since(t) << "s" << std::endl;
+
+    t = std::chrono::high_resolution_clock::now();
+    A.det();
+    std::cout << "CSRMatrix::det: " << seconds_since(t) << "s" << std::endl;
+
+    t = std::chrono::high_resolution_clock::now();
+    D.det();
+    std::cout << "DenseMatrix::det: " << seconds_since(t) << "s" << std::endl;
+
+    t = std::chrono::high_resolution_clock::now();
+    A.LU_solve(b, x);
+    std::cout << "CSRMatrix::LU_solve: " << seconds_since(t) << "s"
+              << std::endl;
+
+    t = std::chrono::high_resolution_clock::now();
+    D.LU_solve(b, x);
+    std::cout << "DenseMatrix::LU_solve: " << seconds_since(t) << "s"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <chrono>
+
+#include <symengine/basic.h>
+#include <symengine/add.h>
+#include <symengine/symbol.h>
+#include <symengine/integer.h>
+#include <symengine/mul.h>
+#include <symengine/pow.h>
+#include <symengine/visitor.h>
+
+using SymEngine::Basic;
+using SymEngine::integer;
+using SymEngine::count_ops;
+using SymEngine::RCP;
+using SymEngine::symbol;
+using SymEngine::vec_basic;
+
+template <typename F>
+void timeit(const std::string &name, int repeat, F f)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeat; r++) {
+        f();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::cout << name << ": "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1)
+                     .count()
+              << "ms" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SymEngine::print_stack_on_segfault();
+
+    int N = 100000;
+    if (argc == 2) {
+        N = std::atoi(argv[1]);
+    }
+
+    // A sum of N terms, all of them with a coefficient and most of them
+    // powers, so that get_args() has to create a new object for each term
+    vec_basic terms;
+    RCP<const Basic> y = symbol("y");
+    for (int i = 0; i < N; i++) {
+        RCP<const Basic> x = symbol("x" + std::to_string(i));
+        terms.push_back(mul(integer(i + 2), pow(x, integer(i % 5 + 1))));
+    }
+    RCP<const Basic> e = add(terms);
+    RCP<const Basic> z = symbol("z");
+
+    std::cout << "Sum of " << N << " terms" << std::endl;
+    size_t n = 0;
+    timeit("free_symbols", 10, [&]() { n += free_symbols(*e).size(); });
+    timeit("has_symbol", 10, [&]() { n += has_symbol(*e, *z); });
+    timeit("count_ops", 10, [&]() { n += count_ops({e}); });
+    timeit("has_basic", 10, [&]() { n += has_basic(*e, *z); });
+    timeit("cse", 1, [&]() {
+        SymEngine::vec_pair replacements;
+        vec_basic reduced;
+        SymEngine::cse(replacements, reduced, {e});
+        n += replacements.size();
+    });
+    timeit("atoms<Symbol>", 10, [&]() {
+        n += SymEngine::atoms<SymEngine::Symbol>(*e).size();
+    });
+    timeit("get_args", 10, [&]() { n += e->get_args().size(); });
+    timeit("for_each_arg", 10, [&]() {
+        e->for_each_arg([&](const RCP<const Basic> &p) {
+            n++;
+            return true;
+        });
+    });
+    std::cout << "(" << n << ")" << std::endl;
+
+    return 0;
+}
@@ -62,14 +62,21 @@ namespace SymEngine
  *    the dictionary.
  */
 Add::Add(const RCP<const Number> &coef, umap_basic_num &&dict)
-    : coef_{coef}, dict_{std::move(dict)} {
-                       SYMENGINE_ASSIGN_TYPEID()
-                           SYMENGINE_ASSERT(is_canonical(coef, dict_))}
+    : coef_{coef}, dict_{std::move(dict)}, sorted_terms_{nullptr}
+{
+    SYMENGINE_ASSIGN_TYPEID()
+    SYMENGINE_ASSERT(is_canonical(coef, dict_))
+}
 
-      /**
-       * @details This uses `Basic.hash()` to give a cached version of the hash.
-       */
-      hash_t Add::__hash__() const
+Add::~Add()
+{
+    delete sorted_terms_;
+}
+
+/**
+ * @details This uses `Basic.hash()` to give a cached version of the hash.
+ */
+hash_t Add::__hash__() const
 {
     hash_t seed = SYMENGINE_ADD, temp;
     hash_combine<Basic>(seed, *coef_);
@@ -94,15 +101,50 @@ bool Add::__eq__(const Basic &o) const
     return false;
 }
 
+/**
+ *  @details The terms are sorted once, the first time they are needed, and
+ *   the result is cached. `dict_` never changes after construction, so the
+ *   pointers to its elements stay valid. In the thread safe build, two threads
+ *   may compute the terms concurrently; only the first result is published.
+ */
+const Add::sorted_terms_t &Add::get_sorted_terms() const
+{
+    const sorted_terms_t *terms = sorted_terms_;
+    if (terms != nullptr)
+        return *terms;
+
+    sorted_terms_t *v = new sorted_terms_t();
+    v->reserve(dict_.size());
+    for (const auto &p : dict_) {
+        v->push_back(&p);
+    }
+    std::sort(v->begin(), v->end(),
+              [](const umap_basic_num::value_type *a,
+                 const umap_basic_num::value_type *b) {
+                  return RCPBasicKeyLess()(a->first, b->first);
+              });
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    const sorted_terms_t *expected = nullptr;
+    if (not sorted_terms_.compare_exchange_strong(expected, v)) {
+        delete v;
+        return *expected;
+    }
+#else
+    sorted_terms_ = v;
+#endif
+    return *v;
+}
+
 /**
  *  @details This function takes a `Basic` object, checks if it is an `Add`
  *   object, and subsequently compares exhaustively:
  *    - The number of elements.
  *    - The coefficients.
- *    - Each element of the dictionary.
+ *    - Each element of the dictionary, in the order of `RCPBasicKeyLess`.
  *
- *  @note Since the `map_basic_num` representation is not cached by `Add` after
- *   being computed, this is slow.
+ *  The order is the same as comparing the `map_basic_num` representations of
+ *   both dictionaries, but the sorted terms are cached on each `Add`, so
+ *   repeated comparisons are O(n).
  * */
 int Add::compare(const Basic &o) const
 {
@@ -117,11 +159,18 @@ int Add::compare(const Basic &o) const
     if (cmp != 0)
         return cmp;
 
-    // Compare dictionaries (slow):
-    //!< @todo cache `adict` and `bdict`
-    map_basic_num adict(dict_.begin(), dict_.end());
-    map_basic_num bdict(s.dict_.begin(), s.dict_.end());
-    return unified_compare(adict, bdict);
+    // Compare dictionaries
+    const sorted_terms_t &a = get_sorted_terms();
+    const sorted_terms_t &b = s.get_sorted_terms();
+    for (size_t i = 0; i < a.size(); i++) {
+        cmp = a[i]->first->__cmp__(*b[i]->first);
+        if (cmp != 0)
+            return cmp;
+        cmp = a[i]->second->__cmp__(*b[i]->second);
+        if (cmp != 0)
+            return cmp;
+    }
+    return 0;
 }
 
 /**
@@ -183,8 +232,8 @@ RCP<const Basic> Add::from_dict(const RCP<const Number> &coef,
             } else {
                 insert(m, p->first, one);
             }
-            return make_rcp<const Mul>(p->second,
-                                       std::move(m)); // Returns a Mul from here
+            return make_interned<Mul>(p->second,
+                                      std::move(m)); // Returns a Mul from here
         }
         map_basic_basic m;
         if (is_a_Number(*p->second)) {
@@ -218,14 +267,14 @@ RCP<const Basic> Add::from_dict(const RCP<const Number> &coef,
             } else {
                 insert(m, p->first, one);
             }
-            return make_rcp<const Mul>(p->second, std::move(m));
+            return make_interned<Mul>(p->second, std::move(m));
         } else {
             insert(m, p->first, one);
             insert(m, p->second, one);
-            return make_rcp<const Mul>(one, std::move(m));
+            return make_interned<Mul>(one, std::move(m));
         }
     } else {
-        return make_rcp<const Add>(coef, std::move(d)); // returns an Add
+        return make_interned<Add>(coef, std::move(d)); // returns an Add
     }
 }
 
@@ -383,6 +432,30 @@ bool Add::is_canonical(const RCP<const Number> &coef,
     return true;
 }
 
+/**
+ * @details Passes the same arguments as `get_args()`. Only the coefficient
+ * and the terms with a coefficient of one are passed without allocation,
+ * the other terms are created.
+ */
+bool Add::for_each_arg(
+    const std::function<bool(const RCP<const Basic> &)> &f) const
+{
+    if (not coef_->is_zero()) {
+        if (not f(coef_))
+            return false;
+    }
+    for (const auto &p : dict_) {
+        if (eq(*p.second, *one)) {
+            if (not f(p.first))
+                return false;
+        } else {
+            if (not f(Add::from_dict(zero, {{p.first, p.second}})))
+                return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @details For an `Add` of the form:
  *
@@ -31,6 +31,18 @@ private:
     umap_basic_num dict_;    //!< The expression without its coefficient as a
                              //!< dictionary (e.g. `x+y` in `2+x+y`).
 
+public:
+    typedef std::vector<const umap_basic_num::value_type *> sorted_terms_t;
+
+private:
+    //! The terms of `dict_` sorted by `RCPBasicKeyLess`. Like the hash, it is
+    //! computed on first use and then cached (see `get_sorted_terms()`).
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    mutable std::atomic<const sorted_terms_t *> sorted_terms_;
+#else
+    mutable const sorted_terms_t *sorted_terms_;
+#endif
+
 public:
     IMPLEMENT_TYPEID(SYMENGINE_ADD)
 
@@ -42,6 +54,8 @@ public:
      */
     Add(const RCP<const Number> &coef, umap_basic_num &&dict);
 
+    ~Add() override;
+
     /**
      *  @brief Generates the hash representation.
      *  @see Basic for an implementation to get the cached version.
@@ -138,6 +152,15 @@ public:
      */
     vec_basic get_args() const override;
 
+    /**
+     * @brief Calls `f` on the arguments of the Add, like `get_args()`, until
+     * it returns false.
+     * @details Only the terms with a coefficient other than one are created.
+     * @return false if `f` stopped the iteration.
+     */
+    bool for_each_arg(const std::function<bool(const RCP<const Basic> &)> &f)
+        const override;
+
     //!< @return const reference to the coefficient of the `Add`.
     inline const RCP<const Number> &get_coef() const
     {
@@ -149,6 +172,9 @@ public:
     {
         return dict_;
     }
+
+    //! @return the terms of the dictionary, in the order of `RCPBasicKeyLess`
+    const sorted_terms_t &get_sorted_terms() const;
 };
 
 /**
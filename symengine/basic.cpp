@@ -1,7 +1,9 @@
 #include <symengine/printers.h>
 #include <symengine/subs.h>
+#include <symengine/pool_allocator.h>
 #if HAVE_SYMENGINE_RTTI
 #include <symengine/serialize-cereal.h>
+#include <symengine/serialize-compact.h>
 #endif
 #include <array>
 
@@ -30,6 +32,18 @@ std::string type_code_name(TypeID id)
     return type_names[id];
 }
 
+#ifdef WITH_SYMENGINE_POOL_ALLOCATOR
+void *Basic::operator new(std::size_t size)
+{
+    return current_node_pool().allocate(size);
+}
+
+void Basic::operator delete(void *p, std::size_t size)
+{
+    NodePool::deallocate(p, size);
+}
+#endif
+
 int Basic::__cmp__(const Basic &o) const
 {
     auto a = this->get_type_code();
@@ -64,12 +78,32 @@ std::string Basic::dumps() const
 #endif
 }
 
+std::string Basic::dumps_compact() const
+{
+#if HAVE_SYMENGINE_RTTI
+    std::ostringstream oss;
+    CompactOutputArchive oarchive{oss};
+    oarchive.save_header();
+    oarchive(this->rcp_from_this());
+    return oss.str();
+#else
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+#endif
+}
+
 RCP<const Basic> Basic::loads(const std::string &serialized)
 {
 #if HAVE_SYMENGINE_RTTI
     unsigned short major, minor;
     RCP<const Basic> obj;
     std::istringstream iss(serialized);
+    // The first byte of `dumps()` is the endianness, which is 0 or 1
+    if (is_compact_serialization(serialized)) {
+        CompactInputArchive iarchive{iss};
+        iarchive.load_header();
+        iarchive(obj);
+        return obj;
+    }
     RCPBasicAwareInputArchive<cereal::PortableBinaryInputArchive> iarchive{iss};
     iarchive(major, minor);
     if (major != SYMENGINE_MAJOR_VERSION or minor != SYMENGINE_MINOR_VERSION) {
@@ -102,6 +136,16 @@ const char *get_version()
     return SYMENGINE_VERSION;
 }
 
+bool Basic::for_each_arg(
+    const std::function<bool(const RCP<const Basic> &)> &f) const
+{
+    for (const auto &p : get_args()) {
+        if (not f(p))
+            return false;
+    }
+    return true;
+}
+
 bool is_a_Atom(const Basic &b)
 {
     return is_a_Number(b) or is_a<Symbol>(b) or is_a<Constant>(b);
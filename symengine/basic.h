@@ -122,6 +122,12 @@ public:
     // with undefined behavior while deallocating derived classes.
     virtual ~Basic() {}
 
+#ifdef WITH_SYMENGINE_POOL_ALLOCATOR
+    //! Allocates nodes from the current `NodePool` (see pool_allocator.h)
+    static void *operator new(std::size_t size);
+    static void operator delete(void *p, std::size_t size);
+#endif
+
     //! Delete the copy constructor and assignment
     Basic(const Basic &) = delete;
     //! Assignment operator in continuation with above
@@ -184,7 +190,12 @@ public:
     //! Returns a string of the instance serialized.
     std::string dumps() const;
 
-    //! Creates an instance of a serialized string.
+    //! Returns a string of the instance serialized in the compact format
+    //! (see `serialize-compact.h`), which is smaller and faster to read.
+    std::string dumps_compact() const;
+
+    //! Creates an instance of a serialized string. Both the output of
+    //! `dumps()` and of `dumps_compact()` are accepted.
     static RCP<const Basic> loads(const std::string &);
 
     //! Substitutes 'subs_dict' into 'self'.
@@ -201,6 +212,16 @@ public:
     //! Returns the list of arguments
     virtual vec_basic get_args() const = 0;
 
+    /*! Calls `f` on each element of `get_args()`, in the same order, without
+        building the vector, until `f` returns false. Returns false if it
+        stopped that way. Classes that store their arguments override it so
+        that no object is allocated. `Add` and `Mul` still have to create the
+        terms whose coefficient or exponent is not one; `ArgView` walks them
+        without creating them.
+    */
+    virtual bool
+    for_each_arg(const std::function<bool(const RCP<const Basic> &)> &f) const;
+
     SYMENGINE_INCLUDE_METHODS_BASE()
 
     RCP<const Basic> diff(const RCP<const Symbol> &x, bool cache = true) const;
@@ -268,6 +289,10 @@ bool is_same_type(const Basic &a, const Basic &b);
 
 //! Expands `self`
 RCP<const Basic> expand(const RCP<const Basic> &self, bool deep = true);
+//! Expands `self`, splitting the expansion of large products and powers
+//! among `nthreads` threads (requires `WITH_OPENMP`, serial otherwise)
+RCP<const Basic> expand(const RCP<const Basic> &self, bool deep,
+                        unsigned nthreads);
 void as_numer_denom(const RCP<const Basic> &x,
                     const Ptr<RCP<const Basic>> &numer,
                     const Ptr<RCP<const Basic>> &denom);
@@ -280,9 +305,11 @@ RCP<const Basic> rewrite_as_sin(const RCP<const Basic> &x);
 RCP<const Basic> rewrite_as_cos(const RCP<const Basic> &x);
 
 // Common subexpression elimination of symbolic expressions
-// Return a vector of replacement pairs and a vector of reduced exprs
+// Return a vector of replacement pairs and a vector of reduced exprs.
+// `match_budget` bounds the work spent looking for arguments shared by several
+// Adds or Muls, which grows quadratically with their number; 0 means no bound.
 void cse(vec_pair &replacements, vec_basic &reduced_exprs,
-         const vec_basic &exprs);
+         const vec_basic &exprs, size_t match_budget = 100000000);
 
 /*! This `<<` overloaded function simply calls `p.__str__`, so it allows any
    Basic
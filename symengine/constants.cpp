@@ -109,9 +109,25 @@ struct storage_for {
 DEFINE_CONSTANTS
 #undef DEFINE_CONSTANT
 
+// The small Integers returned by integer() are created before and destroyed
+// after the constants above, which are built from them.
+static storage_for<RCP<const Integer>>
+    integer_cache_buf[integer_cache_max - integer_cache_min + 1];
+
+const RCP<const Integer> &cached_integer(long i)
+{
+    SYMENGINE_ASSERT(in_integer_cache(i))
+    return reinterpret_cast<RCP<const Integer> &>(
+        integer_cache_buf[i - integer_cache_min]);
+}
+
 ConstantInitializer::ConstantInitializer()
 {
     if (nifty_counter++ == 0) {
+        for (long j = integer_cache_min; j <= integer_cache_max; j++) {
+            new (&integer_cache_buf[j - integer_cache_min])
+                RCP<const Integer>(make_rcp<const Integer>(integer_class(j)));
+        }
 #define DEFINE_CONSTANT(t, n, d) new (&n) RCP<const t>(d);
         DEFINE_CONSTANTS
 #undef DEFINE_CONSTANT
@@ -124,6 +140,11 @@ ConstantInitializer::~ConstantInitializer()
 #define DEFINE_CONSTANT(t, n, d) n.~RCP();
         DEFINE_CONSTANTS
 #undef DEFINE_CONSTANT
+        for (long j = integer_cache_min; j <= integer_cache_max; j++) {
+            reinterpret_cast<RCP<const Integer> &>(
+                integer_cache_buf[j - integer_cache_min])
+                .~RCP();
+        }
     }
 }
 
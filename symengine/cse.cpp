@@ -4,11 +4,13 @@
 #include <symengine/functions.h>
 #include <symengine/visitor.h>
 
+#include <algorithm>
+#include <limits>
 #include <queue>
 
 namespace SymEngine
 {
-umap_basic_basic opt_cse(const vec_basic &exprs);
+umap_basic_basic opt_cse(const vec_basic &exprs, size_t match_budget);
 void tree_cse(vec_pair &replacements, vec_basic &reduced_exprs,
               const vec_basic &exprs, umap_basic_basic &opt_subs);
 
@@ -70,67 +72,46 @@ public:
     }
 
     /*
-       Return a dict whose keys are function numbers. The entries of the dict
-       are the number of arguments said function has in common with `argset`.
-       Entries have at least 2 items in common.
+       Return the function numbers that have at least 2 arguments in common
+       with `argset`, together with the number of arguments in common, sorted
+       by that number and then by function number. The number of function
+       numbers looked at is subtracted from `budget`; the search stops early
+       if it runs out.
     */
-    std::map<unsigned, unsigned>
-    get_common_arg_candidates(std::set<unsigned> &argset, unsigned min_func_i)
+    std::vector<std::pair<unsigned, unsigned>>
+    get_common_arg_candidates(const std::set<unsigned> &argset,
+                              unsigned min_func_i, size_t &budget)
     {
-        std::map<unsigned, unsigned> count_map;
-        std::vector<std::set<unsigned>> funcsets;
+        std::unordered_map<unsigned, unsigned> count_map;
         for (unsigned arg : argset) {
-            funcsets.push_back(arg_to_funcset[arg]);
-        }
-        // Sorted by size to make best use of the performance hack below.
-        std::sort(funcsets.begin(), funcsets.end(),
-                  [](const std::set<unsigned> &a, const std::set<unsigned> &b) {
-                      return a.size() < b.size();
-                  });
-
-        for (unsigned i = 0; i < funcsets.size(); i++) {
-            auto &funcset = funcsets[i];
-            for (unsigned func_i : funcset) {
-                if (func_i >= min_func_i) {
-                    count_map[func_i] += 1;
-                }
+            const auto &funcset = arg_to_funcset[arg];
+            if (funcset.size() > budget) {
+                budget = 0;
+                break;
+            }
+            budget -= funcset.size();
+            for (auto it = funcset.lower_bound(min_func_i); it != funcset.end();
+                 ++it) {
+                count_map[*it] += 1;
             }
         }
 
-        /*auto &largest_funcset = funcsets[funcsets.size() - 1];
-
-        // We pick the smaller of the two containers to iterate over to
-        // reduce the number of items we have to look at.
-
-        if (largest_funcset.size() < count_map.size()) {
-            for (unsigned func_i : largest_funcset) {
-                if (count_map[func_i] < 1) {
-                    continue;
-                }
-                if (count_map.find(func_i) != count_map.end()) {
-                    count_map[func_i] += 1;
-                }
-            }
-        } else {
-            for (auto &count_map_pair : count_map) {
-                unsigned func_i = count_map_pair.first;
-                if (count_map[func_i] < 1) {
-                    continue;
-                }
-                if (largest_funcset.find(func_i) != largest_funcset.end()) {
-                    count_map[func_i] += 1;
-                }
-            }
-        }*/
-        auto iter = count_map.begin();
-        for (; iter != count_map.end();) {
-            if (iter->second >= 2) {
-                ++iter;
-            } else {
-                count_map.erase(iter++);
+        std::vector<std::pair<unsigned, unsigned>> candidates;
+        for (const auto &p : count_map) {
+            if (p.second >= 2) {
+                candidates.push_back(p);
             }
         }
-        return count_map;
+        // This makes us try combining smaller matches first.
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::pair<unsigned, unsigned> &a,
+                     const std::pair<unsigned, unsigned> &b) {
+                      if (a.second == b.second) {
+                          return a.first < b.first;
+                      }
+                      return a.second < b.second;
+                  });
+        return candidates;
     }
 
     template <typename Container1, typename Container2>
@@ -199,8 +180,13 @@ void add_to_sorted_vec(std::vector<unsigned> &vec, unsigned number)
     }
 }
 
+// Finds arguments that several Adds (or Muls) have in common, and rewrites
+// the functions to use them as a single subexpression. Looking for the
+// candidates is quadratic in the number of functions in the worst case, so
+// it stops once `budget` is used up; the functions that were already
+// rewritten are kept.
 void match_common_args(const std::string &func_class, const vec_basic &funcs_,
-                       umap_basic_basic &opt_subs)
+                       umap_basic_basic &opt_subs, size_t &budget)
 {
     std::vector<std::pair<RCP<const Basic>, vec_basic>> funcs;
     for (auto &b : funcs_) {
@@ -214,31 +200,17 @@ void match_common_args(const std::string &func_class, const vec_basic &funcs_,
 
     auto arg_tracker = FuncArgTracker(funcs);
 
-    std::set<unsigned> changed;
-    std::map<unsigned, unsigned> common_arg_candidates_counts;
+    std::vector<bool> changed(funcs.size(), false);
 
     for (unsigned i = 0; i < funcs.size(); i++) {
-        common_arg_candidates_counts = arg_tracker.get_common_arg_candidates(
-            arg_tracker.func_to_argset[i], i + 1);
-
         std::deque<unsigned> common_arg_candidates;
-        for (auto it = common_arg_candidates_counts.begin();
-             it != common_arg_candidates_counts.end(); ++it) {
-            common_arg_candidates.push_back(it->first);
+        if (budget > 0) {
+            for (const auto &p : arg_tracker.get_common_arg_candidates(
+                     arg_tracker.func_to_argset[i], i + 1, budget)) {
+                common_arg_candidates.push_back(p.first);
+            }
         }
 
-        // Sort the candidates in order of match size.
-        // This makes us try combining smaller matches first.
-        std::sort(common_arg_candidates.begin(), common_arg_candidates.end(),
-                  [&](unsigned a, unsigned b) {
-                      if (common_arg_candidates_counts[a]
-                          == common_arg_candidates_counts[b]) {
-                          return a < b;
-                      }
-                      return common_arg_candidates_counts[a]
-                             < common_arg_candidates_counts[b];
-                  });
-
         while (common_arg_candidates.size() > 0) {
             unsigned j = common_arg_candidates.front();
             common_arg_candidates.pop_front();
@@ -269,7 +241,7 @@ void match_common_args(const std::string &func_class, const vec_basic &funcs_,
                 com_func_number = arg_tracker.get_or_add_value_number(com_func);
                 add_to_sorted_vec(diff_i, com_func_number);
                 arg_tracker.update_func_argset(i, diff_i);
-                changed.insert(i);
+                changed[i] = true;
 
             } else {
                 // Treat the whole expression as a CSE.
@@ -288,7 +260,7 @@ void match_common_args(const std::string &func_class, const vec_basic &funcs_,
                 = set_diff(arg_tracker.func_to_argset[j], com_args);
             add_to_sorted_vec(diff_j, com_func_number);
             arg_tracker.update_func_argset(j, diff_j);
-            changed.insert(j);
+            changed[j] = true;
 
             for (unsigned k : arg_tracker.get_subset_candidates(
                      com_args, common_arg_candidates)) {
@@ -296,10 +268,10 @@ void match_common_args(const std::string &func_class, const vec_basic &funcs_,
                     = set_diff(arg_tracker.func_to_argset[k], com_args);
                 add_to_sorted_vec(diff_k, com_func_number);
                 arg_tracker.update_func_argset(k, diff_k);
-                changed.insert(k);
+                changed[k] = true;
             }
         }
-        if (std::find(changed.begin(), changed.end(), i) != changed.end()) {
+        if (changed[i]) {
             opt_subs[funcs[i].first] = function_symbol(
                 func_class, arg_tracker.get_args_in_value_order(
                                 arg_tracker.func_to_argset[i]));
@@ -308,69 +280,113 @@ void match_common_args(const std::string &func_class, const vec_basic &funcs_,
     }
 }
 
-class OptsCSEVisitor : public BaseVisitor<OptsCSEVisitor>
+// A set of expressions compared by value. The terms and factors that Add and
+// Mul do not store are inserted as views, without creating them.
+class ArgViewSet
+{
+private:
+    std::unordered_multimap<hash_t, ArgView> views_;
+
+public:
+    // Inserts `a` and returns true, or returns false if it is already there
+    bool insert(const ArgView &a)
+    {
+        const hash_t h = a.hash();
+        auto range = views_.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.equals(a)) {
+                return false;
+            }
+        }
+        views_.emplace(h, a);
+        return true;
+    }
+};
+
+// Finds the Adds and Muls whose arguments can be shared, and the Pows and
+// Muls with a negative exponent or coefficient. The expressions are walked
+// in the same order as a recursive visitor would, with an explicit stack so
+// that deep expressions do not overflow the call stack.
+class OptsCSEFinder
 {
 public:
     umap_basic_basic &opt_subs;
+    // Ordered, so that the result does not depend on the bucket order of a
+    // hash set
     set_basic adds;
     set_basic muls;
-    set_basic seen_subexp;
-    OptsCSEVisitor(umap_basic_basic &opt_subs_) : opt_subs(opt_subs_) {}
-    bool is_seen(const Basic &expr)
-    {
-        return (seen_subexp.find(expr.rcp_from_this()) != seen_subexp.end());
-    }
-    void bvisit(const Derivative &x)
-    {
-        return;
-    }
-    void bvisit(const Subs &x)
+    ArgViewSet seen_subexp;
+    OptsCSEFinder(umap_basic_basic &opt_subs_) : opt_subs(opt_subs_) {}
+    void apply(const RCP<const Basic> &root)
     {
-        return;
-    }
-    void bvisit(const Add &x)
-    {
-        if (not is_seen(x)) {
-            seen_subexp.insert(x.rcp_from_this());
-            for (const auto &p : x.get_args()) {
-                p->accept(*this);
+        // Each entry is a node, and whether its arguments were walked
+        std::vector<std::pair<ArgView, bool>> stack;
+        stack.emplace_back(ArgView(root), false);
+        while (not stack.empty()) {
+            ArgView expr = std::move(stack.back().first);
+            const bool args_done = stack.back().second;
+            stack.pop_back();
+            if (args_done) {
+                finish(expr);
+                continue;
+            }
+            if (expr.is_stored()
+                and (is_a<Derivative>(expr.stored()) or is_a<Subs>(expr.stored())
+                     or is_a_Atom(expr.stored()))) {
+                continue;
             }
-            adds.insert(x.rcp_from_this());
+            if (not seen_subexp.insert(expr)) {
+                continue;
+            }
+            const TypeID type = expr.get_type_code();
+            if (type == SYMENGINE_ADD or type == SYMENGINE_MUL
+                or type == SYMENGINE_POW) {
+                stack.emplace_back(expr, true);
+            }
+            // The arguments are pushed in reverse, so that they are walked
+            // in order
+            const size_t n = stack.size();
+            expr.for_each_arg([&stack](const ArgView &arg) {
+                stack.emplace_back(arg, false);
+                return true;
+            });
+            std::reverse(stack.begin() + n, stack.end());
         }
     }
-    void bvisit(const Pow &x)
+
+private:
+    // Called on an Add, Mul or Pow once its arguments are walked. Only the
+    // Pows with a negative exponent are created if they are not stored.
+    void finish(const ArgView &view)
     {
-        if (not is_seen(x)) {
-            auto expr = x.rcp_from_this();
-            seen_subexp.insert(expr);
-            for (const auto &p : x.get_args()) {
-                p->accept(*this);
-            }
-            auto ex = x.get_exp();
+        const TypeID type = view.get_type_code();
+        if (type == SYMENGINE_ADD) {
+            adds.insert(view.get());
+        } else if (type == SYMENGINE_POW) {
+            // The arguments of a Pow are its base and its exponent
+            RCP<const Basic> base, exp;
+            view.for_each_arg([&base, &exp](const ArgView &arg) {
+                (base.is_null() ? base : exp) = arg.get();
+                return true;
+            });
+            auto ex = exp;
             if (is_a<Mul>(*ex)) {
                 ex = static_cast<const Mul &>(*ex).get_coef();
             }
             if (is_a_Number(*ex)
                 and static_cast<const Number &>(*ex).is_negative()) {
-                vec_basic v({pow(x.get_base(), neg(x.get_exp())), integer(-1)});
-                opt_subs[expr] = function_symbol("pow", v);
-            }
-        }
-    }
-    void bvisit(const Mul &x)
-    {
-        if (not is_seen(x)) {
-            auto expr = x.rcp_from_this();
-            seen_subexp.insert(expr);
-            for (const auto &p : x.get_args()) {
-                p->accept(*this);
+                vec_basic v({pow(base, neg(exp)), integer(-1)});
+                opt_subs[view.get()] = function_symbol("pow", v);
             }
+        } else {
+            RCP<const Basic> expr = view.get();
+            const Mul &x = down_cast<const Mul &>(*expr);
             if (x.get_coef()->is_negative()) {
-                auto neg_expr = neg(x.rcp_from_this());
+                auto neg_expr = neg(expr);
                 if (not is_a<Symbol>(*neg_expr)) {
                     opt_subs[expr]
                         = function_symbol("mul", {integer(-1), neg_expr});
-                    seen_subexp.insert(neg_expr);
+                    seen_subexp.insert(ArgView(neg_expr));
                     expr = neg_expr;
                 }
             }
@@ -379,17 +395,6 @@ public:
             }
         }
     }
-    void bvisit(const Basic &x)
-    {
-        auto v = x.get_args();
-        if (v.size() > 0 and not is_seen(x)) {
-            auto expr = x.rcp_from_this();
-            seen_subexp.insert(expr);
-            for (const auto &p : v) {
-                p->accept(*this);
-            }
-        }
-    }
 };
 
 vec_basic set_as_vec(const set_basic &s)
@@ -401,18 +406,21 @@ vec_basic set_as_vec(const set_basic &s)
     return result;
 }
 
-umap_basic_basic opt_cse(const vec_basic &exprs)
+umap_basic_basic opt_cse(const vec_basic &exprs, size_t match_budget)
 {
     // Find optimization opportunities in Adds, Muls, Pows and negative
     // coefficient Muls
     umap_basic_basic opt_subs;
-    OptsCSEVisitor visitor(opt_subs);
+    OptsCSEFinder visitor(opt_subs);
     for (auto &e : exprs) {
-        e->accept(visitor);
+        visitor.apply(e);
     }
 
-    match_common_args("add", set_as_vec(visitor.adds), opt_subs);
-    match_common_args("mul", set_as_vec(visitor.muls), opt_subs);
+    if (match_budget == 0) {
+        match_budget = std::numeric_limits<size_t>::max();
+    }
+    match_common_args("add", set_as_vec(visitor.adds), opt_subs, match_budget);
+    match_common_args("mul", set_as_vec(visitor.muls), opt_subs, match_budget);
 
     return opt_subs;
 }
@@ -422,46 +430,86 @@ class RebuildVisitor : public BaseVisitor<RebuildVisitor, TransformVisitor>
 private:
     umap_basic_basic &subs;
     umap_basic_basic &opt_subs;
-    set_basic &to_eliminate;
-    set_basic &excluded_symbols;
+    uset_basic &to_eliminate;
+    uset_basic &excluded_symbols;
     vec_pair &replacements;
+    umap_basic_basic rebuilt;
     unsigned next_symbol_index = 0;
 
 public:
     using TransformVisitor::bvisit;
     using TransformVisitor::result_;
     RebuildVisitor(umap_basic_basic &subs_, umap_basic_basic &opt_subs_,
-                   set_basic &to_eliminate_, set_basic &excluded_symbols_,
+                   uset_basic &to_eliminate_, uset_basic &excluded_symbols_,
                    vec_pair &replacements_)
         : subs(subs_), opt_subs(opt_subs_), to_eliminate(to_eliminate_),
           excluded_symbols(excluded_symbols_), replacements(replacements_)
     {
     }
+    /* Nodes are rebuilt after their arguments, which are walked with an
+       explicit stack and stored in `rebuilt`. The visitor methods then only
+       look up the new arguments, so deep expressions do not overflow the
+       call stack. */
     RCP<const Basic> apply(const RCP<const Basic> &orig_expr) override
     {
-        RCP<const Basic> expr = orig_expr;
+        RCP<const Basic> r = lookup(orig_expr);
+        if (not r.is_null()) {
+            return r;
+        }
+        // Each entry is a node, and whether its arguments were rebuilt
+        std::vector<std::pair<RCP<const Basic>, bool>> stack;
+        stack.emplace_back(orig_expr, false);
+        while (not stack.empty()) {
+            RCP<const Basic> orig = std::move(stack.back().first);
+            const bool args_done = stack.back().second;
+            stack.pop_back();
+            if (not lookup(orig).is_null()) {
+                continue;
+            }
+            RCP<const Basic> expr = orig;
+            auto iter = opt_subs.find(orig);
+            if (iter != opt_subs.end()) {
+                expr = iter->second;
+            }
+            if (not args_done) {
+                stack.emplace_back(orig, true);
+                const size_t n = stack.size();
+                expr->for_each_arg([&stack](const RCP<const Basic> &arg) {
+                    stack.emplace_back(arg, false);
+                    return true;
+                });
+                std::reverse(stack.begin() + n, stack.end());
+                continue;
+            }
+            expr->accept(*this);
+            auto new_expr = result_;
+            if (to_eliminate.find(orig) != to_eliminate.end()) {
+                auto sym = next_symbol();
+                subs[orig] = sym;
+                replacements.push_back(
+                    std::pair<RCP<const Basic>, RCP<const Basic>>(sym,
+                                                                  new_expr));
+            } else {
+                rebuilt[orig] = new_expr;
+            }
+        }
+        return lookup(orig_expr);
+    }
+    //! The rebuilt `expr`, or null if it was not rebuilt yet
+    RCP<const Basic> lookup(const RCP<const Basic> &expr) const
+    {
         if (is_a_Atom(*expr)) {
             return expr;
         }
-
         auto iter = subs.find(expr);
         if (iter != subs.end()) {
             return iter->second;
         }
-        auto iter2 = opt_subs.find(expr);
-        if (iter2 != opt_subs.end()) {
-            expr = iter2->second;
+        auto iter2 = rebuilt.find(expr);
+        if (iter2 != rebuilt.end()) {
+            return iter2->second;
         }
-        expr->accept(*this);
-        auto new_expr = result_;
-        if (to_eliminate.find(orig_expr) != to_eliminate.end()) {
-            auto sym = next_symbol();
-            subs[orig_expr] = sym;
-            replacements.push_back(
-                std::pair<RCP<const Basic>, RCP<const Basic>>(sym, new_expr));
-            return sym;
-        }
-        return new_expr;
+        return RCP<const Basic>();
     }
     RCP<const Basic> next_symbol()
     {
@@ -495,42 +543,55 @@ public:
 void tree_cse(vec_pair &replacements, vec_basic &reduced_exprs,
               const vec_basic &exprs, umap_basic_basic &opt_subs)
 {
-    set_basic to_eliminate;
-    set_basic seen_subexp;
-    set_basic excluded_symbols;
-
-    std::function<void(RCP<const Basic> & expr)> find_repeated;
-    find_repeated = [&](RCP<const Basic> expr) -> void {
-        // Do not replace atoms
-        if (is_a_Number(*expr) or is_a<BooleanAtom>(*expr)) {
-            return;
-        }
-
-        if (is_a<Symbol>(*expr)) {
-            excluded_symbols.insert(expr);
-        }
+    uset_basic to_eliminate;
+    ArgViewSet seen_subexp;
+    uset_basic excluded_symbols;
+
+    // The subexpressions that are reached more than once are eliminated. The
+    // order in which they are reached does not matter, so they are walked
+    // with an explicit stack, which does not overflow on deep expressions.
+    // The terms and factors that Add and Mul do not store are walked as
+    // views, and only created if they are eliminated or substituted.
+    std::unordered_set<hash_t> opt_hashes;
+    for (const auto &p : opt_subs) {
+        opt_hashes.insert(p.first->hash());
+    }
+    std::vector<ArgView> stack;
+    for (auto it = exprs.rbegin(); it != exprs.rend(); ++it) {
+        stack.emplace_back(*it);
+    }
+    auto push = [&stack](const ArgView &arg) {
+        stack.push_back(arg);
+        return true;
+    };
+    while (not stack.empty()) {
+        ArgView expr = std::move(stack.back());
+        stack.pop_back();
+        if (expr.is_stored()) {
+            // Do not replace atoms
+            if (is_a_Number(expr.stored())
+                or is_a<BooleanAtom>(expr.stored())) {
+                continue;
+            }
 
-        if (seen_subexp.find(expr) != seen_subexp.end()) {
-            to_eliminate.insert(expr);
-            return;
+            if (is_a<Symbol>(expr.stored())) {
+                excluded_symbols.insert(expr.get());
+            }
         }
 
-        seen_subexp.insert(expr);
-
-        auto iter = opt_subs.find(expr);
-        if (iter != opt_subs.end()) {
-            expr = iter->second;
+        if (not seen_subexp.insert(expr)) {
+            to_eliminate.insert(expr.get());
+            continue;
         }
 
-        vec_basic args = expr->get_args();
-
-        for (auto &arg : args) {
-            find_repeated(arg);
+        if (opt_hashes.find(expr.hash()) != opt_hashes.end()) {
+            auto iter = opt_subs.find(expr.get());
+            if (iter != opt_subs.end()) {
+                expr = ArgView(iter->second);
+            }
         }
-    };
 
-    for (auto e : exprs) {
-        find_repeated(e);
+        expr.for_each_arg(push);
     }
 
     umap_basic_basic subs;
@@ -545,10 +606,10 @@ void tree_cse(vec_pair &replacements, vec_basic &reduced_exprs,
 }
 
 void cse(vec_pair &replacements, vec_basic &reduced_exprs,
-         const vec_basic &exprs)
+         const vec_basic &exprs, size_t match_budget)
 {
     // Find other optimization opportunities.
-    umap_basic_basic opt_subs = opt_cse(exprs);
+    umap_basic_basic opt_subs = opt_cse(exprs, match_budget);
 
     // Main CSE algorithm.
     tree_cse(replacements, reduced_exprs, exprs, opt_subs);
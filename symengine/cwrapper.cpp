@@ -621,6 +621,14 @@ int basic_neq(const basic a, const basic b)
     return SymEngine::neq(*(a->m), *(b->m)) ? 1 : 0;
 }
 
+CWRAPPER_OUTPUT_TYPE basic_expand_parallel(basic s, const basic a, int deep,
+                                           unsigned nthreads)
+{
+    CWRAPPER_BEGIN
+    s->m = SymEngine::expand(a->m, deep != 0, nthreads);
+    CWRAPPER_END
+}
+
 #define IMPLEMENT_ONE_ARG_FUNC(func)                                           \
     CWRAPPER_OUTPUT_TYPE basic_##func(basic s, const basic a)                  \
     {                                                                          \
@@ -1941,6 +1949,14 @@ void lambda_real_double_visitor_call(CLambdaRealDoubleVisitor *self,
     self->m.call(outs, inps);
 }
 
+void lambda_real_double_visitor_call_batch(CLambdaRealDoubleVisitor *self,
+                                           double *const outs,
+                                           const double *const inps,
+                                           size_t npoints, size_t stride)
+{
+    self->m.call_batch(outs, inps, npoints, stride);
+}
+
 void lambda_real_double_visitor_free(CLambdaRealDoubleVisitor *self)
 {
     delete self;
@@ -1970,6 +1986,15 @@ void llvm_double_visitor_call(CLLVMDoubleVisitor *self, double *const outs,
     self->m.call(outs, inps);
 }
 
+void llvm_double_visitor_call_batch(CLLVMDoubleVisitor *self,
+                                    double *const outs,
+                                    const double *const inps, size_t npoints,
+                                    size_t in_stride, size_t out_stride,
+                                    unsigned nthreads)
+{
+    self->m.call_batch(outs, inps, npoints, in_stride, out_stride, nthreads);
+}
+
 void llvm_double_visitor_free(CLLVMDoubleVisitor *self)
 {
     delete self;
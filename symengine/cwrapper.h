@@ -275,6 +275,10 @@ int basic_neq(const basic a, const basic b);
 
 //! Expands the expr a and assigns to s.
 CWRAPPER_OUTPUT_TYPE basic_expand(basic s, const basic a);
+//! Expands the expr a using nthreads threads and assigns to s. If deep is 0,
+//! only the top level of a is expanded.
+CWRAPPER_OUTPUT_TYPE basic_expand_parallel(basic s, const basic a, int deep,
+                                           unsigned nthreads);
 //! Assigns s = -a.
 CWRAPPER_OUTPUT_TYPE basic_neg(basic s, const basic a);
 
@@ -826,6 +830,12 @@ void lambda_real_double_visitor_init(CLambdaRealDoubleVisitor *self,
 void lambda_real_double_visitor_call(CLambdaRealDoubleVisitor *self,
                                      double *const outs,
                                      const double *const inps);
+//! Evaluates at npoints points. The inputs of point p start at
+//! inps[p * stride] and its outputs are written to outs[p * n_outputs].
+void lambda_real_double_visitor_call_batch(CLambdaRealDoubleVisitor *self,
+                                           double *const outs,
+                                           const double *const inps,
+                                           size_t npoints, size_t stride);
 void lambda_real_double_visitor_free(CLambdaRealDoubleVisitor *self);
 
 //! Wrapper for LambdaRealDoubleVisitor
@@ -838,6 +848,14 @@ void llvm_double_visitor_init(CLLVMDoubleVisitor *self, const CVecBasic *args,
                               int opt_level);
 void llvm_double_visitor_call(CLLVMDoubleVisitor *self, double *const outs,
                               const double *const inps);
+//! Evaluates at npoints points using nthreads threads (0 for the default).
+//! The inputs of point p start at inps[p * in_stride] and its outputs are
+//! written to outs[p * out_stride].
+void llvm_double_visitor_call_batch(CLLVMDoubleVisitor *self,
+                                    double *const outs,
+                                    const double *const inps, size_t npoints,
+                                    size_t in_stride, size_t out_stride,
+                                    unsigned nthreads);
 void llvm_double_visitor_free(CLLVMDoubleVisitor *self);
 // float
 typedef struct CLLVMFloatVisitor CLLVMFloatVisitor;
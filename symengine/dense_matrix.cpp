@@ -1,8 +1,11 @@
 #include <symengine/matrix.h>
 #include <symengine/number.h>
 #include <symengine/add.h>
+#include <symengine/derivative.h>
 #include <symengine/functions.h>
 #include <symengine/pow.h>
+#include <symengine/rational.h>
+#include <symengine/real_double.h>
 #include <symengine/subs.h>
 #include <symengine/symengine_exception.h>
 #include <symengine/polys/uexprpoly.h>
@@ -15,6 +18,70 @@
 namespace SymEngine
 {
 
+namespace
+{
+// Accumulates a sum term by term and canonicalizes it once with
+// `Add::from_dict`, instead of creating an intermediate `Add` per term.
+class SumAccumulator
+{
+    umap_basic_num dict_;
+    RCP<const Number> coef_ = zero;
+
+public:
+    // Adds `c * t`; an `Add` is distributed so the dictionary stays canonical
+    void push(const RCP<const Number> &c, const RCP<const Basic> &t)
+    {
+        if (not c->is_one() and is_a<Add>(*t)) {
+            const Add &s = down_cast<const Add &>(*t);
+            for (const auto &q : s.get_dict())
+                Add::dict_add_term(dict_, mulnum(c, q.second), q.first);
+            iaddnum(outArg(coef_), mulnum(c, s.get_coef()));
+        } else {
+            Add::coef_dict_add_term(outArg(coef_), dict_, c, t);
+        }
+    }
+    void push(const RCP<const Basic> &t)
+    {
+        Add::coef_dict_add_term(outArg(coef_), dict_, one, t);
+    }
+    RCP<const Basic> finish()
+    {
+        RCP<const Basic> r = Add::from_dict(coef_, std::move(dict_));
+        dict_.clear();
+        coef_ = zero;
+        return r;
+    }
+};
+
+inline bool is_exact_zero(const RCP<const Basic> &e)
+{
+    return is_a_Number(*e) and down_cast<const Number &>(*e).is_exact_zero();
+}
+
+// Returns `(a*b - c*d)`, divided by `p` unless `p` is null.
+inline RCP<const Basic> cross_difference(const RCP<const Basic> &a,
+                                         const RCP<const Basic> &b,
+                                         const RCP<const Basic> &c,
+                                         const RCP<const Basic> &d,
+                                         const RCP<const Basic> &p)
+{
+    SumAccumulator acc;
+    acc.push(mul(a, b));
+    // An exact zero times e.g. a ComplexDouble or oo is not exactly zero
+    RCP<const Basic> cd = mul(c, d);
+    if (not is_exact_zero(cd))
+        acc.push(minus_one, cd);
+    RCP<const Basic> r = acc.finish();
+    return p.is_null() ? r : div(r, p);
+}
+
+// Tile edge used by the blocked kernels below
+const unsigned matrix_block_size = 16;
+
+// Minimum number of entries to update before spreading a loop over threads
+const unsigned matrix_parallel_threshold = 256;
+} // namespace
+
 // Constructors
 DenseMatrix::DenseMatrix() {}
 
@@ -334,6 +401,9 @@ tribool DenseMatrix::is_negative_definite() const
 
 RCP<const Basic> DenseMatrix::det() const
 {
+    RCP<const Basic> d;
+    if (numeric_det(*this, d))
+        return d;
     return det_bareis(*this);
 }
 
@@ -341,7 +411,8 @@ void DenseMatrix::inv(MatrixBase &result) const
 {
     if (is_a<DenseMatrix>(result)) {
         DenseMatrix &r = down_cast<DenseMatrix &>(result);
-        inverse_pivoted_LU(*this, r);
+        if (not numeric_inverse(*this, r))
+            inverse_pivoted_LU(*this, r);
     }
 }
 
@@ -353,6 +424,14 @@ void DenseMatrix::add_matrix(const MatrixBase &other, MatrixBase &result) const
         const DenseMatrix &o = down_cast<const DenseMatrix &>(other);
         DenseMatrix &r = down_cast<DenseMatrix &>(result);
         add_dense_dense(*this, o, r);
+    } else if (is_a<DenseMatrix>(other) and is_a<CSRMatrix>(result)) {
+        DenseMatrix r(row_, col_);
+        add_matrix(other, r);
+        down_cast<CSRMatrix &>(result) = dense_to_csr(r);
+    } else if (is_a<CSRMatrix>(other)) {
+        other.add_matrix(*this, result);
+    } else {
+        throw NotImplementedError("Not Implemented");
     }
 }
 
@@ -364,7 +443,24 @@ void DenseMatrix::mul_matrix(const MatrixBase &other, MatrixBase &result) const
     if (is_a<DenseMatrix>(other) and is_a<DenseMatrix>(result)) {
         const DenseMatrix &o = down_cast<const DenseMatrix &>(other);
         DenseMatrix &r = down_cast<DenseMatrix &>(result);
-        mul_dense_dense(*this, o, r);
+        if (not numeric_mul(*this, o, r))
+            mul_dense_dense(*this, o, r);
+    } else if (is_a<CSRMatrix>(other) and is_a<DenseMatrix>(result)) {
+        // A*B = (B^T A^T)^T, where B^T A^T is a sparse times dense product
+        const CSRMatrix &o = down_cast<const CSRMatrix &>(other);
+        DenseMatrix &r = down_cast<DenseMatrix &>(result);
+        DenseMatrix At(col_, row_), Ct(o.ncols(), row_);
+        transpose_dense(*this, At);
+        o.transpose().mul_matrix(At, Ct);
+        transpose_dense(Ct, r);
+    } else if (is_a<CSRMatrix>(result)) {
+        // The product with a dense factor is dense, so it is computed as a
+        // DenseMatrix and compressed
+        DenseMatrix r(row_, other.ncols());
+        mul_matrix(other, r);
+        down_cast<CSRMatrix &>(result) = dense_to_csr(r);
+    } else {
+        throw NotImplementedError("Not Implemented");
     }
 }
 
@@ -378,6 +474,14 @@ void DenseMatrix::elementwise_mul_matrix(const MatrixBase &other,
         const DenseMatrix &o = down_cast<const DenseMatrix &>(other);
         DenseMatrix &r = down_cast<DenseMatrix &>(result);
         elementwise_mul_dense_dense(*this, o, r);
+    } else if (is_a<DenseMatrix>(other) and is_a<CSRMatrix>(result)) {
+        DenseMatrix r(row_, col_);
+        elementwise_mul_matrix(other, r);
+        down_cast<CSRMatrix &>(result) = dense_to_csr(r);
+    } else if (is_a<CSRMatrix>(other)) {
+        other.elementwise_mul_matrix(*this, result);
+    } else {
+        throw NotImplementedError("Not Implemented");
     }
 }
 
@@ -467,7 +571,8 @@ void DenseMatrix::LU_solve(const MatrixBase &b, MatrixBase &x) const
     if (is_a<DenseMatrix>(b) and is_a<DenseMatrix>(x)) {
         const DenseMatrix &b_ = down_cast<const DenseMatrix &>(b);
         DenseMatrix &x_ = down_cast<DenseMatrix &>(x);
-        SymEngine::LU_solve(*this, b_, x_);
+        if (not numeric_LU_solve(*this, b_, x_))
+            SymEngine::LU_solve(*this, b_, x_);
     }
 }
 
@@ -513,30 +618,29 @@ void DenseMatrix::cholesky(MatrixBase &L) const
 
 // ---------------------------- Jacobian -------------------------------------//
 
+// Each row is differentiated w.r.t. all the symbols at once, so that the
+// symbols each subexpression depends on are only found once per row. The
+// rows are independent, and can take very different times.
 void jacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
               bool diff_cache)
 {
     SYMENGINE_ASSERT(A.col_ == 1);
     SYMENGINE_ASSERT(x.col_ == 1);
     SYMENGINE_ASSERT(A.row_ == result.nrows() and x.row_ == result.ncols());
-    bool error = false;
-#pragma omp parallel for
-    for (unsigned i = 0; i < result.row_; i++) {
-        for (unsigned j = 0; j < result.col_; j++) {
-            if (is_a<Symbol>(*(x.m_[j]))) {
-                const RCP<const Symbol> x_
-                    = rcp_static_cast<const Symbol>(x.m_[j]);
-                result.m_[i * result.col_ + j] = A.m_[i]->diff(x_, diff_cache);
-            } else {
-                error = true;
-                break;
-            }
+    vec_sym syms;
+    syms.reserve(x.row_);
+    for (const auto &dx : x.m_) {
+        if (not is_a<Symbol>(*dx)) {
+            throw SymEngineException(
+                "'x' must contain Symbols only. "
+                "Use sjacobian for SymPy style differentiation");
         }
+        syms.push_back(rcp_static_cast<const Symbol>(dx));
     }
-    if (error) {
-        throw SymEngineException(
-            "'x' must contain Symbols only. "
-            "Use sjacobian for SymPy style differentiation");
+#pragma omp parallel for schedule(dynamic)
+    for (unsigned i = 0; i < result.row_; i++) {
+        vec_basic row = diff(A.m_[i], syms, diff_cache);
+        std::move(row.begin(), row.end(), result.m_.begin() + i * result.col_);
     }
 }
 
@@ -546,20 +650,28 @@ void sjacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
     SYMENGINE_ASSERT(A.col_ == 1);
     SYMENGINE_ASSERT(x.col_ == 1);
     SYMENGINE_ASSERT(A.row_ == result.nrows() and x.row_ == result.ncols());
-#pragma omp parallel for
+    vec_sym syms;
+    std::vector<unsigned> sym_cols, other_cols;
+    for (unsigned j = 0; j < result.col_; j++) {
+        if (is_a<Symbol>(*(x.m_[j]))) {
+            syms.push_back(rcp_static_cast<const Symbol>(x.m_[j]));
+            sym_cols.push_back(j);
+        } else {
+            other_cols.push_back(j);
+        }
+    }
+#pragma omp parallel for schedule(dynamic)
     for (unsigned i = 0; i < result.row_; i++) {
-        for (unsigned j = 0; j < result.col_; j++) {
-            if (is_a<Symbol>(*(x.m_[j]))) {
-                const RCP<const Symbol> x_
-                    = rcp_static_cast<const Symbol>(x.m_[j]);
-                result.m_[i * result.col_ + j] = A.m_[i]->diff(x_, diff_cache);
-            } else {
-                // TODO: Use a dummy symbol
-                const RCP<const Symbol> x_ = symbol("x_");
-                result.m_[i * result.col_ + j] = ssubs(
-                    ssubs(A.m_[i], {{x.m_[j], x_}})->diff(x_, diff_cache),
-                    {{x_, x.m_[j]}});
-            }
+        vec_basic row = diff(A.m_[i], syms, diff_cache);
+        for (unsigned k = 0; k < sym_cols.size(); k++) {
+            result.m_[i * result.col_ + sym_cols[k]] = std::move(row[k]);
+        }
+        for (unsigned j : other_cols) {
+            // TODO: Use a dummy symbol
+            const RCP<const Symbol> x_ = symbol("x_");
+            result.m_[i * result.col_ + j]
+                = ssubs(ssubs(A.m_[i], {{x.m_[j], x_}})->diff(x_, diff_cache),
+                        {{x_, x.m_[j]}});
         }
     }
 }
@@ -685,17 +797,45 @@ void mul_dense_dense(const DenseMatrix &A, const DenseMatrix &B, DenseMatrix &C)
     SYMENGINE_ASSERT(A.col_ == B.row_ and C.row_ == A.row_
                      and C.col_ == B.col_);
 
-    unsigned row = A.row_, col = B.col_;
+    unsigned row = A.row_, col = B.col_, inner = A.col_;
 
     if (&A != &C and &B != &C) {
-        for (unsigned r = 0; r < row; r++) {
-            for (unsigned c = 0; c < col; c++) {
-                C.m_[r * col + c] = zero; // Integer Zero
-                for (unsigned k = 0; k < A.col_; k++)
-                    C.m_[r * col + c]
-                        = add(C.m_[r * col + c],
-                              mul(A.m_[r * A.col_ + k], B.m_[k * col + c]));
+        // C is computed tile by tile. Within a tile the k loop is blocked too
+        // and runs outside the column loop, so rows of B are read
+        // contiguously; every entry keeps its own accumulator and is
+        // canonicalized once at the end.
+        const unsigned bs = matrix_block_size;
+        const unsigned row_tiles = (row + bs - 1) / bs;
+        const unsigned col_tiles = (col + bs - 1) / bs;
+        const unsigned tiles = row_tiles * col_tiles;
+#pragma omp parallel for schedule(dynamic)                                     \
+    if (row * col >= matrix_parallel_threshold and tiles > 1)
+        for (unsigned t = 0; t < tiles; t++) {
+            const unsigned r0 = (t / col_tiles) * bs, c0 = (t % col_tiles) * bs;
+            const unsigned r1 = std::min(r0 + bs, row),
+                           c1 = std::min(c0 + bs, col);
+            const unsigned w = c1 - c0;
+            std::vector<SumAccumulator> acc((r1 - r0) * w);
+            for (unsigned k0 = 0; k0 < inner; k0 += bs) {
+                const unsigned k1 = std::min(k0 + bs, inner);
+                for (unsigned r = r0; r < r1; r++) {
+                    for (unsigned k = k0; k < k1; k++) {
+                        const RCP<const Basic> &a = A.m_[r * inner + k];
+                        const bool a_zero = is_exact_zero(a);
+                        for (unsigned c = c0; c < c1; c++) {
+                            // An exact zero times e.g. a ComplexDouble or oo
+                            // is not exactly zero, and must be kept
+                            RCP<const Basic> p = mul(a, B.m_[k * col + c]);
+                            if (a_zero and is_exact_zero(p))
+                                continue;
+                            acc[(r - r0) * w + c - c0].push(p);
+                        }
+                    }
+                }
             }
+            for (unsigned r = r0; r < r1; r++)
+                for (unsigned c = c0; c < c1; c++)
+                    C.m_[r * col + c] = acc[(r - r0) * w + c - c0].finish();
         }
     } else {
         DenseMatrix tmp = DenseMatrix(A.row_, B.col_);
@@ -901,11 +1041,23 @@ void pivoted_gaussian_elimination(const DenseMatrix &A, DenseMatrix &B,
         scale = div(one, B.m_[index * col + i]);
         row_mul_scalar_dense(B, index, scale);
 
+        // Rows below the pivot are independent of each other
+#pragma omp parallel for if ((row - i) * (col - i) >= matrix_parallel_threshold)
         for (j = i + 1; j < row; j++) {
-            for (k = i + 1; k < col; k++)
-                B.m_[j * col + k]
-                    = sub(B.m_[j * col + k],
-                          mul(B.m_[j * col + i], B.m_[i * col + k]));
+            const RCP<const Basic> f = B.m_[j * col + i];
+            const bool f_zero = is_exact_zero(f);
+            for (unsigned l = i + 1; l < col; l++) {
+                if (f_zero) {
+                    // Only update the entries where f times the pivot row is
+                    // not exactly zero, e.g. 0*oo
+                    RCP<const Basic> p = mul(f, B.m_[i * col + l]);
+                    if (not is_exact_zero(p))
+                        B.m_[j * col + l] = sub(B.m_[j * col + l], p);
+                } else {
+                    B.m_[j * col + l] = cross_difference(
+                        one, B.m_[j * col + l], f, B.m_[i * col + l], null);
+                }
+            }
             B.m_[j * col + i] = zero;
         }
 
@@ -1374,15 +1526,19 @@ void fraction_free_LU(const DenseMatrix &A, DenseMatrix &LU)
 
     LU.m_ = A.m_;
 
-    for (i = 0; i < n - 1; i++)
+    for (i = 0; i < n - 1; i++) {
+        const RCP<const Basic> p
+            = i ? LU.m_[i * n - n + i - 1] : RCP<const Basic>();
+        // Row j only reads rows i and j, so the rows below i can be updated
+        // concurrently
+#pragma omp parallel for private(k)                                            \
+    if ((n - i) * (n - i) >= matrix_parallel_threshold)
         for (j = i + 1; j < n; j++)
-            for (k = i + 1; k < n; k++) {
-                LU.m_[j * n + k] = sub(mul(LU.m_[i * n + i], LU.m_[j * n + k]),
-                                       mul(LU.m_[j * n + i], LU.m_[i * n + k]));
-                if (i)
-                    LU.m_[j * n + k]
-                        = div(LU.m_[j * n + k], LU.m_[i * n - n + i - 1]);
-            }
+            for (k = i + 1; k < n; k++)
+                LU.m_[j * n + k]
+                    = cross_difference(LU.m_[i * n + i], LU.m_[j * n + k],
+                                       LU.m_[j * n + i], LU.m_[i * n + k], p);
+    }
 }
 
 // SymPy LUDecomposition algorithm, in
@@ -1736,13 +1892,13 @@ RCP<const Basic> det_bareis(const DenseMatrix &A)
                     return zero;
             }
 
+            d = (k > 0) ? B.m_[(k - 1) * n + k - 1] : RCP<const Basic>();
+#pragma omp parallel for if ((n - k) * (n - k) >= matrix_parallel_threshold)
             for (i = k + 1; i < n; i++) {
                 for (unsigned j = k + 1; j < n; j++) {
-                    d = sub(mul(B.m_[k * n + k], B.m_[i * n + j]),
-                            mul(B.m_[i * n + k], B.m_[k * n + j]));
-                    if (k > 0)
-                        d = div(d, B.m_[(k - 1) * n + k - 1]);
-                    B.m_[i * n + j] = d;
+                    B.m_[i * n + j]
+                        = cross_difference(B.m_[k * n + k], B.m_[i * n + j],
+                                           B.m_[i * n + k], B.m_[k * n + j], d);
                 }
             }
         }
@@ -1781,21 +1937,23 @@ void berkowitz(const DenseMatrix &A, std::vector<DenseMatrix> &polys)
 
         for (i = 0; i < n - 2; i++) {
             DenseMatrix B = DenseMatrix(k, 1);
+#pragma omp parallel for private(m) if (k * k >= matrix_parallel_threshold)
             for (l = 0; l < k; l++) {
-                B.m_[l] = zero;
+                SumAccumulator acc;
                 for (m = 0; m < k; m++)
-                    B.m_[l]
-                        = add(B.m_[l], mul(A.m_[l * col + m], items[i].m_[m]));
+                    acc.push(mul(A.m_[l * col + m], items[i].m_[m]));
+                B.m_[l] = acc.finish();
             }
             items.push_back(B);
         }
 
-        items_.clear();
+        items_.resize(n - 1);
+#pragma omp parallel for private(l) if ((n - 1) * k >= matrix_parallel_threshold)
         for (i = 0; i < n - 1; i++) {
-            RCP<const Basic> element = zero;
+            SumAccumulator acc;
             for (l = 0; l < k; l++)
-                element = add(element, mul(A.m_[k * col + l], items[i].m_[l]));
-            items_.push_back(mul(minus_one, element));
+                acc.push(minus_one, mul(A.m_[k * col + l], items[i].m_[l]));
+            items_[i] = acc.finish();
         }
         items_.insert(items_.begin(), mul(minus_one, A.m_[k * col + k]));
         items_.insert(items_.begin(), one);
@@ -1815,14 +1973,16 @@ void berkowitz(const DenseMatrix &A, std::vector<DenseMatrix> &polys)
         unsigned t_col = transforms[col - 2 - i].ncols();
         DenseMatrix B = DenseMatrix(t_row, 1);
 
+        const DenseMatrix &T = transforms[col - 2 - i];
+#pragma omp parallel for private(m) if (t_row * t_col >= matrix_parallel_threshold)
         for (l = 0; l < t_row; l++) {
-            B.m_[l] = zero;
+            SumAccumulator acc;
             for (m = 0; m < t_col; m++) {
-                B.m_[l] = add(B.m_[l],
-                              mul(transforms[col - 2 - i].m_[l * t_col + m],
-                                  polys[i].m_[m]));
-                B.m_[l] = expand(B.m_[l]);
+                RCP<const Basic> p = mul(T.m_[l * t_col + m], polys[i].m_[m]);
+                if (not is_exact_zero(p))
+                    acc.push(expand(p));
             }
+            B.m_[l] = acc.finish();
         }
         polys.push_back(B);
     }
@@ -2097,4 +2257,499 @@ DenseMatrix DenseMatrix::loads(const std::string &serialized)
 #endif
 }
 
+// ------------------------- Numeric fast paths ------------------------------//
+
+namespace
+{
+
+// Narrowest domain holding every entry of a matrix. Matrices containing
+// anything other than an Integer, Rational or RealDouble are `symbolic`.
+enum class NumericDomain { integer, rational, real, symbolic };
+
+NumericDomain numeric_domain(const vec_basic &v,
+                             NumericDomain d = NumericDomain::integer)
+{
+    for (const auto &e : v) {
+        if (is_a<Integer>(*e)) {
+            continue;
+        } else if (is_a<Rational>(*e)) {
+            if (d == NumericDomain::integer)
+                d = NumericDomain::rational;
+        } else if (is_a<RealDouble>(*e)) {
+            d = NumericDomain::real;
+        } else {
+            return NumericDomain::symbolic;
+        }
+    }
+    return d;
+}
+
+double to_double(const RCP<const Basic> &e)
+{
+    if (is_a<Integer>(*e))
+        return mp_get_d(down_cast<const Integer &>(*e).as_integer_class());
+    if (is_a<Rational>(*e))
+        return mp_get_d(down_cast<const Rational &>(*e).as_rational_class());
+    return down_cast<const RealDouble &>(*e).i;
+}
+
+rational_class to_rational(const RCP<const Basic> &e)
+{
+    if (is_a<Integer>(*e))
+        return rational_class(
+            down_cast<const Integer &>(*e).as_integer_class());
+    return down_cast<const Rational &>(*e).as_rational_class();
+}
+
+// Copies the exact rows `[A | B]` into `a`, which is `A.ncols() + B.ncols()`
+// wide. Each row is multiplied by the lcm of its denominators, which is
+// stored in `scale`. `B` may be null.
+void integer_rows(const DenseMatrix &A, const DenseMatrix *B,
+                  std::vector<integer_class> &a,
+                  std::vector<integer_class> &scale)
+{
+    const unsigned n = A.nrows(), wa = A.ncols();
+    const unsigned w = wa + (B ? B->ncols() : 0);
+    a.assign(n * w, integer_class(0));
+    scale.assign(n, integer_class(1));
+    std::vector<rational_class> row(w);
+    for (unsigned i = 0; i < n; i++) {
+        integer_class &l = scale[i];
+        for (unsigned j = 0; j < w; j++) {
+            row[j] = to_rational(j < wa ? A.get(i, j) : B->get(i, j - wa));
+            mp_lcm(l, l, get_den(row[j]));
+        }
+        for (unsigned j = 0; j < w; j++) {
+            mp_divexact(a[i * w + j], l, get_den(row[j]));
+            a[i * w + j] *= get_num(row[j]);
+        }
+    }
+}
+
+// Fraction free (Bareiss) elimination of the `n x n` integer matrix `a` with
+// row pivoting. Every division is exact, so intermediate entries stay bounded
+// by minors of the input.
+integer_class det_bareis_integer(std::vector<integer_class> a, unsigned n)
+{
+    integer_class prev(1), t;
+    bool negate = false;
+    for (unsigned k = 0; k + 1 < n; k++) {
+        unsigned p = k;
+        while (p < n and a[p * n + k] == 0)
+            p++;
+        if (p == n)
+            return integer_class(0);
+        if (p != k) {
+            for (unsigned j = k; j < n; j++)
+                std::swap(a[p * n + j], a[k * n + j]);
+            negate = not negate;
+        }
+        for (unsigned i = k + 1; i < n; i++) {
+            for (unsigned j = k + 1; j < n; j++) {
+                t = a[k * n + k] * a[i * n + j];
+                t -= a[i * n + k] * a[k * n + j];
+                mp_divexact(a[i * n + j], t, prev);
+            }
+        }
+        prev = a[k * n + k];
+    }
+    return negate ? integer_class(-a[n * n - 1]) : a[n * n - 1];
+}
+
+uint64_t inverse_mod_prime(uint64_t a, uint64_t p)
+{
+    uint64_t r = 1;
+    for (uint64_t e = p - 2; e; e >>= 1, a = a * a % p)
+        if (e & 1)
+            r = r * a % p;
+    return r;
+}
+
+bool is_word_prime(uint64_t p)
+{
+    if (p % 2 == 0)
+        return p == 2;
+    for (uint64_t q = 3; q * q <= p; q += 2)
+        if (p % q == 0)
+            return false;
+    return true;
+}
+
+// Determinant of an `n x n` matrix modulo the prime `p < 2^32`
+uint64_t det_mod_prime(std::vector<uint64_t> &a, unsigned n, uint64_t p)
+{
+    uint64_t d = 1;
+    for (unsigned k = 0; k < n; k++) {
+        unsigned r = k;
+        while (r < n and a[r * n + k] == 0)
+            r++;
+        if (r == n)
+            return 0;
+        if (r != k) {
+            for (unsigned j = k; j < n; j++)
+                std::swap(a[r * n + j], a[k * n + j]);
+            d = p - d;
+        }
+        const uint64_t piv = a[k * n + k];
+        d = d * piv % p;
+        const uint64_t inv = inverse_mod_prime(piv, p);
+        for (unsigned i = k + 1; i < n; i++) {
+            const uint64_t f = a[i * n + k] * inv % p;
+            if (f == 0)
+                continue;
+            for (unsigned j = k + 1; j < n; j++)
+                a[i * n + j] = (a[i * n + j] + (p - f) * a[k * n + j]) % p;
+        }
+    }
+    return d;
+}
+
+// Determinant of the `n x n` integer matrix `a` from its residues modulo
+// primes just below 2^31, combined by the Chinese remainder theorem until the
+// modulus exceeds twice Hadamard's bound. Falls back to `det_bareis_integer`
+// if the bound does not fit in a double.
+integer_class det_multimodular_integer(const std::vector<integer_class> &a,
+                                       unsigned n)
+{
+    // |det A| <= prod_i ||row_i||, in bits
+    double bits = 0;
+    for (unsigned i = 0; i < n; i++) {
+        double norm2 = 0;
+        for (unsigned j = 0; j < n; j++) {
+            const double v = mp_get_d(a[i * n + j]);
+            norm2 += v * v;
+        }
+        if (norm2 == 0)
+            return integer_class(0);
+        bits += 0.5 * std::log2(norm2);
+    }
+    if (not std::isfinite(bits))
+        return det_bareis_integer(a, n);
+
+    integer_class det(0), modulus(1), r;
+    std::vector<uint64_t> ap(n * n);
+    double modulus_bits = 0;
+    for (uint64_t p = (uint64_t(1) << 31) - 1; modulus_bits < bits + 2;
+         p -= 2) {
+        if (not is_word_prime(p))
+            continue;
+        const integer_class pz(static_cast<unsigned long>(p));
+        for (unsigned k = 0; k < n * n; k++) {
+            mp_fdiv_r(r, a[k], pz);
+            ap[k] = mp_get_ui(r);
+        }
+        const uint64_t dp = det_mod_prime(ap, n, p);
+        // det += modulus * ((dp - det) / modulus mod p)
+        mp_fdiv_r(r, det, pz);
+        uint64_t c = (dp + p - mp_get_ui(r)) % p;
+        mp_fdiv_r(r, modulus, pz);
+        c = c * inverse_mod_prime(mp_get_ui(r), p) % p;
+        det += modulus * integer_class(static_cast<unsigned long>(c));
+        modulus *= pz;
+        modulus_bits += std::log2(static_cast<double>(p));
+    }
+    if (det + det > modulus)
+        det -= modulus;
+    return det;
+}
+
+// Matrices at least this large use `det_multimodular_integer`
+const unsigned multimodular_det_size = 10;
+
+integer_class det_integer(std::vector<integer_class> a, unsigned n)
+{
+    if (n >= multimodular_det_size)
+        return det_multimodular_integer(a, n);
+    return det_bareis_integer(std::move(a), n);
+}
+
+// Builds the real matrix `[A | B]` in `a`, which is `A.ncols() + B.ncols()`
+// wide. `B` may be null.
+// Exact and RealDouble entries give exact results where they meet, so the
+// floating point kernels are only used if every entry is a RealDouble
+bool all_real_double(const DenseMatrix &A)
+{
+    for (const auto &e : A.as_vec_basic())
+        if (not is_a<RealDouble>(*e))
+            return false;
+    return true;
+}
+
+void real_rows(const DenseMatrix &A, const DenseMatrix *B,
+               std::vector<double> &a)
+{
+    const unsigned n = A.nrows(), wa = A.ncols();
+    const unsigned w = wa + (B ? B->ncols() : 0);
+    a.resize(n * w);
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < w; j++)
+            a[i * w + j] = to_double(j < wa ? A.get(i, j) : B->get(i, j - wa));
+}
+
+// Reduces the `n x w` real matrix `[A | B]` to `[I | A^-1 B]` by Gauss-Jordan
+// elimination with partial pivoting. Returns false if a pivot is zero.
+bool gauss_jordan_real(std::vector<double> &a, unsigned n, unsigned w)
+{
+    for (unsigned k = 0; k < n; k++) {
+        unsigned p = k;
+        for (unsigned i = k + 1; i < n; i++)
+            if (std::abs(a[i * w + k]) > std::abs(a[p * w + k]))
+                p = i;
+        if (a[p * w + k] == 0.0)
+            return false;
+        if (p != k)
+            for (unsigned j = k; j < w; j++)
+                std::swap(a[p * w + j], a[k * w + j]);
+        const double inv = 1.0 / a[k * w + k];
+        for (unsigned j = k; j < w; j++)
+            a[k * w + j] *= inv;
+        for (unsigned i = 0; i < n; i++) {
+            const double f = a[i * w + k];
+            if (i == k or f == 0.0)
+                continue;
+            for (unsigned j = k; j < w; j++)
+                a[i * w + j] -= f * a[k * w + j];
+        }
+    }
+    return true;
+}
+
+// Reduces the `n x w` integer matrix `[A | B]` by fraction free Gauss-Jordan
+// elimination with row pivoting, so that the left block becomes `d I` and the
+// right one `d A^-1 B`, where `d` is returned in `det`. Returns false if `A`
+// is singular.
+bool gauss_jordan_integer(std::vector<integer_class> &a, unsigned n,
+                          unsigned w, integer_class &det)
+{
+    integer_class prev(1);
+    for (unsigned k = 0; k < n; k++) {
+        unsigned p = k;
+        while (p < n and a[p * w + k] == 0)
+            p++;
+        if (p == n)
+            return false;
+        if (p != k)
+            for (unsigned j = 0; j < w; j++)
+                std::swap(a[p * w + j], a[k * w + j]);
+#pragma omp parallel for if (n * (w - k) >= matrix_parallel_threshold)
+        for (unsigned i = 0; i < n; i++) {
+            if (i == k)
+                continue;
+            integer_class t;
+            for (unsigned j = k + 1; j < w; j++) {
+                t = a[k * w + k] * a[i * w + j];
+                t -= a[i * w + k] * a[k * w + j];
+                mp_divexact(a[i * w + j], t, prev);
+            }
+            a[i * w + k] = 0;
+            if (i < k)
+                a[i * w + i] = a[k * w + k];
+        }
+        prev = a[k * w + k];
+    }
+    det = prev;
+    return true;
+}
+
+// Solves `A X = B` for exact `A` and `B`, storing `X` in `x`. Returns false if
+// `A` is singular.
+bool solve_exact(const DenseMatrix &A, const DenseMatrix &B, DenseMatrix &x)
+{
+    const unsigned n = A.nrows(), m = B.ncols(), w = n + m;
+    std::vector<integer_class> a, scale;
+    integer_class d;
+    // Scaling a row of `[A | B]` leaves the solution unchanged
+    integer_rows(A, &B, a, scale);
+    if (not gauss_jordan_integer(a, n, w, d))
+        return false;
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < m; j++) {
+            rational_class q(a[i * w + n + j], d);
+            canonicalize(q);
+            x.set(i, j, Rational::from_mpq(std::move(q)));
+        }
+    return true;
+}
+
+// Solves `A X = B` in floating point, storing `X` in `x`. Returns false if a
+// pivot vanishes.
+bool solve_real(const DenseMatrix &A, const DenseMatrix &B, DenseMatrix &x)
+{
+    const unsigned n = A.nrows(), m = B.ncols(), w = n + m;
+    std::vector<double> a;
+    real_rows(A, &B, a);
+    if (not gauss_jordan_real(a, n, w))
+        return false;
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < m; j++)
+            x.set(i, j, real_double(a[i * w + n + j]));
+    return true;
+}
+
+std::vector<integer_class> integer_entries(const DenseMatrix &A)
+{
+    vec_basic v = A.as_vec_basic();
+    std::vector<integer_class> a(v.size());
+    for (size_t k = 0; k < v.size(); k++)
+        a[k] = down_cast<const Integer &>(*v[k]).as_integer_class();
+    return a;
+}
+
+} // namespace
+
+RCP<const Integer> det_multimodular(const DenseMatrix &A)
+{
+    SYMENGINE_ASSERT(A.nrows() == A.ncols());
+    if (numeric_domain(A.as_vec_basic()) != NumericDomain::integer)
+        throw SymEngineException("det_multimodular: the matrix must have "
+                                 "Integer entries only");
+    if (A.nrows() == 0)
+        return integer(1);
+    return integer(det_multimodular_integer(integer_entries(A), A.nrows()));
+}
+
+bool numeric_det(const DenseMatrix &A, RCP<const Basic> &det)
+{
+    SYMENGINE_ASSERT(A.nrows() == A.ncols());
+    const unsigned n = A.nrows();
+    NumericDomain d = numeric_domain(A.as_vec_basic());
+    if (n == 0 or d == NumericDomain::symbolic)
+        return false;
+
+    if (d == NumericDomain::real) {
+        if (not all_real_double(A))
+            return false;
+        std::vector<double> a;
+        real_rows(A, nullptr, a);
+        double r = 1.0;
+        for (unsigned k = 0; k < n and r != 0.0; k++) {
+            unsigned p = k;
+            for (unsigned i = k + 1; i < n; i++)
+                if (std::abs(a[i * n + k]) > std::abs(a[p * n + k]))
+                    p = i;
+            if (p != k) {
+                for (unsigned j = k; j < n; j++)
+                    std::swap(a[p * n + j], a[k * n + j]);
+                r = -r;
+            }
+            r *= a[k * n + k];
+            if (r == 0.0)
+                break;
+            for (unsigned i = k + 1; i < n; i++) {
+                const double f = a[i * n + k] / a[k * n + k];
+                for (unsigned j = k + 1; j < n; j++)
+                    a[i * n + j] -= f * a[k * n + j];
+            }
+        }
+        det = real_double(r);
+        return true;
+    }
+
+    if (d == NumericDomain::integer) {
+        det = integer(det_integer(integer_entries(A), n));
+        return true;
+    }
+
+    // det(A) = det(D A) / det(D) for the diagonal row scaling D
+    std::vector<integer_class> a, scale;
+    integer_rows(A, nullptr, a, scale);
+    integer_class s(1);
+    for (const auto &l : scale)
+        s *= l;
+    rational_class q(det_integer(std::move(a), n), s);
+    canonicalize(q);
+    det = Rational::from_mpq(std::move(q));
+    return true;
+}
+
+bool numeric_inverse(const DenseMatrix &A, DenseMatrix &B)
+{
+    SYMENGINE_ASSERT(A.nrows() == A.ncols() and B.nrows() == A.nrows()
+                     and B.ncols() == A.ncols());
+    const unsigned n = A.nrows();
+    NumericDomain d = numeric_domain(A.as_vec_basic());
+    if (n == 0 or d == NumericDomain::symbolic)
+        return false;
+    DenseMatrix e(n, n);
+    eye(e);
+    if (d == NumericDomain::real)
+        return all_real_double(A) and solve_real(A, e, B);
+    return solve_exact(A, e, B);
+}
+
+bool numeric_LU_solve(const DenseMatrix &A, const DenseMatrix &b,
+                      DenseMatrix &x)
+{
+    SYMENGINE_ASSERT(A.nrows() == A.ncols() and b.nrows() == A.nrows()
+                     and x.nrows() == A.ncols() and x.ncols() == b.ncols());
+    NumericDomain d = numeric_domain(
+        b.as_vec_basic(), numeric_domain(A.as_vec_basic()));
+    if (A.nrows() == 0 or d == NumericDomain::symbolic)
+        return false;
+    if (d == NumericDomain::real)
+        return all_real_double(A) and all_real_double(b)
+               and solve_real(A, b, x);
+    return solve_exact(A, b, x);
+}
+
+bool numeric_mul(const DenseMatrix &A, const DenseMatrix &B, DenseMatrix &C)
+{
+    SYMENGINE_ASSERT(A.ncols() == B.nrows() and C.nrows() == A.nrows()
+                     and C.ncols() == B.ncols());
+    const unsigned n = A.nrows(), l = A.ncols(), m = B.ncols();
+    NumericDomain d = numeric_domain(
+        B.as_vec_basic(), numeric_domain(A.as_vec_basic()));
+    if (d == NumericDomain::symbolic)
+        return false;
+
+    if (d == NumericDomain::real) {
+        if (not all_real_double(A) or not all_real_double(B))
+            return false;
+        std::vector<double> a, b, c(n * m, 0.0);
+        real_rows(A, nullptr, a);
+        real_rows(B, nullptr, b);
+        for (unsigned i = 0; i < n; i++)
+            for (unsigned k = 0; k < l; k++) {
+                const double f = a[i * l + k];
+                for (unsigned j = 0; j < m; j++)
+                    c[i * m + j] += f * b[k * m + j];
+            }
+        for (unsigned k = 0; k < n * m; k++)
+            C.set(k / m, k % m, real_double(c[k]));
+        return true;
+    }
+
+    if (d == NumericDomain::integer) {
+        std::vector<integer_class> c(n * m, integer_class(0));
+        for (unsigned i = 0; i < n; i++)
+            for (unsigned k = 0; k < l; k++) {
+                const integer_class &f
+                    = down_cast<const Integer &>(*A.get(i, k))
+                          .as_integer_class();
+                if (f == 0)
+                    continue;
+                for (unsigned j = 0; j < m; j++)
+                    mp_addmul(c[i * m + j], f,
+                              down_cast<const Integer &>(*B.get(k, j))
+                                  .as_integer_class());
+            }
+        for (unsigned k = 0; k < n * m; k++)
+            C.set(k / m, k % m, integer(std::move(c[k])));
+        return true;
+    }
+
+    std::vector<rational_class> c(n * m, rational_class(0));
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned k = 0; k < l; k++) {
+            const rational_class f = to_rational(A.get(i, k));
+            if (mp_sign(f) == 0)
+                continue;
+            for (unsigned j = 0; j < m; j++)
+                c[i * m + j] += f * to_rational(B.get(k, j));
+        }
+    for (unsigned k = 0; k < n * m; k++)
+        C.set(k / m, k % m, Rational::from_mpq(std::move(c[k])));
+    return true;
+}
+
 } // namespace SymEngine
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <iterator>
 #include <symengine/visitor.h>
 #include <symengine/subs.h>
 #include <symengine/symengine_casts.h>
@@ -786,6 +788,10 @@ const RCP<const Basic> &DiffVisitor::apply(const Basic &b)
 
 const RCP<const Basic> &DiffVisitor::apply(const RCP<const Basic> &b)
 {
+    if (deps != nullptr and not deps->depends(*b, index)) {
+        result_ = zero;
+        return result_;
+    }
     if (not cache) {
         b->accept(*this);
         return result_;
@@ -807,11 +813,416 @@ RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x,
     return v.apply(arg);
 }
 
+// Calls `f` on the children of `b` and returns true, or returns false if the
+// children of this type are not known. The coefficients of Add and Mul are
+// numbers, so they are skipped.
+static bool
+for_each_child(const Basic &b,
+               const std::function<void(const RCP<const Basic> &)> &f)
+{
+    if (is_a<Add>(b)) {
+        for (const auto &p : down_cast<const Add &>(b).get_dict()) {
+            f(p.first);
+        }
+    } else if (is_a<Mul>(b)) {
+        for (const auto &p : down_cast<const Mul &>(b).get_dict()) {
+            f(p.first);
+            f(p.second);
+        }
+    } else if (is_a<Pow>(b) or is_a_sub<OneArgFunction>(b)
+               or is_a_sub<TwoArgFunction>(b) or is_a_sub<MultiArgFunction>(b)
+               or is_a<Piecewise>(b)) {
+        b.for_each_arg([&f](const RCP<const Basic> &c) {
+            f(c);
+            return true;
+        });
+    } else if (not is_a_Atom(b)) {
+        return false;
+    }
+    return true;
+}
+
+SymbolDependencies::SymbolDependencies(const RCP<const Basic> &expr,
+                                       const vec_sym &x)
+    : expr_(expr), nsyms_(numeric_cast<unsigned>(x.size()))
+{
+    std::unordered_map<RCP<const Basic>, std::vector<unsigned>, RCPBasicHash,
+                       RCPBasicKeyEq>
+        sym_indices;
+    for (unsigned i = 0; i < x.size(); i++) {
+        sym_indices[x[i]].push_back(i);
+    }
+
+    // Post-order walk with an explicit stack: a node is pushed once to push
+    // its children, and again to merge their dependencies
+    std::vector<std::pair<RCP<const Basic>, bool>> stack;
+    stack.push_back({expr, false});
+    while (not stack.empty()) {
+        RCP<const Basic> b = stack.back().first;
+        bool children_done = stack.back().second;
+        stack.pop_back();
+        if (deps_.find(b) != deps_.end()) {
+            continue;
+        }
+        if (not children_done) {
+            stack.push_back({b, true});
+            bool known = for_each_child(*b, [&](const RCP<const Basic> &c) {
+                if (deps_.find(c) == deps_.end()) {
+                    stack.push_back({c, false});
+                }
+            });
+            if (not known) {
+                stack.pop_back();
+                deps_[b].all = true;
+            }
+            continue;
+        }
+        Deps d;
+        if (is_a_sub<Symbol>(*b)) {
+            auto it = sym_indices.find(b);
+            if (it != sym_indices.end()) {
+                d.indices = it->second;
+            }
+        }
+        for_each_child(*b, [&](const RCP<const Basic> &c) {
+            const Deps &dc = deps_.at(c);
+            if (d.all or dc.all) {
+                d.all = true;
+                return;
+            }
+            std::vector<unsigned> merged;
+            merged.reserve(d.indices.size() + dc.indices.size());
+            std::set_union(d.indices.begin(), d.indices.end(),
+                           dc.indices.begin(), dc.indices.end(),
+                           std::back_inserter(merged));
+            d.indices.swap(merged);
+        });
+        if (d.all) {
+            d.indices.clear();
+        }
+        deps_[b] = std::move(d);
+    }
+}
+
+bool SymbolDependencies::depends(const Basic &b, unsigned i) const
+{
+    auto it = deps_.find(b.rcp_from_this());
+    if (it == deps_.end() or it->second.all) {
+        // e.g. a subexpression created while differentiating
+        return true;
+    }
+    return std::binary_search(it->second.indices.begin(),
+                              it->second.indices.end(), i);
+}
+
+std::vector<unsigned> SymbolDependencies::indices() const
+{
+    const Deps &d = deps_.at(expr_);
+    if (not d.all) {
+        return d.indices;
+    }
+    std::vector<unsigned> all(nsyms_);
+    for (unsigned i = 0; i < nsyms_; i++) {
+        all[i] = i;
+    }
+    return all;
+}
+
+vec_basic diff(const RCP<const Basic> &arg, const vec_sym &x, bool cache)
+{
+    SymbolDependencies deps(arg, x);
+    vec_basic result(x.size(), zero);
+    for (unsigned i : deps.indices()) {
+        DiffVisitor v(x[i], deps, i, cache);
+        result[i] = v.apply(arg);
+    }
+    return result;
+}
+
 RCP<const Basic> Basic::diff(const RCP<const Symbol> &x, bool cache) const
 {
     return SymEngine::diff(this->rcp_from_this(), x, cache);
 }
 
+namespace
+{
+
+// A subexpression of the expression whose gradient is computed
+struct AdjointNode {
+    RCP<const Basic> expr;
+    //! Indices of the children in the table of nodes
+    std::vector<size_t> children;
+    //! Opaque nodes are differentiated as a whole, w.r.t. the symbols in `syms`
+    bool opaque = false;
+    std::vector<unsigned> syms;
+    //! For functions, the derivatives w.r.t. each argument, in terms of dummies
+    const vec_basic *partials = nullptr;
+    //! Whether the node depends on any of the symbols
+    bool active = false;
+    //! The contributions of the parents to the adjoint of this node
+    vec_basic adjoint_terms;
+};
+
+// Appends the children of `b` w.r.t. which the partial derivatives of `b`
+// are computed, or returns false if the type of `b` is not known, in which
+// case `b` is differentiated as a whole.
+bool adjoint_children(const Basic &b, vec_basic &children)
+{
+    if (is_a<Add>(b)) {
+        for (const auto &p : down_cast<const Add &>(b).get_dict()) {
+            children.push_back(p.first);
+        }
+    } else if (is_a<Mul>(b)) {
+        // The factors with a symbolic exponent are children as a whole
+        for (const auto &p : down_cast<const Mul &>(b).get_dict()) {
+            if (is_a_Number(*p.second)) {
+                children.push_back(p.first);
+            } else {
+                children.push_back(pow(p.first, p.second));
+            }
+        }
+    } else if (is_a<Pow>(b) or is_a_sub<OneArgFunction>(b)
+               or is_a_sub<TwoArgFunction>(b)
+               or is_a_sub<MultiArgFunction>(b)) {
+        vec_basic args = b.get_args();
+        children.insert(children.end(), args.begin(), args.end());
+    } else if (not is_a_Atom(b)) {
+        return false;
+    }
+    return true;
+}
+
+class AdjointSweep
+{
+private:
+    const vec_sym &x_;
+    std::unordered_map<RCP<const Basic>, std::vector<unsigned>, RCPBasicHash,
+                       RCPBasicKeyEq>
+        sym_indices_;
+    std::vector<AdjointNode> nodes_;
+    //! Symbols standing for the arguments of functions
+    vec_basic dummies_;
+    //! Functions of dummies, and their derivatives w.r.t. each dummy
+    std::unordered_map<RCP<const Basic>, vec_basic, RCPBasicHash,
+                       RCPBasicKeyEq>
+        partials_;
+
+    const vec_basic *function_partials(const Basic &b, size_t nargs);
+    void build(const RCP<const Basic> &f);
+    void propagate(const AdjointNode &n, const RCP<const Basic> &adj);
+    void push(size_t child, const RCP<const Basic> &adj,
+              const RCP<const Basic> &partial)
+    {
+        nodes_[child].adjoint_terms.push_back(mul(adj, partial));
+    }
+
+public:
+    AdjointSweep(const vec_sym &x) : x_(x)
+    {
+        for (unsigned i = 0; i < x.size(); i++) {
+            sym_indices_[x[i]].push_back(i);
+        }
+    }
+    vec_basic apply(const RCP<const Basic> &f);
+};
+
+// Returns the derivatives of the function `b` w.r.t. each of its `nargs`
+// arguments, with the arguments replaced by dummies, or nullptr if they are
+// not all known. They only depend on the type of `b`, so they are cached.
+const vec_basic *AdjointSweep::function_partials(const Basic &b, size_t nargs)
+{
+    // Plain symbols, as Derivative only accepts those as variables. `g` has
+    // no other symbols, and subs() replaces all of them at once, so they
+    // cannot clash with the symbols of the arguments.
+    while (dummies_.size() < nargs) {
+        dummies_.push_back(symbol("_x" + std::to_string(dummies_.size())));
+    }
+    vec_basic dargs(dummies_.begin(), dummies_.begin() + nargs);
+    RCP<const Basic> g;
+    if (is_a_sub<OneArgFunction>(b)) {
+        g = down_cast<const OneArgFunction &>(b).create(dargs[0]);
+    } else if (is_a_sub<TwoArgFunction>(b)) {
+        g = down_cast<const TwoArgFunction &>(b).create(dargs[0], dargs[1]);
+    } else {
+        g = down_cast<const MultiArgFunction &>(b).create(dargs);
+    }
+    auto it = partials_.find(g);
+    if (it == partials_.end()) {
+        vec_basic partials;
+        try {
+            for (const auto &d : dargs) {
+                RCP<const Basic> p
+                    = SymEngine::diff(g, rcp_static_cast<const Symbol>(d));
+                if (is_a<Derivative>(*p)) {
+                    // e.g. a FunctionSymbol
+                    partials.clear();
+                    break;
+                }
+                partials.push_back(p);
+            }
+        } catch (SymEngineException &) {
+            // Only raised again if `b` depends on the symbols
+            partials.clear();
+        }
+        it = partials_.insert({g, std::move(partials)}).first;
+    }
+    return it->second.empty() ? nullptr : &it->second;
+}
+
+// Builds the table of the nodes of `f` in post-order, without recursion, so
+// that each node comes after all of its children
+void AdjointSweep::build(const RCP<const Basic> &f)
+{
+    std::unordered_map<RCP<const Basic>, size_t, RCPBasicHash, RCPBasicKeyEq>
+        index;
+    std::vector<std::pair<RCP<const Basic>, bool>> stack;
+    stack.push_back({f, false});
+    while (not stack.empty()) {
+        RCP<const Basic> b = stack.back().first;
+        bool children_done = stack.back().second;
+        stack.pop_back();
+        if (index.find(b) != index.end()) {
+            continue;
+        }
+        vec_basic children;
+        bool known = adjoint_children(*b, children);
+        const vec_basic *partials = nullptr;
+        if (known and not children.empty() and not is_a<Add>(*b)
+            and not is_a<Mul>(*b) and not is_a<Pow>(*b)) {
+            partials = function_partials(*b, children.size());
+            known = partials != nullptr;
+        }
+        if (not children_done and known) {
+            stack.push_back({b, true});
+            for (const auto &c : children) {
+                if (index.find(c) == index.end()) {
+                    stack.push_back({c, false});
+                }
+            }
+            continue;
+        }
+        AdjointNode n;
+        n.expr = b;
+        n.partials = partials;
+        if (not known) {
+            n.opaque = true;
+            for (const auto &s : free_symbols(*b)) {
+                auto it = sym_indices_.find(s);
+                if (it != sym_indices_.end()) {
+                    n.syms.insert(n.syms.end(), it->second.begin(),
+                                  it->second.end());
+                }
+            }
+            n.active = not n.syms.empty();
+        } else if (is_a_sub<Symbol>(*b)) {
+            n.active = sym_indices_.find(b) != sym_indices_.end();
+        } else {
+            for (const auto &c : children) {
+                size_t i = index.at(c);
+                n.children.push_back(i);
+                n.active = n.active or nodes_[i].active;
+            }
+        }
+        index[b] = nodes_.size();
+        nodes_.push_back(std::move(n));
+    }
+}
+
+// Adds the contributions of the node `n`, whose adjoint is `adj`, to the
+// adjoints of its children that depend on the symbols
+void AdjointSweep::propagate(const AdjointNode &n, const RCP<const Basic> &adj)
+{
+    const Basic &b = *n.expr;
+    auto active = [&](size_t k) { return nodes_[n.children[k]].active; };
+    size_t k = 0;
+    if (is_a<Add>(b)) {
+        for (const auto &p : down_cast<const Add &>(b).get_dict()) {
+            if (active(k)) {
+                push(n.children[k], adj, p.second);
+            }
+            k++;
+        }
+    } else if (is_a<Mul>(b)) {
+        for (const auto &p : down_cast<const Mul &>(b).get_dict()) {
+            if (active(k)) {
+                const RCP<const Basic> &c = nodes_[n.children[k]].expr;
+                if (is_a_Number(*p.second)) {
+                    push(n.children[k], adj, mul(p.second, div(n.expr, c)));
+                } else {
+                    push(n.children[k], adj, div(n.expr, c));
+                }
+            }
+            k++;
+        }
+    } else if (is_a<Pow>(b)) {
+        const Pow &self = down_cast<const Pow &>(b);
+        if (active(0)) {
+            push(n.children[0], adj,
+                 mul(self.get_exp(),
+                     pow(self.get_base(), sub(self.get_exp(), one))));
+        }
+        if (active(1)) {
+            push(n.children[1], adj, mul(n.expr, log(self.get_base())));
+        }
+    } else if (n.partials != nullptr) {
+        // A function: the dummies in its derivatives stand for its arguments
+        map_basic_basic args;
+        for (k = 0; k < n.children.size(); k++) {
+            args[dummies_[k]] = nodes_[n.children[k]].expr;
+        }
+        for (k = 0; k < n.children.size(); k++) {
+            if (active(k)) {
+                push(n.children[k], adj, subs((*n.partials)[k], args));
+            }
+        }
+    }
+}
+
+vec_basic AdjointSweep::apply(const RCP<const Basic> &f)
+{
+    build(f);
+    std::vector<vec_basic> grad_terms(x_.size());
+    nodes_.back().adjoint_terms.push_back(one);
+    // The parents of each node come before it in reverse post-order, so its
+    // adjoint is complete when it is reached
+    for (size_t i = nodes_.size(); i-- > 0;) {
+        AdjointNode &n = nodes_[i];
+        if (not n.active or n.adjoint_terms.empty()) {
+            continue;
+        }
+        RCP<const Basic> adj = n.adjoint_terms.size() == 1
+                                   ? n.adjoint_terms[0]
+                                   : add(n.adjoint_terms);
+        vec_basic().swap(n.adjoint_terms);
+        if (n.opaque) {
+            for (unsigned s : n.syms) {
+                grad_terms[s].push_back(
+                    mul(adj, SymEngine::diff(n.expr, x_[s])));
+            }
+        } else if (is_a_sub<Symbol>(*n.expr)) {
+            for (unsigned s : sym_indices_.at(n.expr)) {
+                grad_terms[s].push_back(adj);
+            }
+        } else {
+            propagate(n, adj);
+        }
+    }
+    vec_basic result;
+    result.reserve(x_.size());
+    for (const auto &terms : grad_terms) {
+        result.push_back(add(terms));
+    }
+    return result;
+}
+
+} // namespace
+
+vec_basic gradient(const RCP<const Basic> &f, const vec_sym &x)
+{
+    AdjointSweep sweep(x);
+    return sweep.apply(f);
+}
+
 //! SymPy style differentiation for non-symbol variables
 // Since SymPy's differentiation makes no sense mathematically, it is
 // defined separately here for compatibility
@@ -21,6 +21,44 @@ RCP<const Basic> diff(const RCP<const Basic> &arg, const RCP<const Symbol> &x,
 RCP<const Basic> sdiff(const RCP<const Basic> &arg, const RCP<const Basic> &x,
                        bool cache = true);
 
+//! Differentiation w.r.t each of the symbols in `x`. Only the derivatives
+//! w.r.t. the symbols that appear in `arg` are computed, the others are zero.
+vec_basic diff(const RCP<const Basic> &arg, const vec_sym &x,
+               bool cache = true);
+
+//! Gradient of `f` w.r.t. the symbols `x`, in reverse mode: the expression is
+//! walked once, and the adjoint of each subexpression is computed once and
+//! shared by the derivatives that need it, so that `cse()` can find it. The
+//! result can be passed to the `Lambda` and `LLVM` visitors directly.
+vec_basic gradient(const RCP<const Basic> &f, const vec_sym &x);
+
+/*! Finds which of the symbols `x` each subexpression of an expression may
+    depend on. The expression is walked once, without recursion, so that the
+    derivatives w.r.t. each symbol can skip the subexpressions that do not
+    contain it.
+*/
+class SymbolDependencies
+{
+private:
+    struct Deps {
+        //! Types that are not known are assumed to depend on all symbols
+        bool all = false;
+        //! Sorted indices into `x`
+        std::vector<unsigned> indices;
+    };
+    std::unordered_map<RCP<const Basic>, Deps, RCPBasicHash, RCPBasicKeyEq>
+        deps_;
+    RCP<const Basic> expr_;
+    unsigned nsyms_;
+
+public:
+    SymbolDependencies(const RCP<const Basic> &expr, const vec_sym &x);
+    //! \return false if `b` does not depend on `x[i]`
+    bool depends(const Basic &b, unsigned i) const;
+    //! \return the indices of the symbols the expression may depend on
+    std::vector<unsigned> indices() const;
+};
+
 class DiffVisitor : public BaseVisitor<DiffVisitor>
 {
 protected:
@@ -28,12 +66,21 @@ protected:
     RCP<const Basic> result_;
     umap_basic_basic visited;
     bool cache;
+    //! If not null, the subexpressions that do not depend on `x`, which is
+    //! the symbol number `index` of `deps`, are not visited
+    const SymbolDependencies *deps = nullptr;
+    unsigned index = 0;
 
 public:
     DiffVisitor(const RCP<const Symbol> &x, bool cache = true)
         : x(x), cache(cache)
     {
     }
+    DiffVisitor(const RCP<const Symbol> &x, const SymbolDependencies &deps,
+                unsigned index, bool cache = true)
+        : x(x), cache(cache), deps(&deps), index(index)
+    {
+    }
 // Uncomment the following define in order to debug the methods:
 #define debug_methods
 #ifndef debug_methods
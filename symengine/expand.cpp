@@ -1,4 +1,5 @@
 #include <symengine/visitor.h>
+#include <memory>
 
 namespace SymEngine
 {
@@ -26,9 +27,17 @@ private:
     RCP<const Number> coeff = zero;
     RCP<const Number> multiply = one;
     bool deep;
+    unsigned nthreads;
+
+    // Products and powers with fewer terms than this are always expanded
+    // serially
+    static const size_t parallel_threshold = 1000;
 
 public:
-    ExpandVisitor(bool deep_ = true) : deep(deep_) {}
+    ExpandVisitor(bool deep_ = true, unsigned nthreads_ = 1)
+        : deep(deep_), nthreads(nthreads_)
+    {
+    }
     RCP<const Basic> apply(const Basic &b)
     {
         b.accept(*this);
@@ -76,6 +85,86 @@ public:
         this->_coef_dict_add_term(multiply, self.rcp_from_this());
     }
 
+    //! Adds the terms accumulated by `other` to this visitor
+    void merge(const ExpandVisitor &other)
+    {
+        iaddnum(outArg(coeff), other.coeff);
+        for (const auto &p : other.d_) {
+            Add::dict_add_term(d_, p.second, p.first);
+        }
+    }
+
+    /*! Calls `f(v, i)` for `0 <= i < n`, where `v` is the visitor in which
+        the resulting terms are accumulated. If built with OpenMP,
+        `nthreads > 1` and the number of terms produced (`work`) is large
+        enough, the indices are distributed over `nthreads` visitors that run
+        in parallel and are merged into this one at the end. Otherwise all
+        the terms go directly into this visitor.
+    */
+    template <typename F>
+    void parallel_for_terms(size_t n, size_t work, F f)
+    {
+#ifdef _OPENMP
+        const bool parallel = nthreads > 1 and work >= parallel_threshold;
+#else
+        const bool parallel = false;
+#endif
+        if (not parallel) {
+            for (size_t i = 0; i < n; i++) {
+                f(*this, i);
+            }
+            return;
+        }
+        const unsigned nparts = nthreads;
+        std::vector<std::unique_ptr<ExpandVisitor>> partial(nparts);
+        for (auto &v : partial) {
+            v.reset(new ExpandVisitor(deep, 1));
+            v->multiply = multiply;
+        }
+#pragma omp parallel for num_threads(nparts) schedule(static, 1)
+        for (unsigned t = 0; t < nparts; t++) {
+            for (size_t i = t; i < n; i += nparts) {
+                f(*partial[t], i);
+            }
+        }
+        for (const auto &v : partial) {
+            merge(*v);
+        }
+    }
+
+    //! Adds `multiply * coef * term * b` to the result, where `b` is an
+    //! expanded `Add`
+    void mul_expand_term_add(const RCP<const Basic> &term_,
+                             const RCP<const Number> &coef, const Add &b)
+    {
+        RCP<const Number> temp = _mulnum(coef, multiply);
+        for (auto &q : b.get_dict()) {
+            // The main bottleneck here is the mul(term_, q.first) command
+            RCP<const Basic> term = mul(term_, q.first);
+            if (is_a_Number(*term)) {
+                iaddnum(outArg(coeff),
+                        _mulnum(_mulnum(temp, q.second),
+                                rcp_static_cast<const Number>(term)));
+            } else {
+                if (is_a<Mul>(*term)
+                    && !(down_cast<const Mul &>(*term).get_coef()->is_one())) {
+                    // Tidy up things like {2x: 3} -> {x: 6}
+                    RCP<const Number> coef2
+                        = down_cast<const Mul &>(*term).get_coef();
+                    // We make a copy of the dict_:
+                    map_basic_basic d2
+                        = down_cast<const Mul &>(*term).get_dict();
+                    term = Mul::from_dict(one, std::move(d2));
+                    Add::dict_add_term(
+                        d_, _mulnum(_mulnum(temp, q.second), coef2), term);
+                } else {
+                    Add::dict_add_term(d_, _mulnum(temp, q.second), term);
+                }
+            }
+        }
+        Add::dict_add_term(d_, _mulnum(b.get_coef(), temp), term_);
+    }
+
     void mul_expand_two(const RCP<const Basic> &a, const RCP<const Basic> &b)
     {
         // Both a and b are assumed to be expanded
@@ -91,41 +180,18 @@ public:
                              * (down_cast<const Add &>(*b)).get_dict().size());
 #endif
             // Expand dicts first:
+            const Add &b_add = down_cast<const Add &>(*b);
+            std::vector<const umap_basic_num::value_type *> a_terms;
+            a_terms.reserve(down_cast<const Add &>(*a).get_dict().size());
             for (auto &p : (down_cast<const Add &>(*a)).get_dict()) {
-                RCP<const Number> temp = _mulnum(p.second, multiply);
-                for (auto &q : (down_cast<const Add &>(*b)).get_dict()) {
-                    // The main bottleneck here is the mul(p.first, q.first)
-                    // command
-                    RCP<const Basic> term = mul(p.first, q.first);
-                    if (is_a_Number(*term)) {
-                        iaddnum(outArg(coeff),
-                                _mulnum(_mulnum(temp, q.second),
-                                        rcp_static_cast<const Number>(term)));
-                    } else {
-                        if (is_a<Mul>(*term)
-                            && !(down_cast<const Mul &>(*term)
-                                     .get_coef()
-                                     ->is_one())) {
-                            // Tidy up things like {2x: 3} -> {x: 6}
-                            RCP<const Number> coef2
-                                = down_cast<const Mul &>(*term).get_coef();
-                            // We make a copy of the dict_:
-                            map_basic_basic d2
-                                = down_cast<const Mul &>(*term).get_dict();
-                            term = Mul::from_dict(one, std::move(d2));
-                            Add::dict_add_term(
-                                d_, _mulnum(_mulnum(temp, q.second), coef2),
-                                term);
-                        } else {
-                            Add::dict_add_term(d_, _mulnum(temp, q.second),
-                                               term);
-                        }
-                    }
-                }
-                Add::dict_add_term(
-                    d_, _mulnum(down_cast<const Add &>(*b).get_coef(), temp),
-                    p.first);
+                a_terms.push_back(&p);
             }
+            parallel_for_terms(
+                a_terms.size(), a_terms.size() * b_add.get_dict().size(),
+                [&](ExpandVisitor &v, size_t i) {
+                    v.mul_expand_term_add(a_terms[i]->first,
+                                          a_terms[i]->second, b_add);
+                });
             // Handle the coefficient of "a":
             RCP<const Number> temp
                 = _mulnum(down_cast<const Add &>(*a).get_coef(), multiply);
@@ -210,6 +276,73 @@ public:
         }
     }
 
+    //! Adds `multiply * c * prod(base_i**powers_i)` to the result
+    void multinomial_term_expand(const umap_basic_num &base_dict,
+                                 const vec_uint &powers, const integer_class &c)
+    {
+        auto power = powers.begin();
+        auto i2 = base_dict.begin();
+        map_basic_basic d;
+        RCP<const Number> overall_coeff = one;
+        for (; power != powers.end(); ++power, ++i2) {
+            if (*power > 0) {
+                RCP<const Integer> exp = integer(*power);
+                RCP<const Basic> base = i2->first;
+                if (is_a<Integer>(*base)) {
+                    _imulnum(outArg(overall_coeff),
+                             rcp_static_cast<const Number>(
+                                 down_cast<const Integer &>(*base).powint(
+                                     *exp)));
+                } else if (is_a<Symbol>(*base)) {
+                    Mul::dict_add_term(d, exp, base);
+                } else {
+                    RCP<const Basic> exp2, t, tmp;
+                    tmp = pow(base, exp);
+                    if (is_a<Mul>(*tmp)) {
+                        for (auto &p :
+                             (down_cast<const Mul &>(*tmp)).get_dict()) {
+                            Mul::dict_add_term_new(outArg(overall_coeff), d,
+                                                   p.second, p.first);
+                        }
+                        _imulnum(outArg(overall_coeff),
+                                 (down_cast<const Mul &>(*tmp)).get_coef());
+                    } else if (is_a_Number(*tmp)) {
+                        _imulnum(outArg(overall_coeff),
+                                 rcp_static_cast<const Number>(tmp));
+                    } else {
+                        Mul::as_base_exp(tmp, outArg(exp2), outArg(t));
+                        Mul::dict_add_term_new(outArg(overall_coeff), d,
+                                               exp2, t);
+                    }
+                }
+                if (!(i2->second->is_one())) {
+                    _imulnum(outArg(overall_coeff),
+                             pownum(i2->second,
+                                    rcp_static_cast<const Number>(exp)));
+                }
+            }
+        }
+        RCP<const Basic> term = Mul::from_dict(overall_coeff, std::move(d));
+        RCP<const Number> coef2 = integer(c);
+        if (is_a_Number(*term)) {
+            iaddnum(outArg(coeff),
+                    _mulnum(_mulnum(multiply,
+                                    rcp_static_cast<const Number>(term)),
+                            coef2));
+        } else {
+            if (is_a<Mul>(*term)
+                && !(down_cast<const Mul &>(*term).get_coef()->is_one())) {
+                // Tidy up things like {2x: 3} -> {x: 6}
+                _imulnum(outArg(coef2),
+                         down_cast<const Mul &>(*term).get_coef());
+                // We make a copy of the dict_:
+                map_basic_basic d2 = down_cast<const Mul &>(*term).get_dict();
+                term = Mul::from_dict(one, std::move(d2));
+            }
+            Add::dict_add_term(d_, _mulnum(multiply, coef2), term);
+        }
+    }
+
     void pow_expand(umap_basic_num &base_dict, unsigned n)
     {
         map_vec_mpz r;
@@ -220,70 +353,16 @@ public:
 #if defined(HAVE_SYMENGINE_RESERVE)
         d_.reserve(d_.size() + 2 * r.size());
 #endif
+        std::vector<const map_vec_mpz::value_type *> terms;
+        terms.reserve(r.size());
         for (auto &p : r) {
-            auto power = p.first.begin();
-            auto i2 = base_dict.begin();
-            map_basic_basic d;
-            RCP<const Number> overall_coeff = one;
-            for (; power != p.first.end(); ++power, ++i2) {
-                if (*power > 0) {
-                    RCP<const Integer> exp = integer(std::move(*power));
-                    RCP<const Basic> base = i2->first;
-                    if (is_a<Integer>(*base)) {
-                        _imulnum(outArg(overall_coeff),
-                                 rcp_static_cast<const Number>(
-                                     down_cast<const Integer &>(*base).powint(
-                                         *exp)));
-                    } else if (is_a<Symbol>(*base)) {
-                        Mul::dict_add_term(d, exp, base);
-                    } else {
-                        RCP<const Basic> exp2, t, tmp;
-                        tmp = pow(base, exp);
-                        if (is_a<Mul>(*tmp)) {
-                            for (auto &p :
-                                 (down_cast<const Mul &>(*tmp)).get_dict()) {
-                                Mul::dict_add_term_new(outArg(overall_coeff), d,
-                                                       p.second, p.first);
-                            }
-                            _imulnum(outArg(overall_coeff),
-                                     (down_cast<const Mul &>(*tmp)).get_coef());
-                        } else if (is_a_Number(*tmp)) {
-                            _imulnum(outArg(overall_coeff),
-                                     rcp_static_cast<const Number>(tmp));
-                        } else {
-                            Mul::as_base_exp(tmp, outArg(exp2), outArg(t));
-                            Mul::dict_add_term_new(outArg(overall_coeff), d,
-                                                   exp2, t);
-                        }
-                    }
-                    if (!(i2->second->is_one())) {
-                        _imulnum(outArg(overall_coeff),
-                                 pownum(i2->second,
-                                        rcp_static_cast<const Number>(exp)));
-                    }
-                }
-            }
-            RCP<const Basic> term = Mul::from_dict(overall_coeff, std::move(d));
-            RCP<const Number> coef2 = integer(p.second);
-            if (is_a_Number(*term)) {
-                iaddnum(outArg(coeff),
-                        _mulnum(_mulnum(multiply,
-                                        rcp_static_cast<const Number>(term)),
-                                coef2));
-            } else {
-                if (is_a<Mul>(*term)
-                    && !(down_cast<const Mul &>(*term).get_coef()->is_one())) {
-                    // Tidy up things like {2x: 3} -> {x: 6}
-                    _imulnum(outArg(coef2),
-                             down_cast<const Mul &>(*term).get_coef());
-                    // We make a copy of the dict_:
-                    map_basic_basic d2
-                        = down_cast<const Mul &>(*term).get_dict();
-                    term = Mul::from_dict(one, std::move(d2));
-                }
-                Add::dict_add_term(d_, _mulnum(multiply, coef2), term);
-            }
+            terms.push_back(&p);
         }
+        parallel_for_terms(terms.size(), terms.size(),
+                           [&](ExpandVisitor &v, size_t i) {
+                               v.multinomial_term_expand(
+                                   base_dict, terms[i]->first, terms[i]->second);
+                           });
     }
 
     void bvisit(const Pow &self)
@@ -358,7 +437,7 @@ private:
     RCP<const Basic> expand_if_deep(const RCP<const Basic> &expr)
     {
         if (deep) {
-            return expand(expr);
+            return expand(expr, true, nthreads);
         } else {
             return expr;
         }
@@ -372,4 +451,12 @@ RCP<const Basic> expand(const RCP<const Basic> &self, bool deep)
     return v.apply(*self);
 }
 
+//! Expands `self`, distributing large products and powers over `nthreads`
+RCP<const Basic> expand(const RCP<const Basic> &self, bool deep,
+                        unsigned nthreads)
+{
+    ExpandVisitor v(deep, nthreads);
+    return v.apply(*self);
+}
+
 } // namespace SymEngine
@@ -3,10 +3,17 @@
 #include <symengine/constants.h>
 #include <symengine/mul.h>
 #include <symengine/pow.h>
+#include <symengine/polys/dense_mul.h>
 #include <symengine/symengine_exception.h>
 
 namespace SymEngine
 {
+using detail::dense_divrem_mod;
+using detail::dense_mul_mod;
+using detail::dense_strip;
+using detail::vec_word;
+using detail::WordModulus;
+
 GaloisField::GaloisField(const RCP<const Basic> &var, GaloisFieldDict &&dict)
     : UIntPolyBase(var, std::move(dict))
 {
@@ -178,6 +185,50 @@ void GaloisFieldDict::gf_istrip()
     }
 }
 
+namespace
+{
+
+vec_word to_words(const std::vector<integer_class> &v)
+{
+    vec_word w(v.size());
+    for (size_t i = 0; i < v.size(); i++)
+        w[i] = mp_get_ui(v[i]);
+    return w;
+}
+
+std::vector<integer_class> from_words(const vec_word &w)
+{
+    std::vector<integer_class> v(w.size());
+    for (size_t i = 0; i < w.size(); i++)
+        v[i] = integer_class(static_cast<unsigned long>(w[i]));
+    return v;
+}
+
+void word_monic(vec_word &a, const WordModulus &m)
+{
+    if (a.empty() or a.back() == 1)
+        return;
+    const uint64_t inv = m.invert(a.back());
+    for (auto &c : a)
+        c = m.mul(c, inv);
+}
+
+} // namespace
+
+bool GaloisFieldDict::is_word_modulus() const
+{
+    return mp_fits_ulong_p(modulo_) and modulo_ > 1
+           and mp_get_ui(modulo_) <= 0xFFFFFFFFul;
+}
+
+void GaloisFieldDict::gf_word_idiv(const GaloisFieldDict &o, bool quotient)
+{
+    const WordModulus m(mp_get_ui(modulo_));
+    vec_word a = to_words(dict_), quo;
+    dense_divrem_mod(a, to_words(o.dict_), m, quotient ? &quo : nullptr);
+    dict_ = from_words(quotient ? quo : a);
+}
+
 GaloisFieldDict GaloisFieldDict::mul(const GaloisFieldDict &a,
                                      const GaloisFieldDict &b)
 {
@@ -187,21 +238,18 @@ GaloisFieldDict GaloisFieldDict::mul(const GaloisFieldDict &a,
         return a;
     if (b.get_dict().empty())
         return b;
-
     GaloisFieldDict p;
-    p.dict_.resize(a.degree() + b.degree() + 1, integer_class(0));
     p.modulo_ = a.modulo_;
-    for (unsigned int i = 0; i <= a.degree(); i++)
-        for (unsigned int j = 0; j <= b.degree(); j++) {
-            auto temp = a.dict_[i];
-            temp *= b.dict_[j];
-            if (temp != integer_class(0)) {
-                auto t = p.dict_[i + j];
-                t += temp;
-                mp_fdiv_r(t, t, a.modulo_);
-                p.dict_[i + j] = t;
-            }
-        }
+    if (a.is_word_modulus()) {
+        const WordModulus m(mp_get_ui(a.modulo_));
+        p.dict_ = from_words(
+            dense_mul_mod(to_words(a.dict_), to_words(b.dict_), m));
+        return p;
+    }
+    // Multiply over the integers and reduce each coefficient once
+    p.dict_ = dense_mul(a.dict_, b.dict_);
+    for (auto &c : p.dict_)
+        mp_fdiv_r(c, c, a.modulo_);
     p.gf_istrip();
     return p;
 }
@@ -226,6 +274,12 @@ void GaloisFieldDict::gf_div(const GaloisFieldDict &o,
     if (deg_dividend < deg_divisor) {
         *quo = GaloisFieldDict::from_vec(dict_out, modulo_);
         *rem = GaloisFieldDict::from_vec(dict_, modulo_);
+    } else if (is_word_modulus()) {
+        const WordModulus m(mp_get_ui(modulo_));
+        vec_word r = to_words(dict_), q;
+        dense_divrem_mod(r, to_words(dict_divisor), m, &q);
+        *quo = GaloisFieldDict::from_vec(from_words(q), modulo_);
+        *rem = GaloisFieldDict::from_vec(from_words(r), modulo_);
     } else {
         dict_out = dict_;
         integer_class inv;
@@ -341,6 +395,19 @@ GaloisFieldDict GaloisFieldDict::gf_gcd(const GaloisFieldDict &o) const
 {
     if (modulo_ != o.modulo_)
         throw SymEngineException("Error: field must be same.");
+    if (is_word_modulus()) {
+        const WordModulus m(mp_get_ui(modulo_));
+        vec_word f = to_words(dict_), g = to_words(o.dict_);
+        while (not g.empty()) {
+            dense_divrem_mod(f, g, m, nullptr);
+            f.swap(g);
+        }
+        word_monic(f, m);
+        GaloisFieldDict out;
+        out.modulo_ = modulo_;
+        out.dict_ = from_words(f);
+        return out;
+    }
     GaloisFieldDict f = down_cast<const GaloisFieldDict &>(*this);
     GaloisFieldDict g = o;
     GaloisFieldDict temp_out;
@@ -488,6 +555,24 @@ GaloisFieldDict GaloisFieldDict::gf_compose_mod(const GaloisFieldDict &g,
         throw SymEngineException("Error: field must be same.");
     if (g.dict_.size() == 0)
         return g;
+    if (is_word_modulus() and not dict_.empty()) {
+        const WordModulus m(mp_get_ui(modulo_));
+        const vec_word f = to_words(dict_), hw = to_words(h.dict_);
+        const vec_word gw = to_words(g.dict_);
+        vec_word out = {gw.back()};
+        for (auto i = gw.size() - 1; i-- != 0;) {
+            out = dense_mul_mod(out, hw, m);
+            if (out.empty())
+                out.push_back(0);
+            out[0] = m.add(out[0], gw[i]);
+            dense_strip(out);
+            dense_divrem_mod(out, f, m, nullptr);
+        }
+        GaloisFieldDict res;
+        res.modulo_ = modulo_;
+        res.dict_ = from_words(out);
+        return res;
+    }
     GaloisFieldDict out
         = GaloisFieldDict::from_vec({*(g.dict_.rbegin())}, modulo_);
     if (g.dict_.size() >= 2) {
@@ -516,6 +601,29 @@ GaloisFieldDict GaloisFieldDict::gf_pow_mod(const GaloisFieldDict &f,
     if (n == 2) {
         return f.gf_sqr() % (*this);
     }
+    if (is_word_modulus() and not dict_.empty()) {
+        // Stay on machine words for the whole square and multiply loop
+        const WordModulus m(mp_get_ui(modulo_));
+        const vec_word mod = to_words(dict_);
+        vec_word h = {1}, w = to_words(f.dict_);
+        dense_divrem_mod(h, mod, m, nullptr);
+        auto e = n;
+        while (true) {
+            if (e & 1) {
+                h = dense_mul_mod(h, w, m);
+                dense_divrem_mod(h, mod, m, nullptr);
+            }
+            e >>= 1;
+            if (e == 0)
+                break;
+            w = dense_mul_mod(w, w, m);
+            dense_divrem_mod(w, mod, m, nullptr);
+        }
+        GaloisFieldDict res;
+        res.modulo_ = modulo_;
+        res.dict_ = from_words(h);
+        return res;
+    }
     GaloisFieldDict h = GaloisFieldDict::from_vec({1_z}, modulo_);
     auto mod = n;
     while (true) {
@@ -18,6 +18,11 @@ public:
     std::vector<integer_class> dict_;
     integer_class modulo_;
 
+private:
+    // Replaces `*this` by its quotient (or remainder) by the nonzero `o`,
+    // computed on machine words. Requires is_word_modulus().
+    void gf_word_idiv(const GaloisFieldDict &o, bool quotient);
+
 public:
     struct DictLess {
         bool operator()(const GaloisFieldDict &a,
@@ -53,6 +58,9 @@ public:
 
     GaloisFieldDict(const GaloisFieldDict &) = default;
     GaloisFieldDict &operator=(const GaloisFieldDict &) = default;
+    //! Whether `modulo_` fits in 32 bits, in which case products, divisions,
+    //! gcds and modular powers are computed on machine words
+    bool is_word_modulus() const;
     void gf_div(const GaloisFieldDict &o, const Ptr<GaloisFieldDict> &quo,
                 const Ptr<GaloisFieldDict> &rem) const;
 
@@ -379,6 +387,10 @@ public:
         }
         if (dict_.empty())
             return down_cast<GaloisFieldDict &>(*this);
+        if (is_word_modulus()) {
+            gf_word_idiv(other, true);
+            return down_cast<GaloisFieldDict &>(*this);
+        }
         integer_class inv;
         mp_invert(inv, *(dict_divisor.rbegin()), modulo_);
 
@@ -449,6 +461,10 @@ public:
         }
         if (dict_.empty())
             return down_cast<GaloisFieldDict &>(*this);
+        if (is_word_modulus()) {
+            gf_word_idiv(other, false);
+            return down_cast<GaloisFieldDict &>(*this);
+        }
         integer_class inv;
         mp_invert(inv, *(dict_divisor.rbegin()), modulo_);
 
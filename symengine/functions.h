@@ -41,6 +41,11 @@ public:
     {
         return {arg_};
     }
+    inline bool for_each_arg(
+        const std::function<bool(const RCP<const Basic> &)> &f) const override
+    {
+        return f(arg_);
+    }
     //! Method to construct classes with canonicalization
     virtual RCP<const Basic> create(const RCP<const Basic> &arg) const = 0;
 
@@ -101,6 +106,11 @@ public:
     {
         return {a_, b_};
     }
+    inline bool for_each_arg(
+        const std::function<bool(const RCP<const Basic> &)> &f) const override
+    {
+        return f(a_) and f(b_);
+    }
     //! Method to construct classes with canonicalization
     virtual RCP<const Basic> create(const RCP<const Basic> &a,
                                     const RCP<const Basic> &b) const = 0;
@@ -160,6 +170,15 @@ public:
     {
         return arg_;
     }
+    inline bool for_each_arg(
+        const std::function<bool(const RCP<const Basic> &)> &f) const override
+    {
+        for (const auto &a : arg_) {
+            if (not f(a))
+                return false;
+        }
+        return true;
+    }
     inline const vec_basic &get_vec() const
     {
         return arg_;
@@ -26,6 +26,12 @@ int Integer::compare(const Basic &o) const
 {
     SYMENGINE_ASSERT(is_a<Integer>(o))
     const Integer &s = down_cast<const Integer &>(o);
+    long a, b;
+    if (get_small(a) and s.get_small(b)) {
+        if (a == b)
+            return 0;
+        return a < b ? -1 : 1;
+    }
     if (i == s.i)
         return 0;
     return i < s.i ? -1 : 1;
@@ -36,10 +42,11 @@ signed long int Integer::as_int() const
     // mp_get_si() returns "signed long int", so that's what we return from
     // "as_int()" and we leave it to the user to do any possible further integer
     // conversions.
-    if (not(mp_fits_slong_p(this->i))) {
+    long v;
+    if (not get_small(v)) {
         throw SymEngineException("as_int: Integer larger than int");
     }
-    return mp_get_si(this->i);
+    return v;
 }
 
 unsigned long int Integer::as_uint() const
@@ -7,6 +7,7 @@
 #ifndef SYMENGINE_INTEGER_H
 #define SYMENGINE_INTEGER_H
 
+#include <limits>
 #include <symengine/number.h>
 #include <symengine/symengine_exception.h>
 #include <symengine/symengine_casts.h>
@@ -14,6 +15,52 @@
 namespace SymEngine
 {
 
+/* Overflow-checked arithmetic on machine integers, used by the fast paths of
+ * `Integer` */
+//! Sets `r = a + b`. \return false if the result does not fit into a `long`
+inline bool checked_add(long a, long b, long &r)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return not __builtin_add_overflow(a, b, &r);
+#else
+    if ((b > 0 and a > std::numeric_limits<long>::max() - b)
+        or (b < 0 and a < std::numeric_limits<long>::min() - b))
+        return false;
+    r = a + b;
+    return true;
+#endif
+}
+
+//! Sets `r = a - b`. \return false if the result does not fit into a `long`
+inline bool checked_sub(long a, long b, long &r)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return not __builtin_sub_overflow(a, b, &r);
+#else
+    if ((b < 0 and a > std::numeric_limits<long>::max() + b)
+        or (b > 0 and a < std::numeric_limits<long>::min() + b))
+        return false;
+    r = a - b;
+    return true;
+#endif
+}
+
+//! Sets `r = a * b`. \return false if the result does not fit into a `long`
+inline bool checked_mul(long a, long b, long &r)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return not __builtin_mul_overflow(a, b, &r);
+#else
+    const long max = std::numeric_limits<long>::max();
+    const long min = std::numeric_limits<long>::min();
+    if (a > 0 ? (b > 0 ? a > max / b : b < min / a)
+              : (b > 0 ? a < min / b : (a != 0 and b < max / a)))
+        return false;
+    r = a * b;
+    return true;
+#endif
+}
+
 //! Integer Class
 class Integer : public Number
 {
@@ -21,15 +68,24 @@ private:
     //! `i` : object of `integer_class`
     integer_class i;
 
+    //! \return `true` and sets `v` if the value fits into a `long`. With GMP
+    //! this only reads the limbs of `i`.
+    bool get_small(long &v) const;
+
 public:
     IMPLEMENT_TYPEID(SYMENGINE_INTEGER)
     //! Constructor of Integer using `integer_class`
     // explicit Integer(integer_class i);
-    Integer(const integer_class &_i)
-        : i(_i){SYMENGINE_ASSIGN_TYPEID()} Integer(integer_class && _i)
-        : i(std::move(_i)){SYMENGINE_ASSIGN_TYPEID()}
-          //! \return size of the hash
-          hash_t __hash__() const override;
+    Integer(const integer_class &_i) : i(_i)
+    {
+        SYMENGINE_ASSIGN_TYPEID()
+    }
+    Integer(integer_class &&_i) : i(std::move(_i))
+    {
+        SYMENGINE_ASSIGN_TYPEID()
+    }
+    //! \return size of the hash
+    hash_t __hash__() const override;
     /*! Equality comparator
      * \param o - Object to be compared with
      * \return whether the 2 objects are equal
@@ -46,6 +102,12 @@ public:
     {
         return this->i;
     }
+    //! \return `true` if the value fits into a `long`
+    inline bool is_small() const
+    {
+        long v;
+        return get_small(v);
+    }
     //! \return `true` if `0`
     inline bool is_zero() const override
     {
@@ -78,22 +140,17 @@ public:
         return false;
     }
 
-    /* These are very fast methods for add/sub/mul/div/pow on Integers only */
+    /* These are very fast methods for add/sub/mul/div/pow on Integers only.
+     * If both operands fit into a `long`, they use overflow-checked machine
+     * arithmetic and only fall back to `integer_class` on overflow. Results
+     * in the range of `cached_integer()` are shared instances; other results
+     * are still stored in a new `integer_class`. */
     //! Fast Integer Addition
-    inline RCP<const Integer> addint(const Integer &other) const
-    {
-        return make_rcp<const Integer>(this->i + other.i);
-    }
+    inline RCP<const Integer> addint(const Integer &other) const;
     //! Fast Integer Subtraction
-    inline RCP<const Integer> subint(const Integer &other) const
-    {
-        return make_rcp<const Integer>(this->i - other.i);
-    }
+    inline RCP<const Integer> subint(const Integer &other) const;
     //! Fast Integer Multiplication
-    inline RCP<const Integer> mulint(const Integer &other) const
-    {
-        return make_rcp<const Integer>(this->i * other.i);
-    }
+    inline RCP<const Integer> mulint(const Integer &other) const;
     //!  Integer Division
     RCP<const Number> divint(const Integer &other) const;
     //! Fast Negative Power Evaluation
@@ -113,10 +170,7 @@ public:
         return make_rcp<const Integer>(std::move(tmp));
     }
     //! \return negative of self.
-    inline RCP<const Integer> neg() const
-    {
-        return make_rcp<const Integer>(-i);
-    }
+    inline RCP<const Integer> neg() const;
 
     /* These are general methods, overriden from the Number class, that need to
      * check types to decide what operation to do, and so are a bit slower. */
@@ -190,21 +244,110 @@ struct RCPIntegerKeyLess {
         return a->as_integer_class() < b->as_integer_class();
     }
 };
+
+//! Range of values for which `integer()` returns a preallocated instance
+const long integer_cache_min = -256;
+const long integer_cache_max = 1024;
+
+//! \return the preallocated Integer for `integer_cache_min <= i <=
+//! integer_cache_max`
+const RCP<const Integer> &cached_integer(long i);
+
+template <typename T>
+inline bool in_integer_cache(T i)
+{
+    return std::is_signed<T>::value
+               ? (static_cast<long long>(i) >= integer_cache_min
+                  and static_cast<long long>(i) <= integer_cache_max)
+               : static_cast<unsigned long long>(i)
+                     <= static_cast<unsigned long long>(integer_cache_max);
+}
+
 //! \return RCP<const Integer> from integral values
 template <typename T>
 inline typename std::enable_if<std::is_integral<T>::value,
                                RCP<const Integer>>::type
 integer(T i)
 {
+    if (in_integer_cache(i))
+        return cached_integer(static_cast<long>(i));
     return make_rcp<const Integer>(integer_class(i));
 }
 
 //! \return RCP<const Integer> from integer_class
 inline RCP<const Integer> integer(integer_class i)
 {
+    if (mp_fits_slong_p(i)) {
+        long v = mp_get_si(i);
+        if (in_integer_cache(v))
+            return cached_integer(v);
+    }
     return make_rcp<const Integer>(std::move(i));
 }
 
+inline bool Integer::get_small(long &v) const
+{
+#if SYMENGINE_INTEGER_CLASS == SYMENGINE_GMP                                   \
+    || SYMENGINE_INTEGER_CLASS == SYMENGINE_GMPXX
+    mpz_srcptr z = i.get_mpz_t();
+    if (z->_mp_size == 0) {
+        v = 0;
+        return true;
+    }
+    if (z->_mp_size != 1 and z->_mp_size != -1)
+        return false;
+    const mp_limb_t d = z->_mp_d[0];
+    const mp_limb_t max
+        = static_cast<mp_limb_t>(std::numeric_limits<long>::max());
+    if (d <= max) {
+        v = z->_mp_size > 0 ? static_cast<long>(d) : -static_cast<long>(d);
+        return true;
+    }
+    if (z->_mp_size < 0 and d == max + 1) {
+        v = std::numeric_limits<long>::min();
+        return true;
+    }
+    return false;
+#else
+    if (not mp_fits_slong_p(i))
+        return false;
+    v = mp_get_si(i);
+    return true;
+#endif
+}
+
+inline RCP<const Integer> Integer::addint(const Integer &other) const
+{
+    long a, b, r;
+    if (get_small(a) and other.get_small(b) and checked_add(a, b, r))
+        return integer(r);
+    return make_rcp<const Integer>(this->i + other.i);
+}
+
+inline RCP<const Integer> Integer::subint(const Integer &other) const
+{
+    long a, b, r;
+    if (get_small(a) and other.get_small(b) and checked_sub(a, b, r))
+        return integer(r);
+    return make_rcp<const Integer>(this->i - other.i);
+}
+
+inline RCP<const Integer> Integer::mulint(const Integer &other) const
+{
+    long a, b, r;
+    if (get_small(a) and other.get_small(b) and checked_mul(a, b, r))
+        return integer(r);
+    return make_rcp<const Integer>(this->i * other.i);
+}
+
+inline RCP<const Integer> Integer::neg() const
+{
+    long a, r;
+    if (get_small(a) and checked_sub(0, a, r))
+        return integer(r);
+    return make_rcp<const Integer>(-i);
+}
+
 //! Integer Square root
 RCP<const Integer> isqrt(const Integer &n);
 //! Integer nth root
@@ -0,0 +1,81 @@
+#include <symengine/intern.h>
+
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+#include <atomic>
+#include <mutex>
+#endif
+
+namespace SymEngine
+{
+
+namespace
+{
+
+struct UniqueTable {
+    uset_basic nodes;
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::mutex mutex;
+#endif
+};
+
+// The table is never destroyed, so that interned nodes (which may refer to
+// global constants like `one`) are not released during static destruction.
+UniqueTable &unique_table()
+{
+    static UniqueTable *table = new UniqueTable();
+    return *table;
+}
+
+} // namespace
+
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+std::atomic<bool> interning_flag{false};
+#else
+bool interning_flag = false;
+#endif
+
+bool set_interning(bool enable)
+{
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    return interning_flag.exchange(enable);
+#else
+    bool previous = interning_flag;
+    interning_flag = enable;
+    return previous;
+#endif
+}
+
+RCP<const Basic> intern_basic(const RCP<const Basic> &x)
+{
+    UniqueTable &table = unique_table();
+    // Compute the hash outside of the lock, it is cached on the node
+    x->hash();
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(table.mutex);
+#endif
+    return *table.nodes.insert(x).first;
+}
+
+size_t interned_count()
+{
+    UniqueTable &table = unique_table();
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(table.mutex);
+#endif
+    return table.nodes.size();
+}
+
+void clear_interned()
+{
+    UniqueTable &table = unique_table();
+    uset_basic nodes;
+    {
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+        std::lock_guard<std::mutex> lock(table.mutex);
+#endif
+        nodes.swap(table.nodes);
+    }
+    // `nodes` is released here, outside of the lock
+}
+
+} // namespace SymEngine
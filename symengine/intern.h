@@ -0,0 +1,93 @@
+/**
+ *  \file intern.h
+ *  Opt-in hash-consing (interning) of Basic nodes
+ *
+ **/
+#ifndef SYMENGINE_INTERN_H
+#define SYMENGINE_INTERN_H
+
+#include <symengine/basic.h>
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+#include <atomic>
+#endif
+
+namespace SymEngine
+{
+
+/*! Hash-consing of `Basic` nodes.
+
+    When interning is enabled, `symbol()`, `Add::from_dict()`,
+    `Mul::from_dict()` and `pow()` look up every newly constructed node in a
+    global unique table keyed on `Basic::hash()` and `eq()`. If an equal node
+    already exists, the existing node is returned and the new one is freed, so
+    structurally identical subexpressions share a single node and `eq()`
+    reduces to a pointer comparison for them.
+
+    Interning is off by default. The table keeps a reference to every node it
+    holds, so nodes stay alive until `clear_interned()` is called.
+*/
+
+//! Whether interning is enabled, use `interning_enabled()` to read it
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+extern SYMENGINE_EXPORT std::atomic<bool> interning_flag;
+#else
+extern SYMENGINE_EXPORT bool interning_flag;
+#endif
+
+//! \return true if newly constructed nodes are interned
+inline bool interning_enabled()
+{
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    return interning_flag.load(std::memory_order_relaxed);
+#else
+    return interning_flag;
+#endif
+}
+//! Enables or disables interning. \return the previous setting
+bool set_interning(bool enable);
+//! \return the canonical node equal to `x`, adding `x` to the table if absent
+RCP<const Basic> intern_basic(const RCP<const Basic> &x);
+//! \return the number of nodes in the unique table
+size_t interned_count();
+//! Removes all nodes from the unique table
+void clear_interned();
+
+template <class T>
+inline RCP<const T> intern(const RCP<const T> &x)
+{
+    RCP<const Basic> r = intern_basic(x);
+    SYMENGINE_ASSERT(is_same_type(*r, *x))
+    return rcp_static_cast<const T>(r);
+}
+
+//! Same as `make_rcp<const T>(args...)`, but returns the canonical node
+//! if interning is enabled
+template <class T, typename... Args>
+inline RCP<const T> make_interned(Args &&...args)
+{
+    RCP<const T> r = make_rcp<const T>(std::forward<Args>(args)...);
+    if (interning_enabled())
+        return intern(r);
+    return r;
+}
+
+//! Enables interning for the lifetime of the object and restores the previous
+//! setting on destruction
+class InterningScope
+{
+private:
+    bool previous_;
+
+public:
+    InterningScope() : previous_{set_interning(true)} {}
+    ~InterningScope()
+    {
+        set_interning(previous_);
+    }
+    InterningScope(const InterningScope &) = delete;
+    InterningScope &operator=(const InterningScope &) = delete;
+};
+
+} // namespace SymEngine
+
+#endif
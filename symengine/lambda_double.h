@@ -1,6 +1,7 @@
 #ifndef SYMENGINE_LAMBDA_DOUBLE_H
 #define SYMENGINE_LAMBDA_DOUBLE_H
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <symengine/eval_double.h>
@@ -32,6 +33,34 @@ protected:
     fn result_;
     vec_basic symbols;
 
+    /*
+       Batch evaluation (see call_batch()). On first use, the expressions are
+       compiled into a list of operations, each of which runs a loop over a
+       block of up to `batch_block_size` points. The values of a block are
+       stored contiguously in a register, which is a slice of
+       'batch_registers'. Nodes without a batch operation are evaluated point
+       by point with their 'fn'.
+    */
+    typedef std::function<void(T *regs, const T *inps, size_t stride,
+                               size_t n)>
+        batch_fn;
+    static const size_t batch_block_size = 128;
+    bool batch_compiled = false;
+    std::vector<batch_fn> batch_fns;
+    std::vector<size_t> batch_outputs;
+    std::vector<T> batch_registers;
+    size_t batch_num_registers = 0;
+    // Registers that can be reused, and registers that must not be
+    // (they hold inputs or common subexpressions)
+    std::vector<size_t> batch_free_registers;
+    std::vector<bool> batch_pinned;
+    std::vector<size_t> batch_input_registers;
+    std::vector<size_t> batch_cse_registers;
+    // Arguments of the last init(), kept to compile the batch operations
+    vec_basic batch_inputs;
+    vec_basic batch_exprs;
+    vec_pair batch_replacements;
+
 public:
     LambdaDoubleVisitor() = default;
     LambdaDoubleVisitor(LambdaDoubleVisitor &&) = default;
@@ -53,6 +82,11 @@ public:
         results.clear();
         cse_intermediate_fns.clear();
         symbols = inputs;
+        batch_compiled = false;
+        batch_fns.clear();
+        batch_inputs = inputs;
+        batch_exprs = outputs;
+        batch_replacements.clear();
         if (not cse) {
             for (auto &p : outputs) {
                 results.push_back(apply(*p));
@@ -77,6 +111,8 @@ public:
             for (unsigned i = 0; i < outputs.size(); i++) {
                 results.push_back(apply(*reduced_exprs[i]));
             }
+            batch_exprs = reduced_exprs;
+            batch_replacements = replacements;
             // We don't need the cse_intermediate_fns_map anymore
             cse_intermediate_fns_map.clear();
             symbols.clear();
@@ -109,6 +145,336 @@ public:
         return;
     }
 
+    /*! Evaluates the outputs at `npoints` points. The inputs of point `p`
+        start at `inps[p * stride]`, and its outputs are written to
+        `outs[p * n_outputs]`. The results are the same as calling `call()`
+        for each point, but every node of the expressions is visited once per
+        block of points, using loops over contiguous arrays that the
+        compiler can vectorize.
+    */
+    void call_batch(T *outs, const T *inps, size_t npoints, size_t stride)
+    {
+        if (not batch_compiled)
+            batch_init();
+        const size_t nouts = batch_outputs.size();
+        T *regs = batch_registers.data();
+        for (size_t start = 0; start < npoints; start += batch_block_size) {
+            size_t n = std::min(batch_block_size, npoints - start);
+            const T *x = inps + start * stride;
+            for (const auto &f : batch_fns) {
+                f(regs, x, stride, n);
+            }
+            for (size_t j = 0; j < nouts; j++) {
+                const T *y = regs + batch_outputs[j] * batch_block_size;
+                T *out = outs + start * nouts + j;
+                for (size_t k = 0; k < n; k++) {
+                    out[k * nouts] = y[k];
+                }
+            }
+        }
+    }
+
+protected:
+    void batch_init()
+    {
+        batch_fns.clear();
+        batch_outputs.clear();
+        batch_num_registers = 0;
+        batch_free_registers.clear();
+        batch_pinned.clear();
+        batch_input_registers.assign(batch_inputs.size(), size_t(-1));
+        batch_cse_registers.clear();
+        // Symbols are looked up like in init(), both here and by the 'fn'
+        // generated for nodes that don't have a batch operation
+        symbols = batch_inputs;
+        for (size_t i = 0; i < batch_replacements.size(); i++) {
+            cse_intermediate_fns_map[batch_replacements[i].first] = i;
+        }
+        for (auto &rep : batch_replacements) {
+            size_t r = batch_compile(*rep.second);
+            batch_pin(r);
+            batch_cse_registers.push_back(r);
+        }
+        for (auto &p : batch_exprs) {
+            batch_outputs.push_back(batch_compile(*p));
+        }
+        if (batch_replacements.size() > 0) {
+            cse_intermediate_fns_map.clear();
+            symbols.clear();
+        }
+        batch_compiled = true;
+        batch_registers.assign(batch_num_registers * batch_block_size, T(0));
+    }
+
+    size_t batch_new_register()
+    {
+        if (not batch_free_registers.empty()) {
+            size_t r = batch_free_registers.back();
+            batch_free_registers.pop_back();
+            return r;
+        }
+        batch_pinned.push_back(false);
+        return batch_num_registers++;
+    }
+
+    void batch_pin(size_t r)
+    {
+        batch_pinned[r] = true;
+    }
+
+    //! Allows the operations added after this to overwrite register `r`
+    void batch_release(size_t r)
+    {
+        if (not batch_pinned[r])
+            batch_free_registers.push_back(r);
+    }
+
+    size_t batch_constant(T c)
+    {
+        size_t r = batch_new_register();
+        batch_fns.push_back([=](T *regs, const T *, size_t, size_t n) {
+            T *y = regs + r * batch_block_size;
+            for (size_t k = 0; k < n; k++) {
+                y[k] = c;
+            }
+        });
+        return r;
+    }
+
+    //! Evaluates `b` point by point with the 'fn' generated by apply()
+    size_t batch_fallback(const Basic &b)
+    {
+        fn f = apply(b);
+        size_t r = batch_new_register();
+        // The common subexpressions evaluated so far, which 'f' reads from
+        // 'cse_intermediate_results'
+        std::vector<size_t> cse_regs = batch_cse_registers;
+        T *cse_results = cse_intermediate_results.data();
+        batch_fns.push_back([=](T *regs, const T *x, size_t stride, size_t n) {
+            T *y = regs + r * batch_block_size;
+            for (size_t k = 0; k < n; k++) {
+                for (size_t i = 0; i < cse_regs.size(); i++) {
+                    cse_results[i] = regs[cse_regs[i] * batch_block_size + k];
+                }
+                y[k] = f(x + k * stride);
+            }
+        });
+        return r;
+    }
+
+    template <typename F>
+    size_t batch_unary(const RCP<const Basic> &arg, F f)
+    {
+        size_t a = batch_compile(*arg);
+        batch_release(a);
+        size_t r = batch_new_register();
+        batch_fns.push_back([=](T *regs, const T *, size_t, size_t n) {
+            const T *u = regs + a * batch_block_size;
+            T *y = regs + r * batch_block_size;
+            for (size_t k = 0; k < n; k++) {
+                y[k] = f(u[k]);
+            }
+        });
+        return r;
+    }
+
+    //! Adds `y = y * base**exp` to the operations
+    void batch_mul_pow(size_t y_reg, const Basic &base, const Basic &exp)
+    {
+        size_t b = batch_compile(base);
+        if (is_a_Number(exp)) {
+            T e = apply(exp)(nullptr);
+            batch_fns.push_back([=](T *regs, const T *, size_t, size_t n) {
+                const T *u = regs + b * batch_block_size;
+                T *y = regs + y_reg * batch_block_size;
+                for (size_t k = 0; k < n; k++) {
+                    y[k] = y[k] * std::pow(u[k], e);
+                }
+            });
+        } else {
+            size_t e = batch_compile(exp);
+            batch_fns.push_back([=](T *regs, const T *, size_t, size_t n) {
+                const T *u = regs + b * batch_block_size;
+                const T *v = regs + e * batch_block_size;
+                T *y = regs + y_reg * batch_block_size;
+                for (size_t k = 0; k < n; k++) {
+                    y[k] = y[k] * std::pow(u[k], v[k]);
+                }
+            });
+            batch_release(e);
+        }
+        batch_release(b);
+    }
+
+    /*! Adds the operations computing `b` and returns the register that
+        holds the result. The operations perform the same floating point
+        operations in the same order as the 'fn' generated by apply(), so
+        that the results are identical. In particular, a power of `E` is
+        evaluated with exp() on its own, but with pow() when it is a factor
+        of a Mul, as apply() does.
+    */
+    size_t batch_compile(const Basic &b)
+    {
+        if (is_a_sub<Symbol>(b)) {
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                if (eq(b, *symbols[i])) {
+                    size_t &r = batch_input_registers[i];
+                    if (r == size_t(-1)) {
+                        r = batch_new_register();
+                        batch_pin(r);
+                        size_t y_reg = r;
+                        batch_fns.push_back(
+                            [=](T *regs, const T *x, size_t stride, size_t n) {
+                                T *y = regs + y_reg * batch_block_size;
+                                for (size_t k = 0; k < n; k++) {
+                                    y[k] = x[k * stride + i];
+                                }
+                            });
+                    }
+                    return r;
+                }
+            }
+            auto it = cse_intermediate_fns_map.find(b.rcp_from_this());
+            if (it != cse_intermediate_fns_map.end()) {
+                return batch_cse_registers[it->second];
+            }
+            throw SymEngineException("Symbol not in the symbols vector.");
+        }
+        if (is_a_Number(b) or is_a<Constant>(b)) {
+            return batch_constant(apply(b)(nullptr));
+        }
+        switch (b.get_type_code()) {
+            case SYMENGINE_ADD: {
+                const Add &x = down_cast<const Add &>(b);
+                size_t r = batch_constant(apply(*x.get_coef())(nullptr));
+                for (const auto &p : x.get_dict()) {
+                    size_t t = batch_compile(*p.first);
+                    T c = apply(*p.second)(nullptr);
+                    batch_fns.push_back(
+                        [=](T *regs, const T *, size_t, size_t n) {
+                            const T *u = regs + t * batch_block_size;
+                            T *y = regs + r * batch_block_size;
+                            for (size_t k = 0; k < n; k++) {
+                                y[k] = y[k] + u[k] * c;
+                            }
+                        });
+                    batch_release(t);
+                }
+                return r;
+            }
+            case SYMENGINE_MUL: {
+                const Mul &x = down_cast<const Mul &>(b);
+                size_t r = batch_constant(apply(*x.get_coef())(nullptr));
+                for (const auto &p : x.get_dict()) {
+                    batch_mul_pow(r, *p.first, *p.second);
+                }
+                return r;
+            }
+            case SYMENGINE_POW: {
+                const Pow &x = down_cast<const Pow &>(b);
+                if (eq(*x.get_base(), *E)) {
+                    return batch_unary(x.get_exp(),
+                                       [](T u) { return std::exp(u); });
+                }
+                size_t u = batch_compile(*x.get_base());
+                size_t v = batch_compile(*x.get_exp());
+                batch_release(u);
+                batch_release(v);
+                size_t r = batch_new_register();
+                batch_fns.push_back([=](T *regs, const T *, size_t, size_t n) {
+                    const T *a = regs + u * batch_block_size;
+                    const T *e = regs + v * batch_block_size;
+                    T *y = regs + r * batch_block_size;
+                    for (size_t k = 0; k < n; k++) {
+                        y[k] = std::pow(a[k], e[k]);
+                    }
+                });
+                return r;
+            }
+            case SYMENGINE_SIN:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::sin(u); });
+            case SYMENGINE_COS:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::cos(u); });
+            case SYMENGINE_TAN:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::tan(u); });
+            case SYMENGINE_LOG:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::log(u); });
+            case SYMENGINE_COT:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return 1.0 / std::tan(u); });
+            case SYMENGINE_CSC:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return 1.0 / std::sin(u); });
+            case SYMENGINE_SEC:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return 1.0 / std::cos(u); });
+            case SYMENGINE_ASIN:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::asin(u); });
+            case SYMENGINE_ACOS:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::acos(u); });
+            case SYMENGINE_ASEC:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::acos(1.0 / u); });
+            case SYMENGINE_ACSC:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::asin(1.0 / u); });
+            case SYMENGINE_ATAN:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::atan(u); });
+            case SYMENGINE_ACOT:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::atan(1.0 / u); });
+            case SYMENGINE_SINH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::sinh(u); });
+            case SYMENGINE_CSCH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return 1.0 / std::sinh(u); });
+            case SYMENGINE_COSH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::cosh(u); });
+            case SYMENGINE_SECH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return 1.0 / std::cosh(u); });
+            case SYMENGINE_TANH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::tanh(u); });
+            case SYMENGINE_COTH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return 1.0 / std::tanh(u); });
+            case SYMENGINE_ASINH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::asinh(u); });
+            case SYMENGINE_ACSCH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::asinh(1.0 / u); });
+            case SYMENGINE_ACOSH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::acosh(u); });
+            case SYMENGINE_ATANH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::atanh(u); });
+            case SYMENGINE_ACOTH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::atanh(1.0 / u); });
+            case SYMENGINE_ASECH:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return std::acosh(1.0 / u); });
+            case SYMENGINE_ABS:
+                return batch_unary(b.get_args()[0],
+                                   [](T u) { return T(std::abs(u)); });
+            default:
+                return batch_fallback(b);
+        }
+    }
+
+public:
     void bvisit(const Symbol &x)
     {
         for (unsigned i = 0; i < symbols.size(); ++i) {
@@ -363,6 +729,9 @@ public:
     };
 };
 
+template <typename T>
+const size_t LambdaDoubleVisitor<T>::batch_block_size;
+
 class LambdaRealDoubleVisitor
     : public BaseVisitor<LambdaRealDoubleVisitor, LambdaDoubleVisitor<double>>
 {
@@ -671,5 +1040,494 @@ public:
     }
 #endif
 };
+
+/*! Evaluates expressions to `T` like the `Reference` visitor, but compiles
+    them into a flat array of instructions instead of a tree of
+    `std::function` objects.
+
+    Every instruction reads its operands from, and writes its result to, a
+    scratch buffer of registers. The first registers hold the inputs,
+    followed by the common subexpressions (if `cse` is used), constants and
+    temporaries. Subexpressions whose operands are all constant are
+    evaluated by init(), and temporary registers are reused, so evaluating
+    is a single loop over the instructions on a small buffer.
+
+    Nodes without an instruction are compiled by a `Reference` visitor of
+    their own, which reads the input and common subexpression registers.
+*/
+template <typename T, typename Reference>
+class LambdaDoubleBytecode
+{
+public:
+    enum class OpCode : unsigned char {
+        Copy,
+        Add,
+        Mul,
+        Div,
+        MulAdd,
+        Pow,
+        Exp,
+        Log,
+        Sin,
+        Cos,
+        Tan,
+        Cot,
+        Csc,
+        Sec,
+        ASin,
+        ACos,
+        ASec,
+        ACsc,
+        ATan,
+        ACot,
+        Sinh,
+        Csch,
+        Cosh,
+        Sech,
+        Tanh,
+        Coth,
+        ASinh,
+        ACsch,
+        ACosh,
+        ATanh,
+        ACoth,
+        ASech,
+        Abs,
+        Call
+    };
+
+    //! `dst = op(a, b, c)`, where the operands are register numbers. For
+    //! `Call`, `a` is the index of the `Reference` visitor.
+    struct Instruction {
+        OpCode op;
+        unsigned dst, a, b, c;
+    };
+
+    void init(const vec_basic &x, const Basic &b, bool cse = false)
+    {
+        vec_basic outputs = {b.rcp_from_this()};
+        init(x, outputs, cse);
+    }
+
+    void init(const vec_basic &inputs, const vec_basic &outputs,
+              bool cse = false)
+    {
+        code_.clear();
+        outputs_.clear();
+        fallbacks_.clear();
+        regs_.clear();
+        kinds_.clear();
+        free_.clear();
+        symbols_.clear();
+        fallback_symbols_ = inputs;
+
+        vec_basic exprs;
+        vec_pair replacements;
+        if (cse) {
+            SymEngine::cse(replacements, exprs, outputs);
+        } else {
+            exprs = outputs;
+        }
+        for (auto &rep : replacements) {
+            fallback_symbols_.push_back(rep.first);
+        }
+        for (unsigned i = 0; i < fallback_symbols_.size(); i++) {
+            symbols_[fallback_symbols_[i]] = new_register(Input);
+        }
+        ninputs_ = numeric_cast<unsigned>(inputs.size());
+
+        for (unsigned i = 0; i < replacements.size(); i++) {
+            unsigned dst = ninputs_ + i;
+            unsigned r = compile(*replacements[i].second);
+            if (kinds_[r] == Constant) {
+                regs_[dst] = regs_[r];
+                kinds_[dst] = Constant;
+            } else if (kinds_[r] == Temporary and not code_.empty()
+                       and code_.back().dst == r) {
+                code_.back().dst = dst;
+                release(r);
+            } else {
+                code_.push_back({OpCode::Copy, dst, r, 0, 0});
+                release(r);
+            }
+        }
+        for (auto &p : exprs) {
+            outputs_.push_back(compile(*p));
+        }
+        // Free registers are no longer needed
+        free_.clear();
+    }
+
+    T call(const std::vector<T> &vec)
+    {
+        T res;
+        call(&res, vec.data());
+        return res;
+    }
+
+    void call(T *outs, const T *inps)
+    {
+        T *r = regs_.data();
+        std::copy(inps, inps + ninputs_, r);
+        for (const Instruction &i : code_) {
+            execute(i, r);
+        }
+        for (unsigned j = 0; j < outputs_.size(); j++) {
+            outs[j] = r[outputs_[j]];
+        }
+    }
+
+    const std::vector<Instruction> &get_code() const
+    {
+        return code_;
+    }
+
+    size_t num_registers() const
+    {
+        return regs_.size();
+    }
+
+private:
+    enum RegisterKind : unsigned char { Input, Constant, Temporary };
+    static const unsigned no_register = unsigned(-1);
+
+    std::vector<Instruction> code_;
+    std::vector<unsigned> outputs_;
+    std::vector<Reference> fallbacks_;
+    std::vector<T> regs_;
+    std::vector<RegisterKind> kinds_;
+    std::vector<unsigned> free_;
+    umap_basic_uint symbols_;
+    // Inputs followed by the symbols of the common subexpressions, in the
+    // order of their registers
+    vec_basic fallback_symbols_;
+    unsigned ninputs_ = 0;
+
+    void execute(const Instruction &i, T *r)
+    {
+        switch (i.op) {
+            case OpCode::Copy:
+                r[i.dst] = r[i.a];
+                break;
+            case OpCode::Add:
+                r[i.dst] = r[i.a] + r[i.b];
+                break;
+            case OpCode::Mul:
+                r[i.dst] = r[i.a] * r[i.b];
+                break;
+            case OpCode::Div:
+                r[i.dst] = r[i.a] / r[i.b];
+                break;
+            case OpCode::MulAdd:
+                r[i.dst] = r[i.a] + r[i.b] * r[i.c];
+                break;
+            case OpCode::Pow:
+                r[i.dst] = std::pow(r[i.a], r[i.b]);
+                break;
+            case OpCode::Exp:
+                r[i.dst] = std::exp(r[i.a]);
+                break;
+            case OpCode::Log:
+                r[i.dst] = std::log(r[i.a]);
+                break;
+            case OpCode::Sin:
+                r[i.dst] = std::sin(r[i.a]);
+                break;
+            case OpCode::Cos:
+                r[i.dst] = std::cos(r[i.a]);
+                break;
+            case OpCode::Tan:
+                r[i.dst] = std::tan(r[i.a]);
+                break;
+            case OpCode::Cot:
+                r[i.dst] = 1.0 / std::tan(r[i.a]);
+                break;
+            case OpCode::Csc:
+                r[i.dst] = 1.0 / std::sin(r[i.a]);
+                break;
+            case OpCode::Sec:
+                r[i.dst] = 1.0 / std::cos(r[i.a]);
+                break;
+            case OpCode::ASin:
+                r[i.dst] = std::asin(r[i.a]);
+                break;
+            case OpCode::ACos:
+                r[i.dst] = std::acos(r[i.a]);
+                break;
+            case OpCode::ASec:
+                r[i.dst] = std::acos(1.0 / r[i.a]);
+                break;
+            case OpCode::ACsc:
+                r[i.dst] = std::asin(1.0 / r[i.a]);
+                break;
+            case OpCode::ATan:
+                r[i.dst] = std::atan(r[i.a]);
+                break;
+            case OpCode::ACot:
+                r[i.dst] = std::atan(1.0 / r[i.a]);
+                break;
+            case OpCode::Sinh:
+                r[i.dst] = std::sinh(r[i.a]);
+                break;
+            case OpCode::Csch:
+                r[i.dst] = 1.0 / std::sinh(r[i.a]);
+                break;
+            case OpCode::Cosh:
+                r[i.dst] = std::cosh(r[i.a]);
+                break;
+            case OpCode::Sech:
+                r[i.dst] = 1.0 / std::cosh(r[i.a]);
+                break;
+            case OpCode::Tanh:
+                r[i.dst] = std::tanh(r[i.a]);
+                break;
+            case OpCode::Coth:
+                r[i.dst] = 1.0 / std::tanh(r[i.a]);
+                break;
+            case OpCode::ASinh:
+                r[i.dst] = std::asinh(r[i.a]);
+                break;
+            case OpCode::ACsch:
+                r[i.dst] = std::asinh(1.0 / r[i.a]);
+                break;
+            case OpCode::ACosh:
+                r[i.dst] = std::acosh(r[i.a]);
+                break;
+            case OpCode::ATanh:
+                r[i.dst] = std::atanh(r[i.a]);
+                break;
+            case OpCode::ACoth:
+                r[i.dst] = std::atanh(1.0 / r[i.a]);
+                break;
+            case OpCode::ASech:
+                r[i.dst] = std::acosh(1.0 / r[i.a]);
+                break;
+            case OpCode::Abs:
+                r[i.dst] = std::abs(r[i.a]);
+                break;
+            case OpCode::Call:
+                fallbacks_[i.a].call(&r[i.dst], r);
+                break;
+        }
+    }
+
+    static unsigned num_operands(OpCode op)
+    {
+        switch (op) {
+            case OpCode::Call:
+                return 0;
+            case OpCode::Add:
+            case OpCode::Mul:
+            case OpCode::Div:
+            case OpCode::Pow:
+                return 2;
+            case OpCode::MulAdd:
+                return 3;
+            default:
+                return 1;
+        }
+    }
+
+    unsigned new_register(RegisterKind kind)
+    {
+        if (kind == Temporary and not free_.empty()) {
+            unsigned r = free_.back();
+            free_.pop_back();
+            return r;
+        }
+        regs_.push_back(T(0));
+        kinds_.push_back(kind);
+        return numeric_cast<unsigned>(regs_.size() - 1);
+    }
+
+    void release(unsigned r)
+    {
+        if (kinds_[r] == Temporary)
+            free_.push_back(r);
+    }
+
+    unsigned constant(const T &value)
+    {
+        unsigned r = new_register(Constant);
+        regs_[r] = value;
+        return r;
+    }
+
+    //! Value of the number or constant `b`
+    static T value_of(const Basic &b)
+    {
+        Reference v;
+        v.init({}, b);
+        T res;
+        v.call(&res, nullptr);
+        return res;
+    }
+
+    //! Adds `dst = op(a, b, c)` and returns `dst`, or evaluates it right
+    //! away if all the operands are constant.
+    unsigned emit(OpCode op, unsigned a, unsigned b = 0, unsigned c = 0)
+    {
+        const unsigned n = num_operands(op);
+        const unsigned operands[] = {a, b, c};
+        bool all_constant = true;
+        for (unsigned k = 0; k < n; k++) {
+            all_constant = all_constant and kinds_[operands[k]] == Constant;
+        }
+        if (n > 0 and all_constant) {
+            unsigned dst = new_register(Constant);
+            execute({op, dst, a, b, c}, regs_.data());
+            return dst;
+        }
+        // The operands are read before the result is written, so the result
+        // can reuse the register of one of them. An operand that is passed
+        // more than once, as in `b * b`, is released only once.
+        for (unsigned k = 0; k < n; k++) {
+            if (std::find(operands, operands + k, operands[k]) == operands + k)
+                release(operands[k]);
+        }
+        unsigned dst = new_register(Temporary);
+        code_.push_back({op, dst, a, b, c});
+        return dst;
+    }
+
+    unsigned unary(OpCode op, const Basic &b)
+    {
+        return emit(op, compile(*b.get_args()[0]));
+    }
+
+    //! Compiles `base**exp`
+    unsigned power(const Basic &base, const Basic &exp)
+    {
+        unsigned b = compile(base);
+        if (is_a<Integer>(exp)) {
+            const Integer &e = down_cast<const Integer &>(exp);
+            if (e.is_one()) {
+                return b;
+            } else if (e.is_minus_one()) {
+                return emit(OpCode::Div, constant(T(1)), b);
+            } else if (eq(e, *integer(2))) {
+                return emit(OpCode::Mul, b, b);
+            }
+        }
+        return emit(OpCode::Pow, b, compile(exp));
+    }
+
+    unsigned compile(const Basic &b)
+    {
+        if (is_a_sub<Symbol>(b)) {
+            auto it = symbols_.find(b.rcp_from_this());
+            if (it == symbols_.end())
+                throw SymEngineException("Symbol not in the symbols vector.");
+            return it->second;
+        }
+        if (is_a_Number(b) or is_a<SymEngine::Constant>(b)) {
+            return constant(value_of(b));
+        }
+        switch (b.get_type_code()) {
+            case SYMENGINE_ADD: {
+                const Add &x = down_cast<const Add &>(b);
+                unsigned r = no_register;
+                if (not x.get_coef()->is_zero())
+                    r = constant(value_of(*x.get_coef()));
+                for (const auto &p : x.get_dict()) {
+                    unsigned t = compile(*p.first);
+                    if (not p.second->is_one()) {
+                        unsigned c = constant(value_of(*p.second));
+                        if (r == no_register) {
+                            t = emit(OpCode::Mul, t, c);
+                        } else {
+                            r = emit(OpCode::MulAdd, r, t, c);
+                            continue;
+                        }
+                    }
+                    r = (r == no_register) ? t : emit(OpCode::Add, r, t);
+                }
+                return r;
+            }
+            case SYMENGINE_MUL: {
+                const Mul &x = down_cast<const Mul &>(b);
+                unsigned r = no_register;
+                if (not x.get_coef()->is_one())
+                    r = constant(value_of(*x.get_coef()));
+                for (const auto &p : x.get_dict()) {
+                    unsigned t = power(*p.first, *p.second);
+                    r = (r == no_register) ? t : emit(OpCode::Mul, r, t);
+                }
+                return r;
+            }
+            case SYMENGINE_POW: {
+                const Pow &x = down_cast<const Pow &>(b);
+                if (eq(*x.get_base(), *E))
+                    return emit(OpCode::Exp, compile(*x.get_exp()));
+                return power(*x.get_base(), *x.get_exp());
+            }
+            case SYMENGINE_LOG:
+                return unary(OpCode::Log, b);
+            case SYMENGINE_SIN:
+                return unary(OpCode::Sin, b);
+            case SYMENGINE_COS:
+                return unary(OpCode::Cos, b);
+            case SYMENGINE_TAN:
+                return unary(OpCode::Tan, b);
+            case SYMENGINE_COT:
+                return unary(OpCode::Cot, b);
+            case SYMENGINE_CSC:
+                return unary(OpCode::Csc, b);
+            case SYMENGINE_SEC:
+                return unary(OpCode::Sec, b);
+            case SYMENGINE_ASIN:
+                return unary(OpCode::ASin, b);
+            case SYMENGINE_ACOS:
+                return unary(OpCode::ACos, b);
+            case SYMENGINE_ASEC:
+                return unary(OpCode::ASec, b);
+            case SYMENGINE_ACSC:
+                return unary(OpCode::ACsc, b);
+            case SYMENGINE_ATAN:
+                return unary(OpCode::ATan, b);
+            case SYMENGINE_ACOT:
+                return unary(OpCode::ACot, b);
+            case SYMENGINE_SINH:
+                return unary(OpCode::Sinh, b);
+            case SYMENGINE_CSCH:
+                return unary(OpCode::Csch, b);
+            case SYMENGINE_COSH:
+                return unary(OpCode::Cosh, b);
+            case SYMENGINE_SECH:
+                return unary(OpCode::Sech, b);
+            case SYMENGINE_TANH:
+                return unary(OpCode::Tanh, b);
+            case SYMENGINE_COTH:
+                return unary(OpCode::Coth, b);
+            case SYMENGINE_ASINH:
+                return unary(OpCode::ASinh, b);
+            case SYMENGINE_ACSCH:
+                return unary(OpCode::ACsch, b);
+            case SYMENGINE_ACOSH:
+                return unary(OpCode::ACosh, b);
+            case SYMENGINE_ATANH:
+                return unary(OpCode::ATanh, b);
+            case SYMENGINE_ACOTH:
+                return unary(OpCode::ACoth, b);
+            case SYMENGINE_ASECH:
+                return unary(OpCode::ASech, b);
+            case SYMENGINE_ABS:
+                return unary(OpCode::Abs, b);
+            default: {
+                Reference v;
+                v.init(fallback_symbols_, b);
+                fallbacks_.push_back(std::move(v));
+                return emit(OpCode::Call,
+                            numeric_cast<unsigned>(fallbacks_.size() - 1));
+            }
+        }
+    }
+};
+
+typedef LambdaDoubleBytecode<double, LambdaRealDoubleVisitor>
+    LambdaRealDoubleBytecode;
+typedef LambdaDoubleBytecode<std::complex<double>, LambdaComplexDoubleVisitor>
+    LambdaComplexDoubleBytecode;
+
 } // namespace SymEngine
 #endif // SYMENGINE_LAMBDA_DOUBLE_H
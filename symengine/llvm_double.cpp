@@ -27,12 +27,27 @@
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/Config/llvm-config.h"
+#if (LLVM_VERSION_MAJOR >= 17)
+#include "llvm/TargetParser/Host.h"
+#else
+#include "llvm/Support/Host.h"
+#endif
 #include <algorithm>
 #include <cassert>
 #include <memory>
 #include <vector>
 #include <fstream>
+#include <cstdio>
+#include <cstring>
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+#include <atomic>
+#include <mutex>
+#endif
 
 #include <symengine/llvm_double.h>
 #include <symengine/eval_double.h>
@@ -122,6 +137,266 @@ llvm::Function *LLVMVisitor::get_function_type(llvm::LLVMContext *context)
     return F;
 }
 
+namespace
+{
+
+struct CompileCache {
+    std::string dir;
+    size_t max_size = 0;
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::mutex mutex;
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+#else
+    size_t hits = 0;
+    size_t misses = 0;
+#endif
+};
+
+CompileCache &compile_cache()
+{
+    static CompileCache cache;
+    return cache;
+}
+
+const char compile_cache_magic[] = "SymEngine LLVM compile cache 1\n";
+const char compile_cache_extension[] = ".sjit";
+//! Version of the code generator and of the layout of the cache keys, which
+//! start with it. Bump it whenever either changes.
+const unsigned compile_cache_codegen_version = 2;
+
+//! Returns the cache directory (empty if disabled) and its size limit
+std::string get_compile_cache(size_t &max_size)
+{
+    CompileCache &cache = compile_cache();
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::lock_guard<std::mutex> lock(cache.mutex);
+#endif
+    max_size = cache.max_size;
+    return cache.dir;
+}
+
+//! Removes the least recently used entries until at most `max_size` bytes
+//! are left in `dir`. Other files in `dir` are left alone.
+void trim_compile_cache(const std::string &dir, size_t max_size)
+{
+    struct Entry {
+        llvm::sys::TimePoint<> time;
+        uint64_t size;
+        std::string path;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(dir, ec), end;
+         it != end and not ec; it.increment(ec)) {
+        if (llvm::sys::path::extension(it->path()) != compile_cache_extension)
+            continue;
+        llvm::sys::fs::file_status st;
+        if (llvm::sys::fs::status(it->path(), st))
+            continue;
+        entries.push_back({st.getLastModificationTime(), st.getSize(),
+                           it->path()});
+        total += st.getSize();
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b) { return a.time < b.time; });
+    for (const Entry &e : entries) {
+        if (total <= max_size)
+            break;
+        if (not llvm::sys::fs::remove(e.path))
+            total -= e.size;
+    }
+}
+
+//! Reads the object code stored for `key` in `path`. Entries are also
+//! checked against the full key, so a collision of the hashes used for the
+//! file names is just a miss.
+bool read_compile_cache(const std::string &path, const std::string &key,
+                        std::string &obj)
+{
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (not buffer)
+        return false;
+    llvm::StringRef data = (*buffer)->getBuffer();
+    if (not data.consume_front(compile_cache_magic))
+        return false;
+    size_t eol = data.find('\n');
+    unsigned long long key_size;
+    if (eol == llvm::StringRef::npos
+        or data.substr(0, eol).getAsInteger(10, key_size))
+        return false;
+    data = data.drop_front(eol + 1);
+    if (data.size() < key_size or data.substr(0, key_size) != key)
+        return false;
+    obj = data.drop_front(key_size).str();
+
+    // Mark the entry as recently used
+    int fd;
+    if (not llvm::sys::fs::openFileForWrite(path, fd,
+                                            llvm::sys::fs::CD_OpenExisting,
+                                            llvm::sys::fs::OF_Append)) {
+        llvm::sys::fs::setLastAccessAndModificationTime(
+            fd, std::chrono::time_point_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now()));
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    }
+    return true;
+}
+
+//! Stores `obj` for `key` in `path`. The entry is written to a temporary
+//! file first and then renamed, so that other processes never read a
+//! partially written entry. Errors are ignored, the cache is only an
+//! optimization.
+void write_compile_cache(const std::string &dir, const std::string &path,
+                         const std::string &key, const std::string &obj,
+                         size_t max_size)
+{
+    int fd;
+    llvm::SmallString<128> tmp;
+    if (llvm::sys::fs::createUniqueFile(dir + "/tmp-%%%%%%%%", fd, tmp))
+        return;
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+        os << compile_cache_magic << key.size() << "\n" << key << obj;
+        os.close();
+        if (os.has_error()) {
+            os.clear_error();
+            llvm::sys::fs::remove(tmp);
+            return;
+        }
+    }
+    if (llvm::sys::fs::rename(tmp, path)) {
+        llvm::sys::fs::remove(tmp);
+        return;
+    }
+    trim_compile_cache(dir, max_size);
+}
+
+void append_key_data(std::string &key, const std::string &s)
+{
+    key += std::to_string(s.size());
+    key += ':';
+    key += s;
+}
+
+/*! Appends an encoding of `b` to `key` that is equal for two expressions if
+    and only if they are structurally equal. Subexpressions equal to one
+    that was already encoded are referred to by its index in `seen`.
+*/
+void append_cache_key(std::string &key, const RCP<const Basic> &e,
+                      umap_basic_uint &seen)
+{
+    auto it = seen.find(e);
+    if (it != seen.end()) {
+        key += '@';
+        key += std::to_string(it->second);
+        return;
+    }
+    const Basic &b = *e;
+    key += std::to_string(b.get_type_code());
+    key += '(';
+    vec_basic args = b.get_args();
+    if (is_a_sub<Symbol>(b)) {
+        append_key_data(key, down_cast<const Symbol &>(b).get_name());
+        if (is_a<Dummy>(b))
+            append_key_data(
+                key, std::to_string(down_cast<const Dummy &>(b).get_index()));
+    } else if (is_a<Integer>(b) or is_a<Rational>(b)) {
+        append_key_data(key, b.__str__());
+    } else if (is_a<RealDouble>(b)) {
+        double d = down_cast<const RealDouble &>(b).i;
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        append_key_data(key, std::to_string(bits));
+    } else if (is_a<Constant>(b)) {
+        append_key_data(key, down_cast<const Constant &>(b).get_name());
+    } else if (is_a<BooleanAtom>(b)) {
+        key += down_cast<const BooleanAtom &>(b).get_val() ? '1' : '0';
+    } else if (is_a_sub<FunctionSymbol>(b)) {
+        append_key_data(key, down_cast<const FunctionSymbol &>(b).get_name());
+    } else if (is_a<Interval>(b)) {
+        const Interval &i = down_cast<const Interval &>(b);
+        key += i.get_left_open() ? '1' : '0';
+        key += i.get_right_open() ? '1' : '0';
+    } else if (is_a<Add>(b) or is_a<Mul>(b)) {
+        // The order of the terms depends on how the dictionary was built
+        std::sort(args.begin(), args.end(), RCPBasicKeyLess());
+    } else if (is_a_Number(b) and not is_a<Infty>(b) and not is_a<NaN>(b)) {
+        // e.g. RealMPFR, whose string form may be rounded
+        throw NotImplementedError("Not cacheable: " + b.__str__());
+    } else if (args.empty()) {
+        // e.g. Infty, NaN or the sets, which are printed exactly
+        append_key_data(key, b.__str__());
+    }
+    for (const auto &arg : args) {
+        append_cache_key(key, arg, seen);
+    }
+    key += ')';
+    seen.insert({e, static_cast<unsigned>(seen.size())});
+}
+
+} // namespace
+
+void LLVMVisitor::set_compile_cache(const std::string &dir, size_t max_size)
+{
+    CompileCache &cache = compile_cache();
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+    std::lock_guard<std::mutex> lock(cache.mutex);
+#endif
+    if (not dir.empty()) {
+        if (llvm::sys::fs::create_directories(dir)) {
+            throw SymEngineException("Could not create the directory " + dir);
+        }
+        trim_compile_cache(dir, max_size);
+    }
+    cache.dir = dir;
+    cache.max_size = max_size;
+}
+
+size_t LLVMVisitor::compile_cache_hits()
+{
+    return compile_cache().hits;
+}
+
+size_t LLVMVisitor::compile_cache_misses()
+{
+    return compile_cache().misses;
+}
+
+std::string LLVMVisitor::compile_cache_key(const vec_basic &inputs,
+                                           const vec_basic &outputs,
+                                           bool symbolic_cse,
+                                           unsigned opt_level)
+{
+    // The object code depends on the code generator, the LLVM version and
+    // the host CPU, too. The type codes below change between SymEngine
+    // versions, so the version is part of the key.
+    std::string key;
+    llvm::raw_string_ostream os(key);
+    os << SYMENGINE_VERSION << "\n"
+       << compile_cache_codegen_version << "\n"
+       << LLVM_VERSION_STRING << "\n"
+       << llvm::sys::getProcessTriple() << "\n"
+       << llvm::sys::getHostCPUName() << "\n";
+    get_float_type(context.get())->print(os);
+    os << "\n" << opt_level << "\n" << symbolic_cse << "\n";
+    os.flush();
+    umap_basic_uint seen;
+    try {
+        for (const vec_basic *v : {&inputs, &outputs}) {
+            key += std::to_string(v->size());
+            for (const auto &e : *v) {
+                append_cache_key(key, e, seen);
+            }
+            key += '\n';
+        }
+    } catch (NotImplementedError &) {
+        return "";
+    }
+    return key;
+}
+
 void LLVMVisitor::init(const vec_basic &inputs, const vec_basic &outputs,
                        const bool symbolic_cse, unsigned opt_level)
 {
@@ -130,6 +405,27 @@ void LLVMVisitor::init(const vec_basic &inputs, const vec_basic &outputs,
     llvm::InitializeNativeTargetAsmPrinter();
     llvm::InitializeNativeTargetAsmParser();
     context = make_unique<llvm::LLVMContext>();
+
+    size_t cache_max_size;
+    std::string cache_dir = get_compile_cache(cache_max_size);
+    std::string cache_key, cache_path;
+    if (not cache_dir.empty()) {
+        cache_key
+            = compile_cache_key(inputs, outputs, symbolic_cse, opt_level);
+    }
+    if (not cache_key.empty()) {
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx",
+                 (unsigned long long)llvm::xxHash64(cache_key));
+        cache_path = cache_dir + "/" + name + compile_cache_extension;
+        std::string obj;
+        if (read_compile_cache(cache_path, cache_key, obj)) {
+            compile_cache().hits++;
+            loads(obj);
+            return;
+        }
+        compile_cache().misses++;
+    }
     symbols = inputs;
 
     // Create some module to put our function into it.
@@ -295,8 +591,43 @@ void LLVMVisitor::init(const vec_basic &inputs, const vec_basic &outputs,
     symbol_ptrs.clear();
     replacement_symbol_ptrs.clear();
     symbols.clear();
+
+    if (not cache_path.empty()) {
+        write_compile_cache(cache_dir, cache_path, cache_key, membuffer,
+                            cache_max_size);
+    }
 }
 
+namespace
+{
+
+/*! The compiled function only uses the stack, so the threads can share it.
+    Every point costs about the same, so a static schedule is used.
+*/
+template <typename T>
+void call_batch_points(intptr_t func, T *outs, const T *inps, size_t npoints,
+                       size_t in_stride, size_t out_stride, unsigned nthreads)
+{
+    auto f = (void (*)(const T *, T *))func;
+    if (nthreads == 1 or npoints < 2) {
+        for (size_t i = 0; i < npoints; i++) {
+            f(inps + i * in_stride, outs + i * out_stride);
+        }
+    } else if (nthreads == 0) {
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < npoints; i++) {
+            f(inps + i * in_stride, outs + i * out_stride);
+        }
+    } else {
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+        for (size_t i = 0; i < npoints; i++) {
+            f(inps + i * in_stride, outs + i * out_stride);
+        }
+    }
+}
+
+} // namespace
+
 LLVMDoubleVisitor::LLVMDoubleVisitor() = default;
 LLVMDoubleVisitor::~LLVMDoubleVisitor() = default;
 
@@ -312,6 +643,14 @@ void LLVMDoubleVisitor::call(double *outs, const double *inps) const
     ((double (*)(const double *, double *))func)(inps, outs);
 }
 
+void LLVMDoubleVisitor::call_batch(double *outs, const double *inps,
+                                   size_t npoints, size_t in_stride,
+                                   size_t out_stride, unsigned nthreads) const
+{
+    call_batch_points(func, outs, inps, npoints, in_stride, out_stride,
+                      nthreads);
+}
+
 #ifdef SYMENGINE_HAVE_LLVM_LONG_DOUBLE
 long double
 LLVMLongDoubleVisitor::call(const std::vector<long double> &vec) const
@@ -327,6 +666,15 @@ void LLVMLongDoubleVisitor::call(long double *outs,
 {
     ((long double (*)(const long double *, long double *))func)(inps, outs);
 }
+
+void LLVMLongDoubleVisitor::call_batch(long double *outs,
+                                       const long double *inps, size_t npoints,
+                                       size_t in_stride, size_t out_stride,
+                                       unsigned nthreads) const
+{
+    call_batch_points(func, outs, inps, npoints, in_stride, out_stride,
+                      nthreads);
+}
 #endif
 
 LLVMFloatVisitor::LLVMFloatVisitor() = default;
@@ -344,6 +692,14 @@ void LLVMFloatVisitor::call(float *outs, const float *inps) const
     ((float (*)(const float *, float *))func)(inps, outs);
 }
 
+void LLVMFloatVisitor::call_batch(float *outs, const float *inps,
+                                  size_t npoints, size_t in_stride,
+                                  size_t out_stride, unsigned nthreads) const
+{
+    call_batch_points(func, outs, inps, npoints, in_stride, out_stride,
+                      nthreads);
+}
+
 void LLVMVisitor::set_double(double d)
 {
     result_ = llvm::ConstantFP::get(get_float_type(&mod->getContext()), d);
@@ -24,6 +24,20 @@ namespace SymEngine
 
 class IRBuilder;
 
+/*! Compiles expressions to machine code with LLVM. The subclasses fix the
+    floating point type `T` and provide
+
+        void call(T *outs, const T *inps) const;
+        void call_batch(T *outs, const T *inps, size_t npoints,
+                        size_t in_stride, size_t out_stride,
+                        unsigned nthreads = 0) const;
+
+    `call_batch` evaluates the function at `npoints` points. The inputs of
+    point `i` are read from `inps + i * in_stride` and its outputs are written
+    to `outs + i * out_stride`. The points are split between `nthreads` OpenMP
+    threads (`0` uses the OpenMP default); without OpenMP they are evaluated
+    serially.
+*/
 class LLVMVisitor : public BaseVisitor<LLVMVisitor>
 {
 protected:
@@ -43,6 +57,11 @@ protected:
     std::string membuffer;
     llvm::Function *get_function_type(llvm::LLVMContext *);
     virtual llvm::Type *get_float_type(llvm::LLVMContext *) = 0;
+    // Key of the compile cache entry for these arguments of `init`, or an
+    // empty string if the expressions cannot be cached.
+    std::string compile_cache_key(const vec_basic &inputs,
+                                  const vec_basic &outputs, bool symbolic_cse,
+                                  unsigned opt_level);
 
 public:
     LLVMVisitor();
@@ -99,6 +118,18 @@ public:
     const std::string &dumps() const;
     // Load a previously compiled function from a string
     void loads(const std::string &s);
+    //! Caches the functions compiled by `init` in the directory `dir`, so
+    //! that calling `init` again with the same inputs, outputs and options
+    //! loads the object code instead of compiling it, also in other
+    //! processes. The least recently used entries are removed when the
+    //! cache grows larger than `max_size` bytes. An empty `dir` disables
+    //! the cache, which is the default.
+    static void set_compile_cache(const std::string &dir,
+                                  size_t max_size = 256 * 1024 * 1024);
+    //! Number of `init` calls that were loaded from the compile cache
+    static size_t compile_cache_hits();
+    //! Number of `init` calls that were compiled and added to the cache
+    static size_t compile_cache_misses();
     void bvisit(const UnevaluatedExpr &x);
 };
 
@@ -109,6 +140,10 @@ public:
     ~LLVMDoubleVisitor() override;
     double call(const std::vector<double> &vec) const;
     void call(double *outs, const double *inps) const;
+    //! Evaluates the function at `npoints` points (see `LLVMVisitor`)
+    void call_batch(double *outs, const double *inps, size_t npoints,
+                    size_t in_stride, size_t out_stride,
+                    unsigned nthreads = 0) const;
     llvm::Type *get_float_type(llvm::LLVMContext *) override;
     void visit(const Tan &x) override;
     void visit(const ASin &x) override;
@@ -134,6 +169,10 @@ public:
     ~LLVMFloatVisitor() override;
     float call(const std::vector<float> &vec) const;
     void call(float *outs, const float *inps) const;
+    //! Evaluates the function at `npoints` points (see `LLVMVisitor`)
+    void call_batch(float *outs, const float *inps, size_t npoints,
+                    size_t in_stride, size_t out_stride,
+                    unsigned nthreads = 0) const;
     llvm::Type *get_float_type(llvm::LLVMContext *) override;
     void visit(const Tan &x) override;
     void visit(const ASin &x) override;
@@ -161,6 +200,10 @@ public:
     ~LLVMLongDoubleVisitor() override;
     long double call(const std::vector<long double> &vec) const;
     void call(long double *outs, const long double *inps) const;
+    //! Evaluates the function at `npoints` points (see `LLVMVisitor`)
+    void call_batch(long double *outs, const long double *inps, size_t npoints,
+                    size_t in_stride, size_t out_stride,
+                    unsigned nthreads = 0) const;
     llvm::Type *get_float_type(llvm::LLVMContext *) override;
     void visit(const Tan &x) override;
     void visit(const ASin &x) override;
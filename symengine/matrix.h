@@ -106,6 +106,8 @@ public:
 typedef std::vector<std::pair<int, int>> permutelist;
 
 class CSRMatrix;
+class SparseLUAnalysis;
+class SparseLU;
 
 // ----------------------------- Dense Matrix --------------------------------//
 class DenseMatrix : public MatrixBase
@@ -495,6 +497,9 @@ public:
         RCP<const Basic> (&bin_op)(const RCP<const Basic> &,
                                    const RCP<const Basic> &));
 
+    friend SparseLUAnalysis;
+    friend SparseLU;
+
 private:
     std::vector<unsigned> p_;
     std::vector<unsigned> j_;
@@ -504,6 +509,86 @@ private:
     unsigned col_;
 };
 
+// Symbolic analysis of the sparse LU factorization of a square CSRMatrix: a
+// permutation of the rows that makes the diagonal nonzero, a minimum degree
+// ordering of the graph of A + A^T to reduce the fill-in, and the pattern of
+// the factors. It only depends on the sparsity pattern of the matrix, so it
+// can be reused for matrices with the same pattern (e.g. a Jacobian evaluated
+// at several points).
+class SparseLUAnalysis
+{
+public:
+    SparseLUAnalysis(const CSRMatrix &A);
+
+    unsigned size() const
+    {
+        return n_;
+    }
+    // True if the matrix is singular whatever the values of its nonzero
+    // entries, i.e. if no permutation of the rows gives a nonzero diagonal
+    bool is_structurally_singular() const
+    {
+        return structurally_singular_;
+    }
+    // Number of entries of L + U, including the fill-in
+    size_t nnz() const
+    {
+        return j_.size();
+    }
+    // True if `A` has the sparsity pattern the analysis was done for
+    bool matches(const CSRMatrix &A) const;
+
+private:
+    unsigned n_;
+    bool structurally_singular_;
+    // Pattern of the matrix
+    std::vector<unsigned> a_p_;
+    std::vector<unsigned> a_j_;
+    // Row `i` of the permuted matrix is row `row_perm_[i]` of the matrix, and
+    // the same for the columns
+    std::vector<unsigned> row_perm_;
+    std::vector<unsigned> col_perm_;
+    // Pattern of L + U of the permuted matrix, with sorted columns
+    std::vector<unsigned> p_;
+    std::vector<unsigned> j_;
+    // Position of the diagonal of each row in `j_`
+    std::vector<unsigned> diag_;
+    // Position of each entry of the matrix in `j_`
+    std::vector<unsigned> scatter_;
+
+    friend class SparseLU;
+};
+
+// Fraction free sparse LU factorization of a square CSRMatrix, using the
+// ordering of a `SparseLUAnalysis`, which must outlive it.
+class SparseLU
+{
+public:
+    SparseLU(const SparseLUAnalysis &analysis, const CSRMatrix &A);
+
+    // The pivots are chosen from the sparsity pattern only, so a pivot may be
+    // zero even if the matrix is not singular. The factorization cannot be
+    // used then.
+    bool has_zero_pivot() const
+    {
+        return zero_pivot_;
+    }
+    RCP<const Basic> det() const;
+    // Solve Ax = b
+    void solve(const DenseMatrix &b, DenseMatrix &x) const;
+
+private:
+    const SparseLUAnalysis &analysis_;
+    // Values of L + U, in the pattern of the analysis
+    vec_basic x_;
+    bool zero_pivot_;
+};
+
+// Conversions between the dense and the CSR storage. `dense_to_csr` drops the
+// entries that are zero.
+DenseMatrix csr_to_dense(const CSRMatrix &A);
+CSRMatrix dense_to_csr(const DenseMatrix &A);
+
 // Return the Jacobian of the matrix
 void jacobian(const DenseMatrix &A, const DenseMatrix &x, DenseMatrix &result,
               bool diff_cache = true);
@@ -563,6 +648,21 @@ void LDL_solve(const DenseMatrix &A, const DenseMatrix &b, DenseMatrix &x);
 
 // Determinant
 RCP<const Basic> det_berkowitz(const DenseMatrix &A);
+// Determinant of a matrix with Integer entries, from its residues modulo
+// word-size primes recombined by the Chinese remainder theorem
+RCP<const Integer> det_multimodular(const DenseMatrix &A);
+
+// Typed kernels for matrices whose entries are all Integer, Rational or
+// RealDouble: exact entries use fraction free elimination on `integer_class`
+// arrays and RealDouble ones use `double` arrays. They return false, leaving
+// the output untouched, if an entry is symbolic, if RealDouble entries are
+// mixed with exact ones or, for `numeric_inverse` and `numeric_LU_solve`, if
+// the matrix is singular.
+bool numeric_det(const DenseMatrix &A, RCP<const Basic> &det);
+bool numeric_inverse(const DenseMatrix &A, DenseMatrix &B);
+bool numeric_LU_solve(const DenseMatrix &A, const DenseMatrix &b,
+                      DenseMatrix &x);
+bool numeric_mul(const DenseMatrix &A, const DenseMatrix &B, DenseMatrix &C);
 
 // Characteristic polynomial: Only the coefficients of monomials in decreasing
 // order of monomial powers is returned, i.e. if `B = transpose([1, -2, 3])`
@@ -12,6 +12,21 @@ void monomial_mul(const vec_int &A, const vec_int &B, vec_int &C)
     }
 }
 
+MonomialPacker::MonomialPacker(size_t nvars, unsigned long long max_exp)
+    : nvars_{nvars}, guard_mask_{0}
+{
+    unsigned value_bits = 0;
+    while (value_bits < 63 and (max_exp >> value_bits) != 0)
+        value_bits++;
+    bits_ = value_bits + 1;
+    max_ = (packed_monomial(1) << value_bits) - 1;
+    valid_ = nvars_ * bits_ <= 64;
+    if (valid_) {
+        for (size_t i = 0; i < nvars_; i++)
+            guard_mask_ |= packed_monomial(1) << (i * bits_ + value_bits);
+    }
+}
+
 /*
 // Other implementation of monomial_mul() are below. Those are slightly slower,
 // so they are commented out.
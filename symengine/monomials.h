@@ -7,6 +7,8 @@
 #ifndef SYMENGINE_MONOMIALS_H
 #define SYMENGINE_MONOMIALS_H
 
+#include <algorithm>
+#include <cstdint>
 #include <symengine/basic.h>
 
 namespace SymEngine
@@ -14,6 +16,212 @@ namespace SymEngine
 //! Monomial multiplication
 void monomial_mul(const vec_int &A, const vec_int &B, vec_int &C);
 
+//! Exponent vector with all of its exponents packed into one 64-bit word
+typedef uint64_t packed_monomial;
+
+/*! Packs exponent vectors of `nvars` non-negative exponents into a
+    `packed_monomial`, using the same number of bits for every exponent.
+
+    The top bit of every field is a guard bit, which is zero in any packed
+    monomial. Multiplying two monomials is then a single addition, and an
+    exponent overflowing its field shows up in the guard bits instead of
+    corrupting its neighbour.
+*/
+class MonomialPacker
+{
+public:
+    //! Layout for exponents up to `max_exp`. Check `is_valid()` before use.
+    MonomialPacker(size_t nvars, unsigned long long max_exp);
+
+    //! true if `nvars` exponents of this size fit into a word
+    bool is_valid() const
+    {
+        return valid_;
+    }
+    //! Largest exponent that can be packed
+    unsigned long long max_exponent() const
+    {
+        return max_;
+    }
+
+    //! Packs `v` into `m`, returns false if an exponent doesn't fit
+    template <typename Vec>
+    bool pack(const Vec &v, packed_monomial &m) const
+    {
+        SYMENGINE_ASSERT(v.size() == nvars_)
+        m = 0;
+        for (size_t i = 0; i < nvars_; i++) {
+            long long e = v[i];
+            if (e < 0 or static_cast<packed_monomial>(e) > max_)
+                return false;
+            m |= static_cast<packed_monomial>(e) << (i * bits_);
+        }
+        return true;
+    }
+
+    //! Unpacks `m` into `v`, which must have `nvars` elements
+    template <typename Vec>
+    void unpack(packed_monomial m, Vec &v) const
+    {
+        SYMENGINE_ASSERT(v.size() == nvars_)
+        for (size_t i = 0; i < nvars_; i++) {
+            v[i] = static_cast<typename Vec::value_type>((m >> (i * bits_))
+                                                         & max_);
+        }
+    }
+
+    //! Computes `c = a*b`, returns false if an exponent overflows
+    bool mul(packed_monomial a, packed_monomial b, packed_monomial &c) const
+    {
+        c = a + b;
+        return (c & guard_mask_) == 0;
+    }
+
+private:
+    size_t nvars_;
+    unsigned bits_;
+    // Largest exponent, also the mask of the value bits of a field
+    packed_monomial max_;
+    packed_monomial guard_mask_;
+    bool valid_;
+};
+
+/*! Hash map from packed monomials to coefficients of type `T`.
+
+    Open addressing with linear probing: keys and coefficients are stored
+    in flat arrays, so adding a term to an existing monomial or inserting a
+    new one does not allocate, except when the table grows.
+*/
+template <typename T>
+class PackedMonomialMap
+{
+public:
+    PackedMonomialMap(size_t expected_size = 0)
+    {
+        size_t capacity = 16;
+        while (capacity < 2 * expected_size)
+            capacity *= 2;
+        init(capacity);
+    }
+
+    //! Returns the coefficient of `m`, inserting a zero one if needed
+    T &operator[](packed_monomial m)
+    {
+        size_t i = find_slot(m);
+        if (keys_[i] == empty_key) {
+            if (2 * (size_ + 1) > keys_.size()) {
+                grow();
+                i = find_slot(m);
+            }
+            keys_[i] = m;
+            size_++;
+        }
+        return values_[i];
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    //! Calls `f(m, coef)` for every term
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (size_t i = 0; i < keys_.size(); i++) {
+            if (keys_[i] != empty_key)
+                f(keys_[i], values_[i]);
+        }
+    }
+
+private:
+    // All guard bits set, so this is never a valid packed monomial
+    static const packed_monomial empty_key = ~packed_monomial(0);
+
+    std::vector<packed_monomial> keys_;
+    std::vector<T> values_;
+    size_t size_;
+    unsigned shift_;
+
+    void init(size_t capacity)
+    {
+        keys_.assign(capacity, empty_key);
+        values_.clear();
+        values_.resize(capacity);
+        size_ = 0;
+        shift_ = 64;
+        while (capacity > 1) {
+            capacity /= 2;
+            shift_--;
+        }
+    }
+
+    size_t find_slot(packed_monomial m) const
+    {
+        // Fibonacci hashing: packed monomials differ mostly in the low bits
+        // of their fields, the multiplication spreads them to the top bits.
+        size_t mask = keys_.size() - 1;
+        size_t i = static_cast<size_t>((m * UINT64_C(0x9E3779B97F4A7C15))
+                                       >> shift_);
+        while (keys_[i] != empty_key and keys_[i] != m)
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow()
+    {
+        std::vector<packed_monomial> keys = std::move(keys_);
+        std::vector<T> values = std::move(values_);
+        init(2 * keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] != empty_key) {
+                size_t j = find_slot(keys[i]);
+                keys_[j] = keys[i];
+                values_[j] = std::move(values[i]);
+                size_++;
+            }
+        }
+    }
+};
+
+template <typename T>
+const packed_monomial PackedMonomialMap<T>::empty_key;
+
+//! Returns the largest exponent in the keys of the polynomial dictionary
+//! `d`, or -1 if there is a negative exponent.
+template <typename Dict>
+long long max_exponent(const Dict &d)
+{
+    long long m = 0;
+    for (const auto &term : d) {
+        for (auto e : term.first) {
+            long long e_ = e;
+            if (e_ < 0)
+                return -1;
+            m = std::max(m, e_);
+        }
+    }
+    return m;
+}
+
+//! Appends the terms of `d` to `terms`, with the exponents packed by
+//! `packer`. Returns false if one of them doesn't fit.
+template <typename Dict>
+bool pack_terms(
+    const Dict &d, const MonomialPacker &packer,
+    std::vector<std::pair<packed_monomial, const typename Dict::mapped_type *>>
+        &terms)
+{
+    terms.reserve(terms.size() + d.size());
+    packed_monomial m;
+    for (const auto &term : d) {
+        if (not packer.pack(term.first, m))
+            return false;
+        terms.push_back({m, &term.second});
+    }
+    return true;
+}
+
 } // namespace SymEngine
 
 #endif
@@ -129,7 +129,7 @@ RCP<const SymEngine::Basic> Mul::from_dict(const RCP<const Number> &coef,
                 }
             } else {
                 // For coef*x or coef*x**3 we simply return Mul:
-                return make_rcp<const Mul>(coef, std::move(d));
+                return make_interned<Mul>(coef, std::move(d));
             }
         }
         if (coef->is_one()) {
@@ -137,12 +137,12 @@ RCP<const SymEngine::Basic> Mul::from_dict(const RCP<const Number> &coef,
             if (eq(*p->second, *one)) {
                 return p->first;
             }
-            return make_rcp<const Pow>(p->first, p->second);
+            return make_interned<Pow>(p->first, p->second);
         } else {
-            return make_rcp<const Mul>(coef, std::move(d));
+            return make_interned<Mul>(coef, std::move(d));
         }
     } else {
-        return make_rcp<const Mul>(coef, std::move(d));
+        return make_interned<Mul>(coef, std::move(d));
     }
 }
 
@@ -504,6 +504,25 @@ void Mul::power_num(const Ptr<RCP<const Number>> &coef, map_basic_basic &d,
     }
 }
 
+bool Mul::for_each_arg(
+    const std::function<bool(const RCP<const Basic> &)> &f) const
+{
+    if (not coef_->is_one()) {
+        if (not f(coef_))
+            return false;
+    }
+    for (const auto &p : dict_) {
+        if (eq(*p.second, *one)) {
+            if (not f(p.first))
+                return false;
+        } else {
+            if (not f(make_rcp<const Pow>(p.first, p.second)))
+                return false;
+        }
+    }
+    return true;
+}
+
 vec_basic Mul::get_args() const
 {
     vec_basic args;
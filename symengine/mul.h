@@ -121,6 +121,10 @@ public:
                       const map_basic_basic &dict) const;
 
     vec_basic get_args() const override;
+    //! Calls `f` on the arguments, like `get_args()`, until it returns false.
+    //! Only the powers whose exponent is not one are created.
+    bool for_each_arg(const std::function<bool(const RCP<const Basic> &)> &f)
+        const override;
 
     inline const RCP<const Number> &get_coef() const
     {
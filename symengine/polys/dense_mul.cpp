@@ -0,0 +1,477 @@
+#include <algorithm>
+
+#include <symengine/polys/dense_mul.h>
+#include <symengine/polys/uintpoly.h>
+#include <symengine/symengine_exception.h>
+
+namespace SymEngine
+{
+
+using detail::dense_strip;
+using detail::vec_word;
+using detail::WordModulus;
+
+uint64_t detail::WordModulus::pow(uint64_t a, uint64_t n) const
+{
+    uint64_t r = reduce(1);
+    a = reduce(a);
+    while (n != 0) {
+        if (n & 1)
+            r = mul(r, a);
+        a = mul(a, a);
+        n >>= 1;
+    }
+    return r;
+}
+
+uint64_t detail::WordModulus::invert(uint64_t a) const
+{
+    int64_t t = 0, new_t = 1;
+    int64_t r = static_cast<int64_t>(p_),
+            new_r = static_cast<int64_t>(reduce(a));
+    while (new_r != 0) {
+        const int64_t q = r / new_r;
+        std::swap(t, new_t);
+        new_t -= q * t;
+        std::swap(r, new_r);
+        new_r -= q * r;
+    }
+    if (r != 1)
+        throw SymEngineException("Error: leading coefficient is not "
+                                 "invertible.");
+    return static_cast<uint64_t>(t < 0 ? t + static_cast<int64_t>(p_) : t);
+}
+
+namespace
+{
+
+// Karatsuba is used when the shorter factor has at least this many
+// coefficients, transforms when it has at least the ntt thresholds. The
+// crossovers were measured against GMP backed Kronecker substitution for
+// integers and against Karatsuba modulo a word.
+const size_t karatsuba_threshold = 32;
+const size_t ntt_threshold_mod = 4096;
+const size_t ntt_threshold_int = 64;
+// Quotients and divisors shorter than this use long division
+const size_t newton_threshold = 2048;
+
+struct NTTPrime {
+    uint64_t p;
+    // A primitive root modulo p
+    uint64_t g;
+};
+
+// Primes c * 2**k + 1 with k >= 24 between 2**29 and 2**31, so that
+// transforms of length up to 2**24 exist modulo each of them
+const NTTPrime ntt_primes[] = {{2130706433, 3}, {2113929217, 5},
+                               {2013265921, 31}, {1811939329, 13},
+                               {1711276033, 29}, {1224736769, 3},
+                               {1107296257, 10}, {754974721, 11}};
+const size_t num_ntt_primes = sizeof(ntt_primes) / sizeof(ntt_primes[0]);
+const size_t max_ntt_length = size_t(1) << 24;
+// Every prime above is larger than 2**29
+const unsigned ntt_prime_bits = 29;
+
+// Additive operations on coefficients and the schoolbook product, for
+// Karatsuba over residues modulo a word and over integers
+struct WordOps {
+    const WordModulus &m;
+
+    void add(uint64_t &a, uint64_t b) const
+    {
+        a = m.add(a, b);
+    }
+    void sub(uint64_t &a, uint64_t b) const
+    {
+        a = m.sub(a, b);
+    }
+    // r[0, na + nb - 1) += a * b
+    void schoolbook_add(const uint64_t *a, size_t na, const uint64_t *b,
+                        size_t nb, uint64_t *r) const
+    {
+        for (size_t k = 0; k + 1 < na + nb; k++) {
+            const size_t lb = k + 1 > nb ? k + 1 - nb : 0;
+            const size_t ub = std::min(k + 1, na);
+            uint64_t acc = r[k];
+            for (size_t i = lb; i < ub; i++)
+                acc = m.addmul(acc, a[i], b[k - i]);
+            r[k] = m.reduce(acc);
+        }
+    }
+};
+
+struct IntOps {
+    void add(integer_class &a, const integer_class &b) const
+    {
+        a += b;
+    }
+    void sub(integer_class &a, const integer_class &b) const
+    {
+        a -= b;
+    }
+    void schoolbook_add(const integer_class *a, size_t na,
+                        const integer_class *b, size_t nb,
+                        integer_class *r) const
+    {
+        for (size_t i = 0; i < na; i++)
+            for (size_t j = 0; j < nb; j++)
+                mp_addmul(r[i + j], a[i], b[j]);
+    }
+};
+
+// r[0, na + nb - 1) += a * b
+template <typename T, typename Ops>
+void karatsuba_add(const T *a, size_t na, const T *b, size_t nb, T *r,
+                   const Ops &ops)
+{
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb < karatsuba_threshold) {
+        ops.schoolbook_add(a, na, b, nb, r);
+        return;
+    }
+    if (na > nb) {
+        // Multiply `b` by slices of `a` of the same length
+        for (size_t i = 0; i < na; i += nb)
+            karatsuba_add(a + i, std::min(nb, na - i), b, nb, r + i, ops);
+        return;
+    }
+    // a = a0 + x**h a1, b = b0 + x**h b1 with a1, b1 of length hi >= h
+    const size_t h = na / 2, hi = na - h;
+    std::vector<T> z0(2 * h - 1), z1(2 * hi - 1), z2(2 * hi - 1);
+    std::vector<T> sa(a + h, a + na), sb(b + h, b + na);
+    for (size_t i = 0; i < h; i++) {
+        ops.add(sa[i], a[i]);
+        ops.add(sb[i], b[i]);
+    }
+    karatsuba_add(a, h, b, h, z0.data(), ops);
+    karatsuba_add(a + h, hi, b + h, hi, z2.data(), ops);
+    karatsuba_add(sa.data(), hi, sb.data(), hi, z1.data(), ops);
+    for (size_t i = 0; i < z0.size(); i++) {
+        ops.sub(z1[i], z0[i]);
+        ops.add(r[i], z0[i]);
+    }
+    for (size_t i = 0; i < z2.size(); i++) {
+        ops.sub(z1[i], z2[i]);
+        ops.add(r[2 * h + i], z2[i]);
+    }
+    for (size_t i = 0; i < z1.size(); i++)
+        ops.add(r[h + i], z1[i]);
+}
+
+// In place transform of `a`, whose length is a power of two, modulo `q`
+void ntt(vec_word &a, bool inverse, const NTTPrime &q, const WordModulus &m)
+{
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(a[i], a[j]);
+    }
+    vec_word w;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        uint64_t w_len = m.pow(q.g, (q.p - 1) / len);
+        if (inverse)
+            w_len = m.invert(w_len);
+        const size_t half = len / 2;
+        w.resize(half);
+        w[0] = 1;
+        for (size_t j = 1; j < half; j++)
+            w[j] = m.mul(w[j - 1], w_len);
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; j++) {
+                const uint64_t u = a[i + j];
+                const uint64_t v = m.mul(a[i + j + half], w[j]);
+                a[i + j] = m.add(u, v);
+                a[i + j + half] = m.sub(u, v);
+            }
+        }
+    }
+    if (inverse) {
+        const uint64_t n_inv = m.invert(n);
+        for (auto &c : a)
+            c = m.mul(c, n_inv);
+    }
+}
+
+// Product of `a` and `b`, whose coefficients are reduced modulo `q`, with
+// transforms of length `len`
+vec_word ntt_mul(vec_word a, vec_word b, size_t len, const NTTPrime &q)
+{
+    const WordModulus m(q.p);
+    const size_t n = a.size() + b.size() - 1;
+    a.resize(len);
+    b.resize(len);
+    ntt(a, false, q, m);
+    ntt(b, false, q, m);
+    for (size_t i = 0; i < len; i++)
+        a[i] = m.mul(a[i], b[i]);
+    ntt(a, true, q, m);
+    a.resize(n);
+    return a;
+}
+
+size_t ntt_length(size_t n)
+{
+    size_t len = 1;
+    while (len < n)
+        len <<= 1;
+    return len;
+}
+
+// Mixed radix digits v of x, given its residues r modulo the first `k` ntt
+// primes, such that x = v[0] + q0 (v[1] + q1 (v[2] + ...))
+class Garner
+{
+private:
+    size_t k_;
+    std::vector<WordModulus> m_;
+    // inv_[j][i] is the inverse of q_i modulo q_j, for i < j
+    std::vector<vec_word> inv_;
+
+public:
+    explicit Garner(size_t k) : k_(k)
+    {
+        for (size_t j = 0; j < k; j++) {
+            m_.push_back(WordModulus(ntt_primes[j].p));
+            inv_.push_back(vec_word(j));
+            for (size_t i = 0; i < j; i++)
+                inv_[j][i] = m_[j].invert(ntt_primes[i].p);
+        }
+    }
+    void digits(const uint64_t *r, uint64_t *v) const
+    {
+        for (size_t j = 0; j < k_; j++) {
+            uint64_t x = r[j];
+            for (size_t i = 0; i < j; i++)
+                x = m_[j].mul(m_[j].sub(x, m_[j].reduce(v[i])), inv_[j][i]);
+            v[j] = x;
+        }
+    }
+};
+
+unsigned max_bit_length(const std::vector<integer_class> &a)
+{
+    integer_class m(0), t;
+    for (const auto &c : a) {
+        t = mp_abs(c);
+        if (t > m)
+            m = t;
+    }
+    return bit_length(m);
+}
+
+// Number of ntt primes whose product exceeds twice the largest coefficient
+// of a product of polynomials with these lengths and bit lengths
+size_t ntt_primes_needed(size_t na, size_t nb, unsigned bits_a,
+                         unsigned bits_b)
+{
+    unsigned bound = 1 + bits_a + bits_b;
+    for (size_t n = std::min(na, nb); n > 1; n = (n + 1) / 2)
+        bound++;
+    return (bound + ntt_prime_bits - 1) / ntt_prime_bits;
+}
+
+vec_word residues(const std::vector<integer_class> &a, uint64_t p)
+{
+    vec_word r(a.size());
+    integer_class t;
+    const integer_class q(static_cast<unsigned long>(p));
+    for (size_t i = 0; i < a.size(); i++) {
+        if (mp_fits_slong_p(a[i])) {
+            long s = mp_get_si(a[i]) % static_cast<long>(p);
+            r[i] = static_cast<uint64_t>(s < 0 ? s + static_cast<long>(p) : s);
+        } else {
+            mp_fdiv_r(t, a[i], q);
+            r[i] = mp_get_ui(t);
+        }
+    }
+    return r;
+}
+
+// Classical long division, with each coefficient computed as a single
+// unreduced dot product
+void long_divrem(vec_word &a, const vec_word &b, const WordModulus &m,
+                 vec_word *quo)
+{
+    const size_t deg_dividend = a.size() - 1, deg_divisor = b.size() - 1;
+    const uint64_t inv = m.invert(b.back());
+    vec_word nb(deg_divisor);
+    for (size_t j = 0; j < deg_divisor; j++)
+        nb[j] = m.neg(b[j]);
+    for (size_t it = deg_dividend + 1; it-- != 0;) {
+        const size_t lb = deg_divisor + it > deg_dividend
+                              ? deg_divisor + it - deg_dividend
+                              : 0;
+        const size_t ub = std::min(it + 1, deg_divisor);
+        uint64_t acc = a[it];
+        for (size_t j = lb; j < ub; ++j)
+            acc = m.addmul(acc, a[it - j + deg_divisor], nb[j]);
+        uint64_t coeff = m.reduce(acc);
+        if (it >= deg_divisor)
+            coeff = m.mul(coeff, inv);
+        a[it] = coeff;
+    }
+    if (quo)
+        quo->assign(a.begin() + deg_divisor, a.end());
+    a.resize(deg_divisor);
+    dense_strip(a);
+}
+
+} // namespace
+
+vec_word detail::dense_mul_mod(const vec_word &a, const vec_word &b,
+                               const WordModulus &m)
+{
+    if (a.empty() or b.empty())
+        return vec_word();
+    const size_t na = a.size(), nb = b.size(), n = na + nb - 1;
+    vec_word c;
+    if (std::min(na, nb) >= ntt_threshold_mod and n <= max_ntt_length) {
+        // The coefficients of the product over the integers are less than
+        // 2**24 * p**2 < 2**88, so three primes determine them
+        const size_t len = ntt_length(n);
+        std::vector<vec_word> r;
+        for (size_t j = 0; j < 3; j++) {
+            const WordModulus mj(ntt_primes[j].p);
+            vec_word aj(a), bj(b);
+            for (auto &x : aj)
+                x = mj.reduce(x);
+            for (auto &x : bj)
+                x = mj.reduce(x);
+            r.push_back(ntt_mul(std::move(aj), std::move(bj), len,
+                                ntt_primes[j]));
+        }
+        const Garner garner(3);
+        const uint64_t q0 = m.reduce(ntt_primes[0].p);
+        const uint64_t q01 = m.mul(q0, m.reduce(ntt_primes[1].p));
+        c.resize(n);
+        uint64_t rk[3], v[3];
+        for (size_t k = 0; k < n; k++) {
+            for (size_t j = 0; j < 3; j++)
+                rk[j] = r[j][k];
+            garner.digits(rk, v);
+            uint64_t acc = m.reduce(v[0]);
+            acc = m.addmul(acc, q0, v[1]);
+            acc = m.addmul(acc, q01, v[2]);
+            c[k] = m.reduce(acc);
+        }
+    } else {
+        c.assign(n, 0);
+        karatsuba_add(a.data(), na, b.data(), nb, c.data(), WordOps{m});
+    }
+    dense_strip(c);
+    return c;
+}
+
+vec_word detail::dense_inv_series_mod(const vec_word &a, size_t n,
+                                      const WordModulus &m)
+{
+    SYMENGINE_ASSERT(not a.empty() and n > 0)
+    vec_word g = {m.invert(a[0])};
+    // Each step doubles the precision: with a g = 1 + x**k t mod x**(2 k),
+    // the next approximation is g (1 - x**k t)
+    for (size_t k = 1; k < n;) {
+        const size_t k2 = std::min(2 * k, n);
+        vec_word e = dense_mul_mod(
+            vec_word(a.begin(), a.begin() + std::min(a.size(), k2)), g, m);
+        e.resize(k2);
+        const vec_word gt = dense_mul_mod(
+            g, vec_word(e.begin() + k, e.end()), m);
+        g.resize(k2);
+        for (size_t i = 0; i < k2 - k and i < gt.size(); i++)
+            g[k + i] = m.neg(gt[i]);
+        k = k2;
+    }
+    g.resize(n);
+    return g;
+}
+
+void detail::dense_divrem_mod(vec_word &a, const vec_word &b,
+                              const WordModulus &m, vec_word *quo)
+{
+    SYMENGINE_ASSERT(not b.empty() and b.back() != 0)
+    if (a.size() < b.size()) {
+        if (quo)
+            quo->clear();
+        return;
+    }
+    const size_t nq = a.size() - b.size() + 1;
+    if (nq < newton_threshold or b.size() < newton_threshold) {
+        long_divrem(a, b, m, quo);
+        return;
+    }
+    // The reversed quotient is the reversed dividend divided by the
+    // reversed divisor, modulo x**nq
+    const vec_word inv
+        = dense_inv_series_mod(vec_word(b.rbegin(), b.rend()), nq, m);
+    vec_word q
+        = dense_mul_mod(vec_word(a.rbegin(), a.rbegin() + nq), inv, m);
+    q.resize(nq);
+    std::reverse(q.begin(), q.end());
+    const vec_word qb = dense_mul_mod(q, b, m);
+    a.resize(b.size() - 1);
+    for (size_t i = 0; i < a.size() and i < qb.size(); i++)
+        a[i] = m.sub(a[i], qb[i]);
+    dense_strip(a);
+    if (quo)
+        quo->swap(q);
+}
+
+bool dense_mul_uses_ntt(size_t na, size_t nb, unsigned bits_a,
+                        unsigned bits_b)
+{
+    return std::min(na, nb) >= ntt_threshold_int
+           and na + nb - 1 <= max_ntt_length
+           and ntt_primes_needed(na, nb, bits_a, bits_b) <= num_ntt_primes;
+}
+
+std::vector<integer_class> dense_mul(const std::vector<integer_class> &a,
+                                     const std::vector<integer_class> &b)
+{
+    if (a.empty() or b.empty())
+        return std::vector<integer_class>();
+    const size_t na = a.size(), nb = b.size(), n = na + nb - 1;
+    std::vector<integer_class> c(n);
+    const unsigned bits_a = max_bit_length(a), bits_b = max_bit_length(b);
+    if (not dense_mul_uses_ntt(na, nb, bits_a, bits_b)) {
+        karatsuba_add(a.data(), na, b.data(), nb, c.data(), IntOps());
+        return c;
+    }
+    const size_t k = ntt_primes_needed(na, nb, bits_a, bits_b);
+    const size_t len = ntt_length(n);
+    std::vector<vec_word> r;
+    for (size_t j = 0; j < k; j++)
+        r.push_back(ntt_mul(residues(a, ntt_primes[j].p),
+                            residues(b, ntt_primes[j].p), len,
+                            ntt_primes[j]));
+    // Rebuild each coefficient from its mixed radix digits, as the
+    // symmetric residue modulo the product of the primes
+    const Garner garner(k);
+    integer_class modulus(1);
+    for (size_t j = 0; j < k; j++)
+        modulus *= integer_class(static_cast<unsigned long>(ntt_primes[j].p));
+    const integer_class half = modulus / 2;
+    vec_word rk(k), v(k);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < k; j++)
+            rk[j] = r[j][i];
+        garner.digits(rk.data(), v.data());
+        integer_class &x = c[i];
+        x = static_cast<unsigned long>(v[k - 1]);
+        for (size_t j = k - 1; j-- != 0;) {
+            x *= integer_class(static_cast<unsigned long>(ntt_primes[j].p));
+            x += integer_class(static_cast<unsigned long>(v[j]));
+        }
+        if (x > half)
+            x -= modulus;
+    }
+    return c;
+}
+
+} // namespace SymEngine
@@ -0,0 +1,138 @@
+/**
+ *  \file dense_mul.h
+ *  Multiplication and division of dense univariate coefficient vectors
+ *
+ **/
+#ifndef SYMENGINE_DENSE_MUL_H
+#define SYMENGINE_DENSE_MUL_H
+
+#include <cstdint>
+#include <symengine/basic.h>
+
+namespace SymEngine
+{
+
+/* Word-size modular arithmetic and the products and divisions built on it.
+ * They are shared by the polynomial modules and are not part of the public
+ * API. */
+namespace detail
+{
+
+//! Coefficients of a dense polynomial modulo a word-size integer, lowest
+//! degree first
+typedef std::vector<uint64_t> vec_word;
+
+//! High 64 bits of the 128 bit product `a * b`
+inline uint64_t mulhi(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    const uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+    return hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+/*! Arithmetic modulo `p < 2**32` on machine words.
+
+    The product of two residues fits in 64 bits and is reduced with Barrett's
+    method. Sums of such products are accumulated without reduction by
+    `addmul()`, folding 2**64 mod p back in whenever the accumulator wraps
+    around, and reduced once at the end.
+*/
+class WordModulus
+{
+private:
+    uint64_t p_;
+    // floor((2**64 - 1) / p)
+    uint64_t m_;
+    // 2**64 mod p
+    uint64_t r64_;
+
+public:
+    explicit WordModulus(uint64_t p)
+        : p_(p), m_(UINT64_MAX / p), r64_((UINT64_MAX % p + 1) % p)
+    {
+    }
+
+    inline uint64_t modulus() const
+    {
+        return p_;
+    }
+    inline uint64_t reduce(uint64_t x) const
+    {
+        // The quotient estimate is at most one less than x / p
+        uint64_t r = x - mulhi(x, m_) * p_;
+        return r >= p_ ? r - p_ : r;
+    }
+    inline uint64_t mul(uint64_t a, uint64_t b) const
+    {
+        return reduce(a * b);
+    }
+    inline uint64_t add(uint64_t a, uint64_t b) const
+    {
+        uint64_t s = a + b;
+        return s >= p_ ? s - p_ : s;
+    }
+    inline uint64_t sub(uint64_t a, uint64_t b) const
+    {
+        return a >= b ? a - b : a + p_ - b;
+    }
+    inline uint64_t neg(uint64_t a) const
+    {
+        return a == 0 ? 0 : p_ - a;
+    }
+    //! acc + a * b, congruent modulo p but not reduced
+    inline uint64_t addmul(uint64_t acc, uint64_t a, uint64_t b) const
+    {
+        const uint64_t t = a * b;
+        acc += t;
+        if (acc < t)
+            acc += r64_;
+        return acc;
+    }
+    uint64_t pow(uint64_t a, uint64_t n) const;
+    //! Inverse of `a`, throws if it is not invertible
+    uint64_t invert(uint64_t a) const;
+};
+
+//! Removes the zero coefficients at the top of `a`
+inline void dense_strip(vec_word &a)
+{
+    while (not a.empty() and a.back() == 0)
+        a.pop_back();
+}
+
+//! Product of `a` and `b` modulo `m`. Uses schoolbook multiplication for
+//! short inputs, Karatsuba for medium ones and number theoretic transforms
+//! modulo three primes, combined by the Chinese remainder theorem, for long
+//! ones.
+vec_word dense_mul_mod(const vec_word &a, const vec_word &b,
+                       const WordModulus &m);
+//! Inverse of `a` modulo x**n by Newton iteration; a[0] must be invertible
+vec_word dense_inv_series_mod(const vec_word &a, size_t n,
+                              const WordModulus &m);
+//! Divides `a` by the nonzero `b` modulo `m`, leaving the remainder in `a`
+//! and storing the quotient in `quo` unless it is null. Long quotients are
+//! computed from the inverse of the reversed divisor.
+void dense_divrem_mod(vec_word &a, const vec_word &b, const WordModulus &m,
+                      vec_word *quo);
+} // namespace detail
+
+//! Product of two integer polynomials. Uses number theoretic transforms
+//! modulo as many word-size primes as the size of the coefficients requires
+//! when that is cheaper than Karatsuba.
+std::vector<integer_class> dense_mul(const std::vector<integer_class> &a,
+                                     const std::vector<integer_class> &b);
+//! Whether dense_mul() would multiply inputs of these lengths and
+//! coefficient bit lengths with transforms
+bool dense_mul_uses_ntt(size_t na, size_t nb, unsigned bits_a,
+                        unsigned bits_b);
+
+} // namespace SymEngine
+
+#endif
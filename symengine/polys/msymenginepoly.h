@@ -132,6 +132,8 @@ public:
         SYMENGINE_ASSERT(a.vec_size == b.vec_size)
 
         Wrapper p(a.vec_size);
+        if (mul_packed(a, b, p))
+            return p;
         for (auto const &a_ : a.dict_) {
             for (auto const &b_ : b.dict_) {
 
@@ -157,6 +159,40 @@ public:
         return p;
     }
 
+    /*! Computes `p = a*b` with the exponents packed into single words, so
+        that the terms are multiplied without allocating. Returns false,
+        leaving `p` untouched, if the exponents of the product don't fit.
+    */
+    static bool mul_packed(const Wrapper &a, const Wrapper &b, Wrapper &p)
+    {
+        long long max_a = max_exponent(a.dict_), max_b = max_exponent(b.dict_);
+        if (max_a < 0 or max_b < 0)
+            return false;
+        MonomialPacker packer(a.vec_size, max_a + max_b);
+        std::vector<std::pair<packed_monomial, const Value *>> pa, pb;
+        if (not packer.is_valid() or not pack_terms(a.dict_, packer, pa)
+            or not pack_terms(b.dict_, packer, pb))
+            return false;
+
+        PackedMonomialMap<Value> prod(std::max(pa.size(), pb.size()));
+        packed_monomial m;
+        for (const auto &a_ : pa) {
+            for (const auto &b_ : pb) {
+                packer.mul(a_.first, b_.first, m);
+                prod[m] += *a_.second * *b_.second;
+            }
+        }
+
+        Vec target(a.vec_size, 0);
+        prod.for_each([&](packed_monomial m, const Value &c) {
+            if (c != Value(0)) {
+                packer.unpack(m, target);
+                p.dict_.insert({target, c});
+            }
+        });
+        return true;
+    }
+
     static Wrapper pow(const Wrapper &a, unsigned int p)
     {
         Wrapper tmp = a, res(a.vec_size);
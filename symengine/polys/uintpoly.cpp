@@ -22,6 +22,21 @@ UIntPoly::UIntPoly(const RCP<const Basic> &var, UIntDict &&dict)
     return seed;
 }
 
+UIntDict UIntDict::mul_dense(const UIntDict &a, const UIntDict &b)
+{
+    std::vector<integer_class> va(a.degree() + 1), vb(b.degree() + 1);
+    for (const auto &it : a.dict_)
+        va[it.first] = it.second;
+    for (const auto &it : b.dict_)
+        vb[it.first] = it.second;
+    std::vector<integer_class> vc = dense_mul(va, vb);
+    UIntDict r;
+    for (unsigned int i = 0; i < vc.size(); i++)
+        if (vc[i] != 0)
+            r.dict_.insert(r.dict_.end(), {i, std::move(vc[i])});
+    return r;
+}
+
 bool divides_upoly(const UIntPoly &a, const UIntPoly &b,
                    const Ptr<RCP<const UIntPoly>> &out)
 {
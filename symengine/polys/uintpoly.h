@@ -5,11 +5,13 @@
 #ifndef SYMENGINE_UINTPOLY_H
 #define SYMENGINE_UINTPOLY_H
 
+#include <symengine/polys/dense_mul.h>
 #include <symengine/polys/usymenginepoly.h>
 
 namespace SymEngine
 {
-// Calculates bit length of number, used in UIntDict*= only
+// Calculates bit length of a nonnegative number, used in UIntDict*= and
+// dense_mul()
 template <typename T>
 unsigned int bit_length(T t)
 {
@@ -58,9 +60,18 @@ public:
     {
         int mul = 1;
 
+        const unsigned int bits_a = bit_length(a.max_abs_coef());
+        const unsigned int bits_b = bit_length(b.max_abs_coef());
+        // Long, mostly dense factors with small coefficients are multiplied
+        // with number theoretic transforms, everything else by Kronecker
+        // substitution
+        if (2 * a.size() > a.degree() and 2 * b.size() > b.degree()
+            and dense_mul_uses_ntt(a.degree() + 1, b.degree() + 1, bits_a,
+                                   bits_b))
+            return mul_dense(a, b);
+
         unsigned int N = bit_length(std::min(a.degree() + 1, b.degree() + 1))
-                         + bit_length(a.max_abs_coef())
-                         + bit_length(b.max_abs_coef());
+                         + bits_a + bits_b;
 
         integer_class full = integer_class(1), temp, res;
         full <<= N;
@@ -93,6 +104,9 @@ public:
         return r;
     }
 
+    //! Product of `a` and `b` computed on dense coefficient vectors
+    static UIntDict mul_dense(const UIntDict &a, const UIntDict &b);
+
     int compare(const UIntDict &other) const
     {
         if (dict_.size() != other.dict_.size())
@@ -0,0 +1,188 @@
+#include <symengine/pool_allocator.h>
+#include <symengine/symengine_assert.h>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace SymEngine
+{
+
+struct NodePool::ChunkHeader {
+    size_t size_class;
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    // nullptr once the owning pool has been destroyed. It is read by
+    // deallocate() without the lock of the pool.
+    std::atomic<NodePool *> owner;
+    std::atomic<size_t> live;
+#else
+    NodePool *owner;
+    size_t live;
+#endif
+};
+
+const size_t NodePool::chunk_size;
+const size_t NodePool::granularity;
+const size_t NodePool::max_block_size;
+const size_t NodePool::num_size_classes;
+
+namespace
+{
+
+thread_local NodePool *current_arena = nullptr;
+
+} // namespace
+
+NodePool::ChunkHeader *NodePool::header_of(void *p)
+{
+    return reinterpret_cast<ChunkHeader *>(reinterpret_cast<uintptr_t>(p)
+                                           & ~uintptr_t(chunk_size - 1));
+}
+
+void NodePool::free_chunk(ChunkHeader *h)
+{
+    h->~ChunkHeader();
+#ifdef _WIN32
+    _aligned_free(h);
+#else
+    std::free(h);
+#endif
+}
+
+NodePool::~NodePool()
+{
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    for (ChunkHeader *h : chunks_) {
+        if (h->live == 0) {
+            free_chunk(h);
+        } else {
+            // Some nodes are still referenced: the chunk is freed by
+            // deallocate() when the last of them is released.
+            h->owner = nullptr;
+        }
+    }
+}
+
+NodePool::ChunkHeader *NodePool::new_chunk(size_t size_class)
+{
+    // The chunk is aligned to `chunk_size`, which lets header_of() find the
+    // header of any block by masking its address.
+    void *raw;
+#ifdef _WIN32
+    raw = _aligned_malloc(chunk_size, chunk_size);
+    if (raw == nullptr)
+        throw std::bad_alloc();
+#else
+    if (posix_memalign(&raw, chunk_size, chunk_size) != 0)
+        throw std::bad_alloc();
+#endif
+    char *aligned = static_cast<char *>(raw);
+    // Blocks start after the header, rounded up to keep them aligned
+    const size_t header_size
+        = (sizeof(ChunkHeader) + granularity - 1) / granularity * granularity;
+    ChunkHeader *h = new (aligned) ChunkHeader();
+    h->owner = this;
+    h->size_class = size_class;
+    h->live = 0;
+    chunks_.push_back(h);
+    bump_[size_class] = aligned + header_size;
+    bump_end_[size_class] = aligned + chunk_size;
+    return h;
+}
+
+void *NodePool::allocate(size_t size)
+{
+    if (size > max_block_size or size == 0) {
+        return ::operator new(size);
+    }
+    const size_t c = (size - 1) / granularity;
+    const size_t block_size = (c + 1) * granularity;
+    void *p;
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    if (free_[c] != nullptr) {
+        p = free_[c];
+        free_[c] = free_[c]->next;
+    } else {
+        if (bump_[c] == nullptr or bump_[c] + block_size > bump_end_[c]) {
+            new_chunk(c);
+        }
+        p = bump_[c];
+        bump_[c] += block_size;
+    }
+    header_of(p)->live++;
+    live_++;
+    return p;
+}
+
+void NodePool::push_free(void *p, size_t size_class)
+{
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    FreeBlock *b = reinterpret_cast<FreeBlock *>(p);
+    b->next = free_[size_class];
+    free_[size_class] = b;
+    header_of(p)->live--;
+    live_--;
+}
+
+void NodePool::deallocate(void *p, size_t size)
+{
+    if (size > max_block_size or size == 0) {
+        ::operator delete(p);
+        return;
+    }
+    ChunkHeader *h = header_of(p);
+    SYMENGINE_ASSERT(h->size_class == (size - 1) / granularity)
+    NodePool *owner = h->owner;
+    if (owner != nullptr) {
+        owner->push_free(p, h->size_class);
+    } else if (--h->live == 0) {
+        free_chunk(h);
+    }
+}
+
+size_t NodePool::live_blocks() const
+{
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    return live_;
+}
+
+size_t NodePool::num_chunks() const
+{
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    return chunks_.size();
+}
+
+ExprArena::ExprArena() : previous_{current_arena}
+{
+    current_arena = &pool_;
+}
+
+ExprArena::~ExprArena()
+{
+    SYMENGINE_ASSERT(current_arena == &pool_)
+    current_arena = previous_;
+}
+
+NodePool &current_node_pool()
+{
+    if (current_arena != nullptr)
+        return *current_arena;
+    // The global pool is never destroyed, so that nodes held by static
+    // objects can be released safely at exit.
+    static NodePool *global_pool = new NodePool();
+    return *global_pool;
+}
+
+} // namespace SymEngine
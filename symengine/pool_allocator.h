@@ -0,0 +1,125 @@
+/**
+ *  \file pool_allocator.h
+ *  Size-class pool allocator for Basic nodes
+ *
+ **/
+#ifndef SYMENGINE_POOL_ALLOCATOR_H
+#define SYMENGINE_POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+#include <symengine/symengine_config.h>
+
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+#include <atomic>
+#include <mutex>
+#endif
+
+namespace SymEngine
+{
+
+/*! A pool of fixed-size blocks, grouped in size classes.
+
+    Memory is obtained from the system in chunks of `chunk_size` bytes, aligned
+    to `chunk_size`. Every chunk serves a single size class, and it starts
+    with a header recording the pool that owns it, so that `deallocate()` can
+    find the owner of any block in O(1) without a per-block header. Requests
+    larger than `max_block_size` are forwarded to `::operator new`.
+
+    Freed blocks are kept on a per-size-class free list and are reused by
+    later allocations. Chunks are returned to the system when the pool is
+    destroyed. Chunks that still contain live blocks at that point are
+    released as soon as their last block is deallocated. Blocks may be
+    deallocated from any thread, but not while their pool is being destroyed.
+*/
+class NodePool
+{
+public:
+    static const size_t chunk_size = size_t(1) << 16;
+    static const size_t granularity = 16;
+    static const size_t max_block_size = 512;
+    static const size_t num_size_classes = max_block_size / granularity;
+
+    NodePool() = default;
+    ~NodePool();
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    //! Returns a block of at least `size` bytes
+    void *allocate(size_t size);
+    //! Returns the block `p` of `size` bytes to the pool it came from.
+    //! `size` must be the same as in the call to `allocate()`.
+    static void deallocate(void *p, size_t size);
+
+    //! Number of blocks currently allocated from this pool
+    size_t live_blocks() const;
+    //! Number of chunks currently owned by this pool
+    size_t num_chunks() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+    struct ChunkHeader;
+
+    static ChunkHeader *header_of(void *p);
+    static void free_chunk(ChunkHeader *h);
+    ChunkHeader *new_chunk(size_t size_class);
+    void push_free(void *p, size_t size_class);
+
+    FreeBlock *free_[num_size_classes] = {};
+    // Unused tail of the most recent chunk of each size class
+    char *bump_[num_size_classes] = {};
+    char *bump_end_[num_size_classes] = {};
+    std::vector<ChunkHeader *> chunks_;
+    size_t live_ = 0;
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    mutable std::mutex mutex_;
+#endif
+};
+
+/*! Scoped pool for temporary expressions.
+
+    While an `ExprArena` is alive, `Basic` nodes constructed by the current
+    thread are allocated from the arena instead of the global node pool (only
+    when SymEngine is built with `WITH_SYMENGINE_POOL_ALLOCATOR`). Nodes are
+    still released one at a time when their reference count drops to zero;
+    the arena only keeps the temporaries of a computation in chunks of their
+    own, away from long lived nodes. Destroying the arena frees its chunks
+    that hold no node. Nodes from the arena that are still referenced stay
+    valid, and their chunks are freed once they are released.
+
+    Arenas nest. An arena must be destroyed on the thread that created it, and
+    not concurrently with the release of its nodes on other threads.
+
+        {
+            ExprArena arena;
+            RCP<const Basic> r = expand(pow(add(x, y), integer(20)));
+            result = r->diff(x);
+        } // the chunks of the temporaries of expand() are freed here
+*/
+class ExprArena
+{
+public:
+    ExprArena();
+    ~ExprArena();
+    ExprArena(const ExprArena &) = delete;
+    ExprArena &operator=(const ExprArena &) = delete;
+
+    NodePool &pool()
+    {
+        return pool_;
+    }
+
+private:
+    NodePool pool_;
+    NodePool *previous_;
+};
+
+//! Returns the pool used for new nodes by the current thread: the innermost
+//! `ExprArena` if there is one, otherwise the global node pool.
+NodePool &current_node_pool();
+
+} // namespace SymEngine
+
+#endif
@@ -106,7 +106,7 @@ RCP<const Basic> pow(const RCP<const Basic> &a, const RCP<const Basic> &b)
                    and rcp_static_cast<const Number>(b)->is_negative()) {
             return ComplexInf;
         } else {
-            return make_rcp<const Pow>(a, b);
+            return make_interned<Pow>(a, b);
         }
     }
 
@@ -133,14 +133,14 @@ RCP<const Basic> pow(const RCP<const Basic> &a, const RCP<const Basic> &b)
                     return down_cast<const Rational &>(*b).rpowrat(
                         down_cast<const Integer &>(*a));
                 } else if (is_a<Complex>(*a)) {
-                    return make_rcp<const Pow>(a, b);
+                    return make_interned<Pow>(a, b);
                 } else {
                     return down_cast<const Number &>(*a).pow(
                         *rcp_static_cast<const Number>(b));
                 }
             } else if (is_a<Complex>(*b)
                        and down_cast<const Number &>(*a).is_exact()) {
-                return make_rcp<const Pow>(a, b);
+                return make_interned<Pow>(a, b);
             } else {
                 return down_cast<const Number &>(*a).pow(
                     *rcp_static_cast<const Number>(b));
@@ -172,7 +172,7 @@ RCP<const Basic> pow(const RCP<const Basic> &a, const RCP<const Basic> &b)
         RCP<const Pow> A = rcp_static_cast<const Pow>(a);
         return pow(A->get_base(), neg(b));
     }
-    return make_rcp<const Pow>(a, b);
+    return make_interned<Pow>(a, b);
 }
 
 // This function can overflow, but it is fast.
@@ -268,6 +268,12 @@ vec_basic Pow::get_args() const
     return {base_, exp_};
 }
 
+bool Pow::for_each_arg(
+    const std::function<bool(const RCP<const Basic> &)> &f) const
+{
+    return f(base_) and f(exp_);
+}
+
 RCP<const Basic> exp(const RCP<const Basic> &x)
 {
     return pow(E, x);
@@ -45,6 +45,8 @@ public:
     }
 
     vec_basic get_args() const override;
+    bool for_each_arg(const std::function<bool(const RCP<const Basic> &)> &f)
+        const override;
 };
 
 //! \return Pow from `a` and `b`
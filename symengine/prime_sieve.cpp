@@ -5,10 +5,13 @@
 #include <version>
 #endif
 #include <cmath>
-#include <valarray>
+#include <cstdint>
 #include <algorithm>
 #include <vector>
 #include <iterator>
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+#include <mutex>
+#endif
 #ifdef HAVE_SYMENGINE_PRIMESIEVE
 #include <primesieve.hpp>
 #endif
@@ -22,8 +25,155 @@ static std::vector<unsigned> &sieve_primes()
     return primes;
 }
 
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+static std::mutex &sieve_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::atomic<bool> Sieve::_clear{true};
+std::atomic<unsigned> Sieve::_sieve_size{32 * 1024}; // 32K in bytes
+#else
 bool Sieve::_clear = true;
-unsigned Sieve::_sieve_size = 32 * 1024 * 8; // 32K in bits
+unsigned Sieve::_sieve_size = 32 * 1024; // 32K in bytes
+#endif
+
+namespace
+{
+
+// The residues modulo 30 that are coprime to 30. Bit `k` of byte `i` of a
+// segment starting at 30 * b0 stands for 30 * (b0 + i) + wheel[k].
+const unsigned wheel[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+// wheel_bit[r] is the `k` with wheel[k] == r, for r coprime to 30
+const unsigned char wheel_bit[30]
+    = {0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 2, 0, 3, 0,
+       0, 0, 4, 0, 5, 0, 0, 0, 6, 0, 0, 0, 0, 0, 7};
+
+const uint64_t max_prime_limit = 0xFFFFFFFFu;
+
+unsigned isqrt(uint64_t n)
+{
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (r * r > n)
+        r--;
+    while ((r + 1) * (r + 1) <= n)
+        r++;
+    return static_cast<unsigned>(r);
+}
+
+// Primes from 7 up to `limit` (which is small) by a plain sieve on the odd
+// numbers
+std::vector<unsigned> base_primes(unsigned limit)
+{
+    std::vector<unsigned> primes;
+    std::vector<bool> composite(limit / 2 + 1);
+    for (unsigned n = 3; n <= limit; n += 2) {
+        if (composite[n / 2])
+            continue;
+        if (n >= 7)
+            primes.push_back(n);
+        for (uint64_t m = uint64_t(n) * n; m <= limit; m += 2 * n)
+            composite[m / 2] = true;
+    }
+    return primes;
+}
+
+// Sieves the `nbytes` bytes of the wheel starting at byte `b0` with the
+// primes `base`, which must include all primes from 7 up to the square root
+// of the end of the segment. 2, 3 and 5 are not in the wheel.
+void sieve_segment(std::vector<unsigned char> &seg, uint64_t b0,
+                   size_t nbytes, const std::vector<unsigned> &base)
+{
+    seg.assign(nbytes, 0xFF);
+    if (b0 == 0)
+        seg[0] &= 0xFE; // 1 is not a prime
+    const uint64_t low = 30 * b0, high = 30 * (b0 + nbytes);
+    for (unsigned p : base) {
+        if (uint64_t(p) * p >= high)
+            break;
+        // The multiples p * q with q coprime to 30 and q in a fixed residue
+        // class modulo 30 are p bytes apart and share the same bit
+        const uint64_t q0 = std::max<uint64_t>(p, (low + p - 1) / p);
+        for (unsigned k = 0; k < 8; k++) {
+            const uint64_t q = q0 + (wheel[k] + 30 - q0 % 30) % 30;
+            const uint64_t m = p * q;
+            if (m >= high)
+                continue;
+            const unsigned char mask
+                = static_cast<unsigned char>(~(1u << wheel_bit[m % 30]));
+            for (uint64_t i = m / 30 - b0; i < nbytes; i += p)
+                seg[i] &= mask;
+        }
+    }
+}
+
+// Appends the primes of the sieved segment that lie in [lo, hi]
+void collect_primes(const std::vector<unsigned char> &seg, uint64_t b0,
+                    uint64_t lo, uint64_t hi, std::vector<unsigned> &out)
+{
+    for (size_t i = 0; i < seg.size(); i++) {
+        unsigned char bits = seg[i];
+        for (unsigned k = 0; bits != 0; k++, bits >>= 1) {
+            if (not(bits & 1))
+                continue;
+            const uint64_t n = 30 * (b0 + i) + wheel[k];
+            if (n >= lo and n <= hi)
+                out.push_back(static_cast<unsigned>(n));
+        }
+    }
+}
+
+// Appends all primes in [lo, hi] to `out`, in order, splitting the wheel
+// into segments of `seg_bytes` bytes that are sieved by `nthreads` threads
+void sieve_range(uint64_t lo, uint64_t hi, size_t seg_bytes, unsigned nthreads,
+                 std::vector<unsigned> &out)
+{
+    for (unsigned p : {2u, 3u, 5u})
+        if (p >= lo and p <= hi)
+            out.push_back(p);
+    if (hi < 7 or lo > hi)
+        return;
+    const std::vector<unsigned> base = base_primes(isqrt(hi));
+    const uint64_t b_begin = lo / 30, b_end = hi / 30 + 1;
+    const size_t nseg
+        = static_cast<size_t>((b_end - b_begin + seg_bytes - 1) / seg_bytes);
+    if (nseg == 1 or nthreads == 1) {
+        std::vector<unsigned char> seg;
+        for (uint64_t b0 = b_begin; b0 < b_end; b0 += seg_bytes) {
+            sieve_segment(seg, b0, std::min<uint64_t>(seg_bytes, b_end - b0),
+                          base);
+            collect_primes(seg, b0, lo, hi, out);
+        }
+        return;
+    }
+    // Each segment is sieved into its own list, the lists are joined in order
+    std::vector<std::vector<unsigned>> parts(nseg);
+    auto sieve_part = [&](size_t s) {
+        std::vector<unsigned char> seg;
+        const uint64_t b0 = b_begin + s * seg_bytes;
+        sieve_segment(seg, b0, std::min<uint64_t>(seg_bytes, b_end - b0),
+                      base);
+        collect_primes(seg, b0, lo, hi, parts[s]);
+    };
+    if (nthreads == 0) {
+#pragma omp parallel for schedule(dynamic)
+        for (size_t s = 0; s < nseg; s++)
+            sieve_part(s);
+    } else {
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+        for (size_t s = 0; s < nseg; s++)
+            sieve_part(s);
+    }
+    size_t total = out.size();
+    for (const auto &part : parts)
+        total += part.size();
+    out.reserve(total);
+    for (const auto &part : parts)
+        out.insert(out.end(), part.begin(), part.end());
+}
+
+} // namespace
 
 void Sieve::set_clear(bool clear)
 {
@@ -32,6 +182,9 @@ void Sieve::set_clear(bool clear)
 
 void Sieve::clear()
 {
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    std::lock_guard<std::mutex> lock(sieve_mutex());
+#endif
     std::vector<unsigned> &_primes = sieve_primes();
     _primes.erase(_primes.begin() + 10, _primes.end());
 }
@@ -41,100 +194,92 @@ void Sieve::set_sieve_size(unsigned size)
 #ifdef HAVE_SYMENGINE_PRIMESIEVE
     primesieve::set_sieve_size(size);
 #else
-    _sieve_size = size * 1024 * 8; // size in bits
+    _sieve_size = size * 1024; // size in bytes
 #endif
 }
 
-void Sieve::_extend(unsigned limit)
+void Sieve::generate_primes(std::vector<unsigned> &primes, unsigned limit,
+                            unsigned nthreads)
 {
-    std::vector<unsigned> &_primes = sieve_primes();
-#ifdef HAVE_SYMENGINE_PRIMESIEVE
-    if (_primes.back() < limit)
-        primesieve::generate_primes(_primes.back() + 1, limit, &_primes);
-#else
-    const unsigned sqrt_limit
-        = static_cast<unsigned>(std::floor(std::sqrt(limit)));
-    unsigned start = _primes.back() + 1;
-    if (limit <= start)
-        return;
-    if (sqrt_limit >= start) {
-        _extend(sqrt_limit);
-        start = _primes.back() + 1;
-    }
-
-    unsigned segment = _sieve_size;
-    std::valarray<bool> is_prime(segment);
-    for (; start <= limit; start += 2 * segment) {
-        unsigned finish = std::min(start + segment * 2 + 1, limit);
-        is_prime[std::slice(0, segment, 1)] = true;
-        // considering only odd integers. An odd number n corresponds to
-        // n-start/2 in the array.
-        for (unsigned index = 1; index < _primes.size()
-                                 and _primes[index] * _primes[index] <= finish;
-             ++index) {
-            unsigned n = _primes[index];
-            unsigned multiple = (start / n + 1) * n;
-            if (multiple % 2 == 0)
-                multiple += n;
-            if (multiple > finish)
-                continue;
-            std::slice sl = std::slice((multiple - start) / 2,
-                                       1 + (finish - multiple) / (2 * n), n);
-            // starting from n*n, all the odd multiples of n are marked not
-            // prime.
-            is_prime[sl] = false;
-        }
-        for (unsigned n = start + 1; n <= finish; n += 2) {
-            if (is_prime[(n - start) / 2])
-                _primes.push_back(n);
+    {
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+        std::lock_guard<std::mutex> lock(sieve_mutex());
+#endif
+        std::vector<unsigned> &_primes = sieve_primes();
+        if (_primes.back() >= limit) {
+            auto it = std::upper_bound(_primes.begin(), _primes.end(), limit);
+            primes.insert(primes.end(), _primes.begin(), it);
+            return;
         }
     }
+    // The cache is too short: sieve without holding the lock, so that other
+    // threads can keep reading the cache meanwhile
+    std::vector<unsigned> fresh;
+#ifdef HAVE_SYMENGINE_PRIMESIEVE
+    primesieve::generate_primes(limit, &fresh);
+#else
+    sieve_range(0, limit, _sieve_size, nthreads, fresh);
 #endif
-}
-
-void Sieve::generate_primes(std::vector<unsigned> &primes, unsigned limit)
-{
-    _extend(limit);
-    std::vector<unsigned> &_primes = sieve_primes();
-    auto it = std::upper_bound(_primes.begin(), _primes.end(), limit);
-    // find the first position greater than limit and reserve space for the
-    // primes
-    primes.reserve(it - _primes.begin());
-    std::copy(_primes.begin(), it, std::back_inserter(primes));
-    if (_clear)
-        clear();
+    if (not _clear) {
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+        std::lock_guard<std::mutex> lock(sieve_mutex());
+#endif
+        std::vector<unsigned> &_primes = sieve_primes();
+        if (_primes.back() < fresh.back())
+            _primes = fresh;
+    }
+    if (primes.empty())
+        primes.swap(fresh);
+    else
+        primes.insert(primes.end(), fresh.begin(), fresh.end());
 }
 
 Sieve::iterator::iterator(unsigned max)
+    : _index(0), _limit(max), _low(0), _bytes(64), _base_limit(0)
 {
-    _limit = max;
-    _index = 0;
 }
 
-Sieve::iterator::iterator()
-{
-    _limit = 0;
-    _index = 0;
-}
+Sieve::iterator::iterator() : iterator(0) {}
+
+Sieve::iterator::~iterator() {}
 
-Sieve::iterator::~iterator()
+bool Sieve::iterator::_next_segment()
 {
-    if (_clear)
-        Sieve::clear();
+    const uint64_t hi = _limit > 0 ? _limit : max_prime_limit;
+    if (_low > hi)
+        return false;
+    const uint64_t b0 = _low / 30;
+    const uint64_t nbytes = std::min<uint64_t>(_bytes, hi / 30 - b0 + 1);
+    const uint64_t high = std::min<uint64_t>(30 * (b0 + nbytes) - 1, hi);
+    _primes.clear();
+    _index = 0;
+#ifdef HAVE_SYMENGINE_PRIMESIEVE
+    primesieve::generate_primes(_low, high, &_primes);
+#else
+    if (isqrt(high) > _base_limit) {
+        // Leave room for a few more segments before sieving the base again
+        _base_limit = static_cast<unsigned>(
+            std::min<uint64_t>(2 * uint64_t(isqrt(high)), isqrt(hi)));
+        _base = base_primes(_base_limit);
+    }
+    if (b0 == 0)
+        for (unsigned p : {2u, 3u, 5u})
+            if (p <= hi)
+                _primes.push_back(p);
+    std::vector<unsigned char> seg;
+    sieve_segment(seg, b0, static_cast<size_t>(nbytes), _base);
+    collect_primes(seg, b0, _low, high, _primes);
+#endif
+    _low = 30 * (b0 + nbytes);
+    _bytes = std::min<unsigned>(2 * _bytes, _sieve_size);
+    return true;
 }
 
 unsigned Sieve::iterator::next_prime()
 {
-    std::vector<unsigned> &_primes = sieve_primes();
-    if (_index >= _primes.size()) {
-        unsigned extend_to = _primes[_index - 1] * 2;
-        if (_limit > 0 and _limit < extend_to) {
-            extend_to = _limit;
-        }
-        _extend(extend_to);
-        if (_index >= _primes.size()) { // the next prime is greater than _limit
+    while (_index >= _primes.size()) {
+        if (not _next_segment()) // the next prime is greater than _limit
             return _limit + 1;
-        }
     }
     return _primes[_index++];
 }
@@ -3,15 +3,18 @@
 
 #include <vector>
 #include <symengine/symengine_config.h>
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+#include <atomic>
+#endif
 
-// Sieve class stores all the primes upto a limit. When a prime or a list of
-// prime
-// is requested, if the prime is not there in the sieve, it is extended to hold
-// that
-// prime. The implementation is a very basic Eratosthenes sieve, but the code
-// should
-// be quite optimized. For limit=1e8, it is about 20x slower than the
-// `primesieve` library (1206ms vs 55.63ms).
+// Sieve class generates primes with a segmented sieve of Eratosthenes.
+// Numbers are stored in a mod 30 wheel, one bit for each of the 8 residues
+// coprime to 30, so a byte covers 30 integers and a segment of the default
+// 32K (the L1d cache size on most CPUs) covers about a million of them.
+// `generate_primes` sieves the segments in parallel when built with OpenMP
+// and keeps the primes in a cache shared by all threads (if `set_clear(false)`
+// is used). Iterators sieve their own segments and are independent of each
+// other and of the cache, so they can be used concurrently.
 
 namespace SymEngine
 {
@@ -20,16 +23,22 @@ class Sieve
 {
 
 private:
-    static void _extend(unsigned limit);
+#ifdef WITH_SYMENGINE_THREAD_SAFE
+    static std::atomic<unsigned> _sieve_size;
+    static std::atomic<bool> _clear;
+#else
     static unsigned _sieve_size;
     static bool _clear;
+#endif
 
 public:
     // Returns all primes up to the `limit` (including). The vector `primes`
-    // should
-    // be empty on input and it will be filled with the primes.
+    // should be empty on input and it will be filled with the primes. The
+    // segments are split between `nthreads` OpenMP threads (`0` uses the
+    // OpenMP default); without `WITH_OPENMP` they are sieved serially.
     //! \param primes: holds all primes up to the `limit` (including).
-    static void generate_primes(std::vector<unsigned> &primes, unsigned limit);
+    static void generate_primes(std::vector<unsigned> &primes, unsigned limit,
+                                unsigned nthreads = 0);
     // Clear the array of primes stored
     static void clear();
     // Set the sieve size in kilobytes. Set it to L1d cache size for best
@@ -46,6 +55,19 @@ public:
     private:
         unsigned _index;
         unsigned _limit;
+        // Primes of the last sieved segment
+        std::vector<unsigned> _primes;
+        // Start of the next segment
+        unsigned long long _low;
+        // Size of the next segment in bytes of the wheel, doubled up to the
+        // sieve size so that small limits only sieve a little
+        unsigned _bytes;
+        // Primes from 7 up to `_base_limit`, which is at least the square
+        // root of the end of the last segment
+        std::vector<unsigned> _base;
+        unsigned _base_limit;
+
+        bool _next_segment();
 
     public:
         // Iterator that generates primes upto limit
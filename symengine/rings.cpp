@@ -73,6 +73,31 @@ void poly_mul(const umap_vec_mpz &A, const umap_vec_mpz &B, umap_vec_mpz &C)
     vec_int exp;
     auto n = A.begin()->first.size();
     exp.assign(n, 0); // Initialize to [0]*n
+
+    // If all exponents of the product fit into one word, multiply the packed
+    // monomials, which doesn't allocate a vector per term
+    long long max_a = max_exponent(A), max_b = max_exponent(B);
+    if (max_a >= 0 and max_b >= 0) {
+        MonomialPacker packer(n, max_a + max_b);
+        std::vector<std::pair<packed_monomial, const integer_class *>> pa, pb;
+        if (packer.is_valid() and pack_terms(A, packer, pa)
+            and pack_terms(B, packer, pb)) {
+            PackedMonomialMap<integer_class> P(std::max(pa.size(), pb.size()));
+            packed_monomial m;
+            for (const auto &a : pa) {
+                for (const auto &b : pb) {
+                    packer.mul(a.first, b.first, m);
+                    mp_addmul(P[m], *a.second, *b.second);
+                }
+            }
+            P.for_each([&](packed_monomial m, const integer_class &c) {
+                packer.unpack(m, exp);
+                C[exp] += c;
+            });
+            return;
+        }
+    }
+
     /*
     std::cout << "A: " << A.load_factor() << " " << A.bucket_count() << " " <<
     A.size() << " "
@@ -0,0 +1,578 @@
+/**
+ *  \file serialize-compact.h
+ *  A compact binary serialization format for Basic
+ *
+ *  The format uses the `save_basic` and `load_basic` functions of
+ *  `serialize-cereal.h`, with a different archive:
+ *   - integral values are written as varints, so that small numbers take a
+ *     single byte,
+ *   - integers are written as a varint if they are small, or as the bytes of
+ *     their magnitude otherwise, instead of as decimal strings,
+ *   - each node is written once, and referred to by its index afterwards.
+ *     Nodes are looked up by their structure, so that equal nodes are shared
+ *     even if they are different objects,
+ *   - the names of symbols and functions are written once, and referred to by
+ *     their index afterwards.
+ *
+ *  A payload starts with `compact_serialization_magic`, followed by the version
+ *  of the format and the version of SymEngine.
+ **/
+
+#ifndef SYMENGINE_SERIALIZE_COMPACT_H
+#define SYMENGINE_SERIALIZE_COMPACT_H
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <symengine/serialize-cereal.h>
+
+namespace SymEngine
+{
+
+//! The first bytes of a payload in the compact format
+const char compact_serialization_magic[] = "SEC";
+//! The version of the compact format, incremented when it changes
+const unsigned compact_serialization_version = 1;
+
+//! \return true if `data` starts like a payload in the compact format
+inline bool is_compact_serialization(const std::string &data)
+{
+    const size_t n = sizeof(compact_serialization_magic) - 1;
+    return data.size() >= n
+           and data.compare(0, n, compact_serialization_magic) == 0;
+}
+
+class CompactBinaryOutputArchive
+    : public cereal::OutputArchive<CompactBinaryOutputArchive,
+                                   cereal::AllowEmptyClassElision>
+{
+public:
+    CompactBinaryOutputArchive(std::ostream &stream)
+        : cereal::OutputArchive<CompactBinaryOutputArchive,
+                                cereal::AllowEmptyClassElision>(this),
+          stream_(stream)
+    {
+    }
+
+    void saveBinary(const void *data, std::streamsize size)
+    {
+        auto written = stream_.rdbuf()->sputn(
+            reinterpret_cast<const char *>(data), size);
+        if (written != size) {
+            throw SerializationError("Failed to write to the output stream");
+        }
+    }
+
+    //! Writes `v` in 7 bit groups, least significant first
+    void save_varint(uint64_t v)
+    {
+        unsigned char buf[10];
+        int n = 0;
+        while (v >= 0x80) {
+            buf[n++] = static_cast<unsigned char>((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        buf[n++] = static_cast<unsigned char>(v);
+        saveBinary(buf, n);
+    }
+
+    /*! Integers that fit in 62 bits are written as a single varint, whose
+        lowest bit is 0. Other integers are written as a varint holding the
+        number of bytes of their magnitude, their sign and a lowest bit of 1,
+        followed by the bytes of their magnitude, least significant first.
+     */
+    void save_integer(const integer_class &i)
+    {
+        const int64_t limit = int64_t(1) << 62;
+        if (mp_fits_slong_p(i)) {
+            int64_t v = mp_get_si(i);
+            if (v >= -limit and v < limit) {
+                uint64_t zigzag = (static_cast<uint64_t>(v) << 1)
+                                  ^ static_cast<uint64_t>(v >> 63);
+                save_varint(zigzag << 1);
+                return;
+            }
+        }
+        std::vector<unsigned char> bytes;
+#if SYMENGINE_INTEGER_CLASS == SYMENGINE_GMP                                   \
+    or SYMENGINE_INTEGER_CLASS == SYMENGINE_GMPXX
+        size_t count = (mpz_sizeinbase(get_mpz_t(i), 2) + 7) / 8;
+        bytes.resize(count);
+        mpz_export(bytes.data(), &count, -1, 1, 0, 0, get_mpz_t(i));
+        bytes.resize(count);
+#else
+        integer_class a = mp_abs(i), q, r;
+        const integer_class base(256);
+        while (a != 0) {
+            mp_tdiv_qr(q, r, a, base);
+            bytes.push_back(static_cast<unsigned char>(mp_get_ui(r)));
+            a = q;
+        }
+#endif
+        uint64_t negative = i < 0 ? 1 : 0;
+        save_varint((static_cast<uint64_t>(bytes.size()) << 2)
+                    | (negative << 1) | 1);
+        saveBinary(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+private:
+    std::ostream &stream_;
+};
+
+class CompactBinaryInputArchive
+    : public cereal::InputArchive<CompactBinaryInputArchive,
+                                  cereal::AllowEmptyClassElision>
+{
+public:
+    CompactBinaryInputArchive(std::istream &stream)
+        : cereal::InputArchive<CompactBinaryInputArchive,
+                               cereal::AllowEmptyClassElision>(this),
+          stream_(stream)
+    {
+    }
+
+    void loadBinary(void *const data, std::streamsize size)
+    {
+        auto read
+            = stream_.rdbuf()->sgetn(reinterpret_cast<char *>(data), size);
+        if (read != size) {
+            throw SerializationError("Unexpected end of the input");
+        }
+    }
+
+    uint64_t load_varint()
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            auto c = stream_.rdbuf()->sbumpc();
+            if (c == std::char_traits<char>::eof()) {
+                throw SerializationError("Unexpected end of the input");
+            }
+            if (shift == 63 and (c & 0x7e) != 0) {
+                break;
+            }
+            v |= static_cast<uint64_t>(c & 0x7f) << shift;
+            if ((c & 0x80) == 0) {
+                return v;
+            }
+        }
+        throw SerializationError("Invalid varint");
+    }
+
+    void load_integer(integer_class &i)
+    {
+        uint64_t h = load_varint();
+        if ((h & 1) == 0) {
+            uint64_t zigzag = h >> 1;
+            int64_t v = static_cast<int64_t>(zigzag >> 1)
+                        ^ -static_cast<int64_t>(zigzag & 1);
+            if (v >= std::numeric_limits<long>::min()
+                and v <= std::numeric_limits<long>::max()) {
+                i = integer_class(static_cast<long>(v));
+                return;
+            }
+            // `long` is 32 bits wide
+            uint64_t a = v < 0 ? 0 - static_cast<uint64_t>(v)
+                               : static_cast<uint64_t>(v);
+            std::vector<unsigned char> bytes;
+            for (; a != 0; a >>= 8) {
+                bytes.push_back(static_cast<unsigned char>(a & 0xff));
+            }
+            set_magnitude(i, bytes, v < 0);
+            return;
+        }
+        uint64_t size = h >> 2;
+        // Read in chunks, so that a corrupted size fails at the end of the
+        // input instead of allocating it all at once
+        std::vector<unsigned char> bytes;
+        while (bytes.size() < size) {
+            size_t n = static_cast<size_t>(
+                std::min<uint64_t>(size - bytes.size(), 1 << 16));
+            bytes.resize(bytes.size() + n);
+            loadBinary(&bytes[bytes.size() - n],
+                       static_cast<std::streamsize>(n));
+        }
+        set_magnitude(i, bytes, (h & 2) != 0);
+    }
+
+private:
+    std::istream &stream_;
+
+    static void set_magnitude(integer_class &i,
+                              const std::vector<unsigned char> &bytes,
+                              bool negative)
+    {
+#if SYMENGINE_INTEGER_CLASS == SYMENGINE_GMP                                   \
+    or SYMENGINE_INTEGER_CLASS == SYMENGINE_GMPXX
+        mpz_import(get_mpz_t(i), bytes.size(), -1, 1, 0, 0, bytes.data());
+#else
+        i = 0;
+        for (auto it = bytes.rbegin(); it != bytes.rend(); ++it) {
+            i = i * 256 + *it;
+        }
+#endif
+        if (negative) {
+            i = -i;
+        }
+    }
+};
+
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value
+                               and std::is_unsigned<T>::value>::type
+CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive &ar, const T &t)
+{
+    ar.save_varint(t);
+}
+
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value
+                               and std::is_signed<T>::value>::type
+CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive &ar, const T &t)
+{
+    int64_t v = t;
+    ar.save_varint((static_cast<uint64_t>(v) << 1)
+                   ^ static_cast<uint64_t>(v >> 63));
+}
+
+//! Floating point values are written as is, in little endian order
+template <class T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive &ar, const T &t)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &t, sizeof(T));
+    if (not cereal::portable_binary_detail::is_little_endian()) {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+    ar.saveBinary(bytes, sizeof(T));
+}
+
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value
+                               and std::is_unsigned<T>::value>::type
+CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive &ar, T &t)
+{
+    uint64_t v = ar.load_varint();
+    if (v > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+        throw SerializationError("Integer out of range");
+    }
+    t = static_cast<T>(v);
+}
+
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value
+                               and std::is_signed<T>::value>::type
+CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive &ar, T &t)
+{
+    uint64_t zigzag = ar.load_varint();
+    int64_t v
+        = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    if (v < std::numeric_limits<T>::min()
+        or v > std::numeric_limits<T>::max()) {
+        throw SerializationError("Integer out of range");
+    }
+    t = static_cast<T>(v);
+}
+
+template <class T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive &ar, T &t)
+{
+    unsigned char bytes[sizeof(T)];
+    ar.loadBinary(bytes, sizeof(T));
+    if (not cereal::portable_binary_detail::is_little_endian()) {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+    std::memcpy(&t, bytes, sizeof(T));
+}
+
+template <class Archive, class T>
+inline CEREAL_ARCHIVE_RESTRICT(CompactBinaryInputArchive,
+                               CompactBinaryOutputArchive)
+    CEREAL_SERIALIZE_FUNCTION_NAME(Archive &ar, cereal::NameValuePair<T> &t)
+{
+    ar(t.value);
+}
+
+template <class Archive, class T>
+inline CEREAL_ARCHIVE_RESTRICT(CompactBinaryInputArchive,
+                               CompactBinaryOutputArchive)
+    CEREAL_SERIALIZE_FUNCTION_NAME(Archive &ar, cereal::SizeTag<T> &t)
+{
+    ar(t.size);
+}
+
+template <class T>
+inline void CEREAL_SAVE_FUNCTION_NAME(CompactBinaryOutputArchive &ar,
+                                      const cereal::BinaryData<T> &bd)
+{
+    ar.saveBinary(bd.data, static_cast<std::streamsize>(bd.size));
+}
+
+template <class T>
+inline void CEREAL_LOAD_FUNCTION_NAME(CompactBinaryInputArchive &ar,
+                                      cereal::BinaryData<T> &bd)
+{
+    ar.loadBinary(bd.data, static_cast<std::streamsize>(bd.size));
+}
+
+//! Writes the nodes of the compact format, see `serialize-compact.h`
+template <>
+class RCPBasicAwareOutputArchive<CompactBinaryOutputArchive>
+    : public CompactBinaryOutputArchive
+{
+    using CompactBinaryOutputArchive::CompactBinaryOutputArchive;
+
+public:
+    //! Writes the magic and the versions
+    void save_header();
+    void save_rcp_basic(const RCP<const Basic> &ptr);
+    //! Writes `s`, or its index if it was already written
+    void save_string(const std::string &s);
+
+private:
+    //! Indices of the nodes written so far
+    std::unordered_map<RCP<const Basic>, uint64_t, RCPBasicHash, RCPBasicKeyEq>
+        nodes_;
+    uint64_t num_nodes_ = 0;
+    std::unordered_map<std::string, uint64_t> strings_;
+    //! Overload the rtti function to enable dynamic_cast
+    void rtti(){};
+};
+
+//! Reads the nodes of the compact format, see `serialize-compact.h`
+template <>
+class RCPBasicAwareInputArchive<CompactBinaryInputArchive>
+    : public CompactBinaryInputArchive
+{
+    using CompactBinaryInputArchive::CompactBinaryInputArchive;
+
+public:
+    //! Reads and checks the magic and the versions
+    void load_header();
+    template <class T>
+    RCP<const T> load_rcp_basic();
+    std::string load_string();
+
+private:
+    vec_basic nodes_;
+    std::vector<std::string> strings_;
+    //! Overload the rtti function to enable dynamic_cast
+    void rtti(){};
+};
+
+typedef RCPBasicAwareOutputArchive<CompactBinaryOutputArchive>
+    CompactOutputArchive;
+typedef RCPBasicAwareInputArchive<CompactBinaryInputArchive>
+    CompactInputArchive;
+
+// The functions below are more specialized than the generic ones of
+// `serialize-cereal.h`, so they are picked for the compact archives.
+
+inline void save_basic(CompactOutputArchive &ar, const Integer &b)
+{
+    ar.save_integer(b.as_integer_class());
+}
+inline void save_helper(CompactOutputArchive &ar, const integer_class &intgr)
+{
+    ar.save_integer(intgr);
+}
+inline void save_basic(CompactOutputArchive &ar, const Symbol &b)
+{
+    ar.save_string(b.get_name());
+}
+inline void save_basic(CompactOutputArchive &ar, const Dummy &b)
+{
+    ar.save_string(b.get_name());
+    ar(b.get_index());
+}
+inline void save_basic(CompactOutputArchive &ar, const Constant &b)
+{
+    ar.save_string(b.get_name());
+}
+inline void save_basic(CompactOutputArchive &ar, const FunctionSymbol &b)
+{
+    ar.save_string(b.get_name());
+    ar(b.get_args());
+}
+
+inline RCP<const Basic> load_basic(CompactInputArchive &ar,
+                                   RCP<const Integer> &)
+{
+    integer_class i;
+    ar.load_integer(i);
+    return integer(std::move(i));
+}
+inline void load_helper(CompactInputArchive &ar, integer_class &intgr)
+{
+    ar.load_integer(intgr);
+}
+inline RCP<const Basic> load_basic(CompactInputArchive &ar, RCP<const Symbol> &)
+{
+    return symbol(ar.load_string());
+}
+inline RCP<const Basic> load_basic(CompactInputArchive &ar, RCP<const Dummy> &)
+{
+    std::string name = ar.load_string();
+    size_t index;
+    ar(index);
+    return dummy(name, index);
+}
+inline RCP<const Basic> load_basic(CompactInputArchive &ar,
+                                   RCP<const Constant> &)
+{
+    return constant(ar.load_string());
+}
+inline RCP<const Basic> load_basic(CompactInputArchive &ar,
+                                   RCP<const FunctionSymbol> &)
+{
+    std::string name = ar.load_string();
+    vec_basic vec;
+    ar(vec);
+    return make_rcp<const FunctionSymbol>(name, std::move(vec));
+}
+
+inline void CompactOutputArchive::save_header()
+{
+    saveBinary(compact_serialization_magic,
+               sizeof(compact_serialization_magic) - 1);
+    save_varint(compact_serialization_version);
+    save_varint(SYMENGINE_MAJOR_VERSION);
+    save_varint(SYMENGINE_MINOR_VERSION);
+}
+
+/*! A node is written as 0 followed by its type and its data the first time,
+    and as one plus its index afterwards. The indices are given in the order
+    in which the nodes are finished, so that the children of a node come
+    first. Inexact numbers are always written, since they can be equal without
+    being the same (e.g. `0.0` and `-0.0`).
+ */
+inline void CompactOutputArchive::save_rcp_basic(const RCP<const Basic> &ptr)
+{
+    const bool shared = not is_a_Number(*ptr)
+                        or down_cast<const Number &>(*ptr).is_exact();
+    if (shared) {
+        auto it = nodes_.find(ptr);
+        if (it != nodes_.end()) {
+            save_varint(it->second + 1);
+            return;
+        }
+    }
+    save_varint(0);
+    TypeID type_code = ptr->get_type_code();
+    save_typeid(*this, type_code);
+    switch (type_code) {
+#define SYMENGINE_ENUM(type, Class)                                            \
+    case type:                                                                 \
+        save_basic(*this, static_cast<const Class &>(*ptr));                   \
+        break;
+#include "symengine/type_codes.inc"
+#undef SYMENGINE_ENUM
+        default:
+            save_basic(*this, *ptr);
+    }
+    if (shared) {
+        nodes_.insert({ptr, num_nodes_});
+    }
+    num_nodes_++;
+}
+
+inline void CompactOutputArchive::save_string(const std::string &s)
+{
+    auto it = strings_.find(s);
+    if (it != strings_.end()) {
+        save_varint(it->second + 1);
+        return;
+    }
+    save_varint(0);
+    (*this)(s);
+    uint64_t index = strings_.size();
+    strings_.insert({s, index});
+}
+
+inline void CompactInputArchive::load_header()
+{
+    char magic[sizeof(compact_serialization_magic) - 1];
+    loadBinary(magic, sizeof(magic));
+    if (std::memcmp(magic, compact_serialization_magic, sizeof(magic)) != 0) {
+        throw SerializationError("Not in the compact serialization format");
+    }
+    uint64_t version = load_varint();
+    if (version != compact_serialization_version) {
+        throw SerializationError(StreamFmt()
+                                 << "Unsupported compact serialization format "
+                                 << "version " << version);
+    }
+    uint64_t major = load_varint(), minor = load_varint();
+    if (major != SYMENGINE_MAJOR_VERSION or minor != SYMENGINE_MINOR_VERSION) {
+        throw SerializationError(StreamFmt()
+                                 << "SymEngine-" << SYMENGINE_MAJOR_VERSION
+                                 << "." << SYMENGINE_MINOR_VERSION
+                                 << " was asked to deserialize an object "
+                                 << "created using SymEngine-" << major << "."
+                                 << minor << ".");
+    }
+}
+
+template <class T>
+RCP<const T> CompactInputArchive::load_rcp_basic()
+{
+    RCP<const Basic> b;
+    try {
+        uint64_t ref = load_varint();
+        if (ref != 0) {
+            if (ref > nodes_.size()) {
+                throw SerializationError("Invalid shared pointer");
+            }
+            b = nodes_[ref - 1];
+        } else {
+            TypeID type_code;
+            load_typeid(*this, type_code);
+            switch (type_code) {
+#define SYMENGINE_ENUM(type_enum, Class)                                       \
+    case type_enum: {                                                          \
+        RCP<const Class> dummy_ptr;                                            \
+        b = load_basic(*this, dummy_ptr);                                      \
+        break;                                                                 \
+    }
+#include "symengine/type_codes.inc"
+#undef SYMENGINE_ENUM
+                default:
+                    throw SerializationError("Unknown typeID");
+            }
+            nodes_.push_back(b);
+        }
+    } catch (cereal::Exception &e) {
+        throw SerializationError(e.what());
+    }
+    if (dynamic_cast<const T *>(b.get()) == nullptr) {
+        throw SerializationError("Cannot convert to given type");
+    }
+    return rcp_static_cast<const T>(b);
+}
+
+inline std::string CompactInputArchive::load_string()
+{
+    uint64_t ref = load_varint();
+    if (ref != 0) {
+        if (ref > strings_.size()) {
+            throw SerializationError("Invalid string index");
+        }
+        return strings_[ref - 1];
+    }
+    std::string s;
+    (*this)(s);
+    strings_.push_back(s);
+    return s;
+}
+
+} // namespace SymEngine
+
+CEREAL_REGISTER_ARCHIVE(SymEngine::CompactBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(SymEngine::CompactBinaryInputArchive)
+CEREAL_SETUP_ARCHIVE_TRAITS(SymEngine::CompactBinaryInputArchive,
+                            SymEngine::CompactBinaryOutputArchive)
+
+#endif // SYMENGINE_SERIALIZE_COMPACT_H
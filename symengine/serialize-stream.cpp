@@ -0,0 +1,473 @@
+#include <symengine/serialize-stream.h>
+#include <symengine/symengine_exception.h>
+#if HAVE_SYMENGINE_RTTI
+#include <symengine/serialize-compact.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SYMENGINE_POSIX_IO
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SymEngine
+{
+
+#if HAVE_SYMENGINE_RTTI
+
+namespace
+{
+
+#ifdef SYMENGINE_POSIX_IO
+//! Buffers the bytes written to a file descriptor
+class FdOutputBuffer : public std::streambuf
+{
+public:
+    explicit FdOutputBuffer(int fd) : fd_(fd), buffer_(1 << 16)
+    {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+    ~FdOutputBuffer() override
+    {
+        write_buffer();
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (write_buffer() != 0) {
+            return traits_type::eof();
+        }
+        if (not traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override
+    {
+        return write_buffer();
+    }
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+
+    int write_buffer()
+    {
+        const char *p = pbase();
+        size_t n = pptr() - pbase();
+        while (n > 0) {
+            ssize_t written = ::write(fd_, p, n);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                return -1;
+            }
+            p += written;
+            n -= written;
+        }
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+        return 0;
+    }
+};
+
+//! Buffers the bytes read from a file descriptor
+class FdInputBuffer : public std::streambuf
+{
+public:
+    explicit FdInputBuffer(int fd) : fd_(fd), buffer_(1 << 16)
+    {
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        ssize_t n;
+        do {
+            n = ::read(fd_, buffer_.data(), buffer_.size());
+        } while (n < 0 and errno == EINTR);
+        if (n <= 0) {
+            return traits_type::eof();
+        }
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + n);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+};
+
+//! Reads a file through a read only memory map
+class MappedFileBuffer : public std::streambuf
+{
+public:
+    explicit MappedFileBuffer(const std::string &filename)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw SerializationError("Cannot open " + filename);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw SerializationError("Cannot read the size of " + filename);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw SerializationError("Cannot map " + filename);
+            }
+            data_ = static_cast<char *>(p);
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        setg(data_, data_, data_ + size_);
+    }
+    ~MappedFileBuffer() override
+    {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    //! Drops the pages before the current position from memory. They are read
+    //! from the file again if needed.
+    void release_read_pages()
+    {
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t end = static_cast<size_t>(gptr() - data_) / page * page;
+        if (end > released_) {
+            ::madvise(data_ + released_, end - released_, MADV_DONTNEED);
+            released_ = end;
+        }
+    }
+
+private:
+    char *data_ = nullptr;
+    size_t size_ = 0;
+    size_t released_ = 0;
+};
+#endif
+
+} // namespace
+
+class SerializationWriter::Impl
+{
+public:
+    explicit Impl(std::ostream &os) : os_(os), ar_(os)
+    {
+        ar_.save_header();
+    }
+    explicit Impl(std::unique_ptr<std::streambuf> buffer)
+        : buffer_(std::move(buffer)),
+          own_stream_(new std::ostream(buffer_.get())),
+          os_(*own_stream_), ar_(*own_stream_)
+    {
+        ar_.save_header();
+    }
+
+    std::unique_ptr<std::streambuf> buffer_;
+    std::unique_ptr<std::ostream> own_stream_;
+    std::ostream &os_;
+    CompactOutputArchive ar_;
+};
+
+SerializationWriter::SerializationWriter(std::ostream &os)
+    : impl_(new Impl(os))
+{
+}
+
+SerializationWriter::SerializationWriter(int fd)
+{
+#ifdef SYMENGINE_POSIX_IO
+    impl_.reset(
+        new Impl(std::unique_ptr<std::streambuf>(new FdOutputBuffer(fd))));
+#else
+    throw NotImplementedError(
+        "Writing to a file descriptor is not supported on this platform");
+#endif
+}
+
+SerializationWriter::~SerializationWriter()
+{
+    if (impl_) {
+        impl_->os_.rdbuf()->pubsync();
+    }
+}
+
+void SerializationWriter::write(const RCP<const Basic> &b)
+{
+    impl_->ar_.save_varint(
+        static_cast<uint64_t>(SerializationReader::Kind::Expression));
+    impl_->ar_.save_rcp_basic(b);
+}
+
+void SerializationWriter::write(const vec_basic &v)
+{
+    impl_->ar_.save_varint(
+        static_cast<uint64_t>(SerializationReader::Kind::Vector));
+    impl_->ar_.save_varint(v.size());
+    for (const auto &b : v) {
+        impl_->ar_.save_rcp_basic(b);
+    }
+}
+
+void SerializationWriter::write(const DenseMatrix &m)
+{
+    impl_->ar_.save_varint(
+        static_cast<uint64_t>(SerializationReader::Kind::Matrix));
+    impl_->ar_.save_varint(m.nrows());
+    impl_->ar_.save_varint(m.ncols());
+    for (unsigned i = 0; i < m.nrows(); i++) {
+        for (unsigned j = 0; j < m.ncols(); j++) {
+            impl_->ar_.save_rcp_basic(m.get(i, j));
+        }
+    }
+}
+
+void SerializationWriter::flush()
+{
+    if (impl_->os_.rdbuf()->pubsync() != 0) {
+        throw SerializationError("Failed to write to the output stream");
+    }
+}
+
+class SerializationReader::Impl
+{
+public:
+    explicit Impl(std::istream &is) : is_(is), ar_(is)
+    {
+        ar_.load_header();
+    }
+    explicit Impl(std::unique_ptr<std::streambuf> buffer)
+        : buffer_(std::move(buffer)),
+          own_stream_(new std::istream(buffer_.get())),
+          is_(*own_stream_), ar_(*own_stream_)
+    {
+        ar_.load_header();
+    }
+
+    //! Checks the kind of the next object, and consumes it
+    void expect(Kind kind)
+    {
+        if (kind_ == 0) {
+            read_kind();
+        }
+        if (kind_ != static_cast<uint64_t>(kind)) {
+            throw SerializationError("Unexpected kind of object");
+        }
+        kind_ = 0;
+    }
+
+    void read_kind()
+    {
+        kind_ = ar_.load_varint();
+        if (kind_ < static_cast<uint64_t>(Kind::Expression)
+            or kind_ > static_cast<uint64_t>(Kind::Matrix)) {
+            throw SerializationError("Unknown kind of object");
+        }
+    }
+
+    //! Called after each object
+    void done()
+    {
+#ifdef SYMENGINE_POSIX_IO
+        if (mapped_ != nullptr) {
+            mapped_->release_read_pages();
+        }
+#endif
+    }
+
+    std::unique_ptr<std::streambuf> buffer_;
+    std::unique_ptr<std::istream> own_stream_;
+    std::istream &is_;
+    CompactInputArchive ar_;
+    //! The kind of the next object if it was read already, 0 otherwise
+    uint64_t kind_ = 0;
+#ifdef SYMENGINE_POSIX_IO
+    MappedFileBuffer *mapped_ = nullptr;
+#endif
+};
+
+SerializationReader::SerializationReader(std::istream &is)
+    : impl_(new Impl(is))
+{
+}
+
+SerializationReader::SerializationReader(int fd)
+{
+#ifdef SYMENGINE_POSIX_IO
+    impl_.reset(
+        new Impl(std::unique_ptr<std::streambuf>(new FdInputBuffer(fd))));
+#else
+    throw NotImplementedError(
+        "Reading from a file descriptor is not supported on this platform");
+#endif
+}
+
+SerializationReader::SerializationReader(const std::string &filename)
+{
+#ifdef SYMENGINE_POSIX_IO
+    MappedFileBuffer *mapped = new MappedFileBuffer(filename);
+    impl_.reset(new Impl(std::unique_ptr<std::streambuf>(mapped)));
+    impl_->mapped_ = mapped;
+#else
+    std::unique_ptr<std::filebuf> buffer(new std::filebuf());
+    if (buffer->open(filename, std::ios::in | std::ios::binary) == nullptr) {
+        throw SerializationError("Cannot open " + filename);
+    }
+    impl_.reset(new Impl(std::move(buffer)));
+#endif
+}
+
+SerializationReader::~SerializationReader() = default;
+
+bool SerializationReader::at_end()
+{
+    return impl_->kind_ == 0
+           and impl_->is_.rdbuf()->sgetc() == std::char_traits<char>::eof();
+}
+
+SerializationReader::Kind SerializationReader::next_kind()
+{
+    if (impl_->kind_ == 0) {
+        impl_->read_kind();
+    }
+    return static_cast<Kind>(impl_->kind_);
+}
+
+RCP<const Basic> SerializationReader::read_basic()
+{
+    impl_->expect(Kind::Expression);
+    RCP<const Basic> b = impl_->ar_.load_rcp_basic<Basic>();
+    impl_->done();
+    return b;
+}
+
+vec_basic SerializationReader::read_vec()
+{
+    impl_->expect(Kind::Vector);
+    uint64_t size = impl_->ar_.load_varint();
+    vec_basic v;
+    // The size is not trusted for the allocation, since the input may be
+    // corrupted
+    v.reserve(static_cast<size_t>(std::min<uint64_t>(size, 1 << 16)));
+    for (uint64_t i = 0; i < size; i++) {
+        v.push_back(impl_->ar_.load_rcp_basic<Basic>());
+    }
+    impl_->done();
+    return v;
+}
+
+DenseMatrix SerializationReader::read_matrix()
+{
+    impl_->expect(Kind::Matrix);
+    uint64_t row = impl_->ar_.load_varint(), col = impl_->ar_.load_varint();
+    if (row > std::numeric_limits<unsigned>::max()
+        or col > std::numeric_limits<unsigned>::max()
+        or row * col > std::numeric_limits<unsigned>::max()) {
+        throw SerializationError("Matrix too large");
+    }
+    vec_basic v;
+    v.reserve(static_cast<size_t>(std::min<uint64_t>(row * col, 1 << 16)));
+    for (uint64_t i = 0; i < row * col; i++) {
+        v.push_back(impl_->ar_.load_rcp_basic<Basic>());
+    }
+    impl_->done();
+    return DenseMatrix(static_cast<unsigned>(row), static_cast<unsigned>(col),
+                       v);
+}
+
+#else
+
+class SerializationWriter::Impl
+{
+};
+
+class SerializationReader::Impl
+{
+};
+
+SerializationWriter::SerializationWriter(std::ostream &os)
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+SerializationWriter::SerializationWriter(int fd)
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+SerializationWriter::~SerializationWriter() = default;
+
+void SerializationWriter::write(const RCP<const Basic> &b) {}
+
+void SerializationWriter::write(const vec_basic &v) {}
+
+void SerializationWriter::write(const DenseMatrix &m) {}
+
+void SerializationWriter::flush() {}
+
+SerializationReader::SerializationReader(std::istream &is)
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+SerializationReader::SerializationReader(int fd)
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+SerializationReader::SerializationReader(const std::string &filename)
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+SerializationReader::~SerializationReader() = default;
+
+bool SerializationReader::at_end()
+{
+    return true;
+}
+
+SerializationReader::Kind SerializationReader::next_kind()
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+RCP<const Basic> SerializationReader::read_basic()
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+vec_basic SerializationReader::read_vec()
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+DenseMatrix SerializationReader::read_matrix()
+{
+    throw NotImplementedError("Serialization not implemented in no-rtti mode");
+}
+
+#endif
+
+} // namespace SymEngine
@@ -0,0 +1,93 @@
+/**
+ *  \file serialize-stream.h
+ *  Incremental serialization of many expressions
+ *
+ *  `Basic::dumps()` serializes a single expression into a string. The classes
+ *  below write and read a sequence of expressions, vectors and matrices in the
+ *  compact format of `serialize-compact.h`, one at a time:
+ *   - the bytes are written to, or read from, the stream as they are produced
+ *     or needed, instead of being collected in a string first,
+ *   - a node is written once per stream, even if it occurs in several
+ *     expressions. The writer and the reader keep the nodes they have seen, so
+ *     that later expressions can refer to them.
+ *
+ *  A file can also be read through a memory map. The pages that have been read
+ *  are released after each expression, so that the serialized bytes and the
+ *  rebuilt expressions are not held in memory at the same time.
+ *
+ *  The objects are written with `CompactOutputArchive` and read with
+ *  `CompactInputArchive`. These are the specializations of
+ *  `RCPBasicAwareOutputArchive` and `RCPBasicAwareInputArchive` for the compact
+ *  format, not the portable binary archives used by `Basic::dumps()`. They
+ *  share nodes by index instead of by pointer, so one archive can span the
+ *  whole stream, and their output is several times smaller.
+ **/
+
+#ifndef SYMENGINE_SERIALIZE_STREAM_H
+#define SYMENGINE_SERIALIZE_STREAM_H
+
+#include <memory>
+#include <iosfwd>
+
+#include <symengine/matrix.h>
+
+namespace SymEngine
+{
+
+class SerializationWriter
+{
+public:
+    //! Writes to `os`, which must stay alive as long as the writer
+    explicit SerializationWriter(std::ostream &os);
+    //! Writes to the file descriptor `fd`, which is not closed by the writer.
+    //! Only available on POSIX systems.
+    explicit SerializationWriter(int fd);
+    //! Flushes the remaining bytes
+    ~SerializationWriter();
+
+    void write(const RCP<const Basic> &b);
+    void write(const vec_basic &v);
+    void write(const DenseMatrix &m);
+    //! Writes the buffered bytes to the underlying stream
+    void flush();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+class SerializationReader
+{
+public:
+    //! The kinds of objects in a stream
+    enum class Kind { Expression = 1, Vector = 2, Matrix = 3 };
+
+    //! Reads from `is`, which must stay alive as long as the reader
+    explicit SerializationReader(std::istream &is);
+    //! Reads from the file descriptor `fd`, which is not closed by the reader.
+    //! Only available on POSIX systems.
+    explicit SerializationReader(int fd);
+    //! Reads the file `filename` through a memory map on POSIX systems, and
+    //! through a file stream otherwise
+    explicit SerializationReader(const std::string &filename);
+    ~SerializationReader();
+
+    //! \return true if all the objects of the stream have been read
+    bool at_end();
+    //! \return the kind of the next object, which must exist
+    Kind next_kind();
+
+    //! The next object must be of the same kind, otherwise
+    //! `SerializationError` is thrown
+    RCP<const Basic> read_basic();
+    vec_basic read_vec();
+    DenseMatrix read_matrix();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace SymEngine
+
+#endif // SYMENGINE_SERIALIZE_STREAM_H
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <exception>
 #include <iterator>
 #include <symengine/series_visitor.h>
+#include <symengine/polys/dense_mul.h>
 #include <symengine/symengine_exception.h>
 
 using SymEngine::make_rcp;
@@ -9,6 +11,250 @@ using SymEngine::RCP;
 namespace SymEngine
 {
 
+namespace
+{
+
+// Dense coefficients of a truncated series with rational coefficients. Entry
+// `k` holds the coefficient of x**(k + shift) for a shift kept by the caller.
+typedef std::vector<rational_class> DenseSeries;
+
+// Below this length truncated products use the schoolbook method. Full
+// products are left to dense_mul().
+const size_t karatsuba_cutoff = 32;
+
+// Reads the coefficients of x**shift, ..., x**(shift + n - 1) of `s` into
+// `v`, which ends at the last nonzero one, so that short series stay short.
+// Returns false if one of them is not an Integer or a Rational.
+bool to_dense(const UExprDict &s, int shift, size_t n, DenseSeries &v)
+{
+    v.clear();
+    for (const auto &it : s.get_dict()) {
+        SYMENGINE_ASSERT(it.first >= shift)
+        const size_t k = static_cast<size_t>(it.first - shift);
+        if (k >= n)
+            break;
+        const Basic &c = *it.second.get_basic();
+        if (is_a<Integer>(c)) {
+            if (down_cast<const Integer &>(c).is_zero())
+                continue;
+            v.resize(k + 1, rational_class(0));
+            v[k] = rational_class(
+                down_cast<const Integer &>(c).as_integer_class());
+        } else if (is_a<Rational>(c)) {
+            v.resize(k + 1, rational_class(0));
+            v[k] = down_cast<const Rational &>(c).as_rational_class();
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+UExprDict from_dense(const DenseSeries &v, int shift)
+{
+    map_int_Expr p;
+    for (size_t k = 0; k < v.size(); k++)
+        if (mp_sign(v[k]) != 0)
+            p[static_cast<int>(k) + shift]
+                = Expression(Rational::from_mpq(v[k]));
+    return UExprDict(p);
+}
+
+// Writes the first `n` coefficients of `v` as `num / den` with integer `num`
+// and the least common denominator. Zeros at the end are left out of `num`.
+void clear_denominators(const DenseSeries &v, size_t n,
+                        std::vector<integer_class> &num, integer_class &den)
+{
+    n = std::min(n, v.size());
+    while (n > 0 and mp_sign(v[n - 1]) == 0)
+        n--;
+    den = 1;
+    for (size_t k = 0; k < n; k++)
+        mp_lcm(den, den, get_den(v[k]));
+    num.resize(n);
+    integer_class t;
+    for (size_t k = 0; k < n; k++) {
+        mp_divexact(t, den, get_den(v[k]));
+        num[k] = t * get_num(v[k]);
+    }
+}
+
+// c[0, n) = the first `n` coefficients of a[0, n) * b[0, n)
+void karatsuba_low(const integer_class *a, const integer_class *b, size_t n,
+                   integer_class *c)
+{
+    for (size_t k = 0; k < n; k++)
+        c[k] = 0;
+    if (n <= karatsuba_cutoff) {
+        for (size_t i = 0; i < n; i++) {
+            if (a[i] == 0)
+                continue;
+            for (size_t j = 0; i + j < n; j++)
+                mp_addmul(c[i + j], a[i], b[j]);
+        }
+        return;
+    }
+    // a = a0 + x**m a1 and b = b0 + x**m b1, where a1 and b1 have h <= m
+    // terms. Only the first h coefficients of a1 b0 and a0 b1 are needed, and
+    // a1 b1 does not contribute.
+    const size_t m = (n + 1) / 2, h = n - m;
+    const std::vector<integer_class> z0
+        = dense_mul(std::vector<integer_class>(a, a + m),
+                    std::vector<integer_class>(b, b + m));
+    std::vector<integer_class> z1(h);
+    for (size_t k = 0; k < z0.size(); k++)
+        c[k] += z0[k];
+    karatsuba_low(a + m, b, h, z1.data());
+    for (size_t k = 0; k < h; k++)
+        c[m + k] += z1[k];
+    karatsuba_low(a, b + m, h, z1.data());
+    for (size_t k = 0; k < h; k++)
+        c[m + k] += z1[k];
+}
+
+// First `n` coefficients of `a * b`
+DenseSeries mul_dense(const DenseSeries &a, const DenseSeries &b, size_t n)
+{
+    std::vector<integer_class> an, bn, cn;
+    integer_class ad, bd;
+    clear_denominators(a, n, an, ad);
+    clear_denominators(b, n, bn, bd);
+    const size_t la = an.size(), lb = bn.size();
+    if (la == 0 or lb == 0)
+        return DenseSeries(n, rational_class(0));
+    if (std::min(la, lb) <= karatsuba_cutoff) {
+        cn.assign(n, integer_class(0));
+        for (size_t i = 0; i < la; i++) {
+            if (an[i] == 0)
+                continue;
+            for (size_t j = 0; j < lb and i + j < n; j++)
+                mp_addmul(cn[i + j], an[i], bn[j]);
+        }
+    } else if (la + lb - 1 <= n) {
+        // Nothing is truncated
+        cn = dense_mul(an, bn);
+    } else {
+        // The longer operand is split into blocks as long as the shorter
+        // one, each multiplied with dense_mul(). Only the first `t`
+        // coefficients of a block product are below `n`, and if these are
+        // at most `m`, only they are computed.
+        const std::vector<integer_class> &s = la < lb ? an : bn;
+        const std::vector<integer_class> &l = la < lb ? bn : an;
+        const size_t m = s.size();
+        std::vector<integer_class> block(m), prod(2 * m - 1);
+        cn.assign(n, integer_class(0));
+        for (size_t o = 0; o < l.size() and o < n; o += m) {
+            for (size_t k = 0; k < m; k++)
+                block[k] = o + k < l.size() ? l[o + k] : integer_class(0);
+            const size_t t = std::min(2 * m - 1, n - o);
+            if (t <= m)
+                karatsuba_low(block.data(), s.data(), t, prod.data());
+            else
+                prod = dense_mul(block, s);
+            for (size_t k = 0; k < t; k++)
+                cn[o + k] += prod[k];
+        }
+    }
+    ad *= bd;
+    DenseSeries c(n);
+    for (size_t k = 0; k < n and k < cn.size(); k++) {
+        c[k] = rational_class(cn[k], ad);
+        canonicalize(c[k]);
+    }
+    return c;
+}
+
+// First `n` coefficients of `1 / f` for `f[0] != 0`, by the Newton iteration
+// g <- g (2 - f g), which doubles the number of correct terms at each step
+DenseSeries invert_dense(const DenseSeries &f, size_t n)
+{
+    SYMENGINE_ASSERT(mp_sign(f[0]) != 0)
+    DenseSeries g(1, rational_class(1) / f[0]);
+    for (size_t k = 1; k < n;) {
+        k = std::min(2 * k, n);
+        DenseSeries e = mul_dense(f, g, k);
+        for (auto &c : e)
+            c = -c;
+        e[0] += rational_class(2);
+        g = mul_dense(g, e, k);
+    }
+    g.resize(n, rational_class(0));
+    return g;
+}
+
+// First `n` coefficients of `log(f)` for `f[0] == 1`, as the integral of
+// f' / f
+DenseSeries log_dense(const DenseSeries &f, size_t n)
+{
+    SYMENGINE_ASSERT(f[0] == rational_class(1))
+    DenseSeries r(n, rational_class(0));
+    if (n < 2)
+        return r;
+    DenseSeries d(n - 1, rational_class(0));
+    for (size_t k = 1; k < n and k < f.size(); k++)
+        d[k - 1] = f[k] * rational_class(static_cast<long>(k));
+    d = mul_dense(d, invert_dense(f, n - 1), n - 1);
+    for (size_t k = 1; k < n; k++)
+        r[k] = d[k - 1] / rational_class(static_cast<long>(k));
+    return r;
+}
+
+// First `n` coefficients of `exp(f)` for `f[0] == 0`, by the Newton iteration
+// g <- g (1 + f - log(g))
+DenseSeries exp_dense(const DenseSeries &f, size_t n)
+{
+    SYMENGINE_ASSERT(f.empty() or mp_sign(f[0]) == 0)
+    DenseSeries g(1, rational_class(1));
+    for (size_t k = 1; k < n;) {
+        k = std::min(2 * k, n);
+        DenseSeries h = log_dense(g, k);
+        for (size_t i = 0; i < k; i++)
+            h[i] = (i < f.size() ? f[i] : rational_class(0)) - h[i];
+        h[0] += rational_class(1);
+        g = mul_dense(g, h, k);
+    }
+    g.resize(n, rational_class(0));
+    return g;
+}
+
+// First `n` coefficients of `t**e` for `t[0] != 0` and `e > 0`, by J.C.P.
+// Miller's recurrence p_k = sum_{i=1}^{k} ((e + 1) i - k) t_i p_{k-i}
+// / (k t_0), which follows from t p' = e t' p. It is run on `t` with its
+// denominators cleared, where every p_k is an integer and the divisions are
+// exact.
+DenseSeries pow_dense(const DenseSeries &t, int e, size_t n)
+{
+    SYMENGINE_ASSERT(mp_sign(t[0]) != 0 and e > 0)
+    std::vector<integer_class> tn, p(n);
+    integer_class d, s, u;
+    clear_denominators(t, n, tn, d);
+    if (n == 0)
+        return DenseSeries();
+    mp_pow_ui(p[0], tn[0], static_cast<unsigned long>(e));
+    // `tn` ends at the last nonzero coefficient of `t`, so a short base only
+    // takes a few terms per coefficient
+    for (size_t k = 1; k < n; k++) {
+        s = 0;
+        const size_t m = std::min(k + 1, tn.size());
+        for (size_t i = 1; i < m; i++) {
+            if (tn[i] == 0)
+                continue;
+            u = tn[i] * p[k - i];
+            s += u * integer_class((e + 1) * long(i) - long(k));
+        }
+        mp_divexact(p[k], s, integer_class(long(k)) * tn[0]);
+    }
+    mp_pow_ui(d, d, static_cast<unsigned long>(e));
+    DenseSeries r(n);
+    for (size_t k = 0; k < n; k++) {
+        r[k] = rational_class(p[k], d);
+        canonicalize(r[k]);
+    }
+    return r;
+}
+
+} // namespace
+
 RCP<const UnivariateSeries> UnivariateSeries::series(const RCP<const Basic> &t,
                                                      const std::string &x,
                                                      unsigned int prec)
@@ -79,17 +325,32 @@ int UnivariateSeries::ldegree(const UExprDict &s)
 UExprDict UnivariateSeries::mul(const UExprDict &a, const UExprDict &b,
                                 unsigned prec)
 {
-    map_int_Expr p;
-    for (auto &it1 : a.get_dict()) {
-        for (auto &it2 : b.get_dict()) {
-            int exp = it1.first + it2.first;
-            if (exp < (int)prec) {
-                p[exp] += it1.second * it2.second;
-            } else {
+    if (a.get_dict().empty() or b.get_dict().empty())
+        return UExprDict();
+    const int la = ldegree(a), lb = ldegree(b);
+    const long n = long(prec) - la - lb;
+    if (n <= 0)
+        return UExprDict();
+
+    DenseSeries da, db;
+    if (to_dense(a, la, n, da) and to_dense(b, lb, n, db))
+        return from_dense(mul_dense(da, db, n), la + lb);
+
+    // Each coefficient is summed with a single `add` over all its terms
+    std::vector<vec_basic> terms(n);
+    for (const auto &it1 : a.get_dict()) {
+        for (const auto &it2 : b.get_dict()) {
+            const long k = long(it1.first) + it2.first - la - lb;
+            if (k >= n)
                 break;
-            }
+            terms[k].push_back(
+                SymEngine::mul(it1.second.get_basic(), it2.second.get_basic()));
         }
     }
+    map_int_Expr p;
+    for (long k = 0; k < n; k++)
+        if (not terms[k].empty())
+            p[int(k) + la + lb] = Expression(SymEngine::add(terms[k]));
     return UExprDict(p);
 }
 
@@ -110,6 +371,18 @@ UExprDict UnivariateSeries::pow(const UExprDict &base, int exp, unsigned prec)
         }
     }
 
+    if (base.get_dict().empty())
+        return UExprDict();
+
+    // base = x**l t with t(0) != 0, so base**exp = x**(l exp) t**exp
+    const int l = ldegree(base);
+    const long n = long(prec) - long(l) * exp;
+    if (n <= 0)
+        return UExprDict();
+    DenseSeries t;
+    if (to_dense(base, l, n, t) and not t.empty() and mp_sign(t[0]) != 0)
+        return from_dense(pow_dense(t, exp, n), l * exp);
+
     UExprDict x(base);
     UExprDict y(1);
     while (exp > 1) {
@@ -179,6 +452,58 @@ UExprDict UnivariateSeries::subs(const UExprDict &s, const UExprDict &var,
     return result;
 }
 
+UExprDict UnivariateSeries::series_invert(const UExprDict &s,
+                                          const UExprDict &var,
+                                          unsigned int prec)
+{
+    DenseSeries v;
+    if (not s.get_dict().empty() and prec > 0) {
+        const int l = ldegree(s);
+        if (to_dense(s, l, prec, v) and not v.empty() and mp_sign(v[0]) != 0)
+            return from_dense(invert_dense(v, prec), -l);
+    }
+    return SeriesBase::series_invert(s, var, prec);
+}
+
+UExprDict UnivariateSeries::series_log(const UExprDict &s,
+                                       const UExprDict &var, unsigned int prec)
+{
+    DenseSeries v;
+    if (not s.get_dict().empty() and prec > 0 and ldegree(s) == 0
+        and to_dense(s, 0, prec, v) and not v.empty()
+        and mp_sign(v[0]) != 0) {
+        // log(s) = log(c) + log(s / c) with c = s(0)
+        const rational_class c = v[0];
+        for (auto &q : v)
+            q /= c;
+        UExprDict r = from_dense(log_dense(v, prec), 0);
+        if (c != rational_class(1))
+            r += log(Expression(Rational::from_mpq(c)));
+        return r;
+    }
+    return SeriesBase::series_log(s, var, prec);
+}
+
+UExprDict UnivariateSeries::series_exp(const UExprDict &s,
+                                       const UExprDict &var, unsigned int prec)
+{
+    if (s.get_dict().empty())
+        return UExprDict(1);
+    DenseSeries v;
+    if (prec > 0 and ldegree(s) >= 0) {
+        // exp(s) = exp(c) exp(s - c) with c = s(0), which may be symbolic
+        const Expression c = find_cf(s, var, 0);
+        const UExprDict t = (c == 0) ? s : UExprDict(s - c);
+        if (to_dense(t, 0, prec, v)) {
+            UExprDict r = from_dense(exp_dense(v, prec), 0);
+            if (c != 0)
+                r *= exp(c);
+            return r;
+        }
+    }
+    return SeriesBase::series_exp(s, var, prec);
+}
+
 Expression UnivariateSeries::sin(const Expression &c)
 {
     return SymEngine::sin(c.get_basic());
@@ -60,6 +60,15 @@ public:
     static UExprDict subs(const UExprDict &s, const UExprDict &var,
                           const UExprDict &r, unsigned prec);
 
+    // Series with rational coefficients are handled by dense Newton
+    // iterations, anything else falls back to the generic algorithms
+    static UExprDict series_invert(const UExprDict &s, const UExprDict &var,
+                                   unsigned int prec);
+    static UExprDict series_log(const UExprDict &s, const UExprDict &var,
+                                unsigned int prec);
+    static UExprDict series_exp(const UExprDict &s, const UExprDict &var,
+                                unsigned int prec);
+
     static Expression sin(const Expression &c);
     static Expression cos(const Expression &c);
     static Expression tan(const Expression &c);
@@ -0,0 +1,543 @@
+#include <algorithm>
+
+#include <symengine/series_generic.h>
+#include <symengine/series_jet.h>
+#include <symengine/symengine_exception.h>
+
+namespace SymEngine
+{
+
+JetLayout::JetLayout(const std::vector<std::string> &names, unsigned prec)
+    : names_(names), prec_(prec)
+{
+    const unsigned n = nvars();
+    binom_.resize(prec + n + 1);
+    for (size_t m = 0; m < binom_.size(); m++) {
+        binom_[m].assign(m + 1, 1);
+        for (size_t k = 1; k < m; k++)
+            binom_[m][k] = binom_[m - 1][k - 1] + binom_[m - 1][k];
+    }
+    // Enumerate the monomials of each degree in order, keeping in `e` the
+    // exponents of the current one
+    std::vector<unsigned> e(n);
+    offset_.push_back(0);
+    for (unsigned d = 0; d < prec; d++) {
+        if (n == 0) {
+            if (d == 0) {
+                degree_.push_back(0);
+            }
+            offset_.push_back(degree_.size());
+            continue;
+        }
+        std::fill(e.begin(), e.end(), 0);
+        e[0] = d;
+        while (true) {
+            degree_.push_back(d);
+            exps_.insert(exps_.end(), e.begin(), e.end());
+            // The next monomial moves one unit from the last nonzero
+            // exponent before the last variable to the variable after it,
+            // and collects the exponent of the last variable there as well
+            const unsigned last = e[n - 1];
+            e[n - 1] = 0;
+            unsigned v = n - 1;
+            while (v > 0 and e[v - 1] == 0)
+                v--;
+            if (v == 0)
+                break;
+            e[v - 1]--;
+            e[v] = last + 1;
+        }
+        offset_.push_back(degree_.size());
+    }
+    SYMENGINE_ASSERT(n == 0 or size() == binom_[prec + n - 1][n])
+}
+
+size_t JetLayout::index(const unsigned *e, unsigned d) const
+{
+    SYMENGINE_ASSERT(d < prec_)
+    const unsigned n = nvars();
+    size_t r = offset_[d];
+    // Monomials of degree `d` whose exponent of variable `v` is larger than
+    // e[v] come first; by the hockey-stick identity there are
+    // binomial(d - e[v] + n - v - 2, n - v - 1) of them.
+    for (unsigned v = 0; v + 1 < n; v++) {
+        if (d > e[v])
+            r += binom_[d - e[v] + n - v - 2][n - v - 1];
+        d -= e[v];
+    }
+    return r;
+}
+
+unsigned JetLayout::find(const std::string &name) const
+{
+    return numeric_cast<unsigned>(
+        std::find(names_.begin(), names_.end(), name) - names_.begin());
+}
+
+namespace
+{
+
+inline bool is_zero_coeff(const RCP<const Basic> &c)
+{
+    return is_a<Integer>(*c) and down_cast<const Integer &>(*c).is_zero();
+}
+
+} // namespace
+
+JetDict::JetDict(const int &i) : coeffs_({integer(i)}) {}
+
+JetDict::JetDict(const Expression &c) : coeffs_({c.get_basic()}) {}
+
+JetDict::JetDict(const std::shared_ptr<const JetLayout> &layout,
+                 vec_basic coeffs)
+    : layout_(layout), coeffs_(std::move(coeffs))
+{
+    SYMENGINE_ASSERT(layout_ and coeffs_.size() == layout_->size())
+}
+
+JetDict JetDict::zero(const std::shared_ptr<const JetLayout> &layout)
+{
+    return JetDict(layout, vec_basic(layout->size(), SymEngine::zero));
+}
+
+JetDict JetDict::generator(const std::shared_ptr<const JetLayout> &layout,
+                           unsigned i)
+{
+    JetDict r = JetDict::zero(layout);
+    if (layout->get_prec() > 1)
+        r.coeffs_[layout->offset(1) + i] = one;
+    return r;
+}
+
+RCP<const Basic> JetDict::get_coeff(size_t i) const
+{
+    if (i < coeffs_.size())
+        return coeffs_[i];
+    return SymEngine::zero;
+}
+
+RCP<const Basic> JetDict::constant_term() const
+{
+    return get_coeff(0);
+}
+
+JetDict JetDict::nonconstant_part() const
+{
+    if (is_constant())
+        return JetDict(0);
+    JetDict r = *this;
+    if (not r.coeffs_.empty())
+        r.coeffs_[0] = SymEngine::zero;
+    return r;
+}
+
+JetDict &JetDict::operator+=(const JetDict &o)
+{
+    if (o.is_constant()) {
+        if (not coeffs_.empty())
+            coeffs_[0] = add(coeffs_[0], o.coeffs_[0]);
+        return *this;
+    }
+    if (is_constant()) {
+        const RCP<const Basic> c = coeffs_[0];
+        *this = o;
+        if (not coeffs_.empty())
+            coeffs_[0] = add(c, coeffs_[0]);
+        return *this;
+    }
+    SYMENGINE_ASSERT(layout_ == o.layout_)
+    for (size_t i = 0; i < coeffs_.size(); i++)
+        if (not is_zero_coeff(o.coeffs_[i]))
+            coeffs_[i] = add(coeffs_[i], o.coeffs_[i]);
+    return *this;
+}
+
+JetDict &JetDict::operator-=(const JetDict &o)
+{
+    return *this += -o;
+}
+
+JetDict JetDict::operator-() const
+{
+    JetDict r = *this;
+    for (auto &c : r.coeffs_)
+        if (not is_zero_coeff(c))
+            c = neg(c);
+    return r;
+}
+
+JetDict &JetDict::operator*=(const JetDict &o)
+{
+    *this = *this * o;
+    return *this;
+}
+
+JetDict operator*(const JetDict &a, const JetDict &b)
+{
+    if (a.is_constant() and b.is_constant())
+        return JetDict(Expression(mul(a.coeffs_[0], b.coeffs_[0])));
+    if (a.is_constant() or b.is_constant()) {
+        const JetDict &s = a.is_constant() ? b : a;
+        const RCP<const Basic> &c = a.is_constant() ? a.coeffs_[0]
+                                                     : b.coeffs_[0];
+        JetDict r = JetDict::zero(s.layout_);
+        if (is_zero_coeff(c))
+            return r;
+        for (size_t i = 0; i < s.coeffs_.size(); i++)
+            if (not is_zero_coeff(s.coeffs_[i]))
+                r.coeffs_[i] = mul(c, s.coeffs_[i]);
+        return r;
+    }
+    SYMENGINE_ASSERT(a.layout_ == b.layout_)
+    const JetLayout &l = *a.layout_;
+    const unsigned n = l.nvars(), prec = l.get_prec();
+    // Collect the products landing on each monomial and add them once
+    std::vector<vec_basic> terms(l.size());
+    std::vector<unsigned> e(n);
+    for (size_t i = 0; i < l.size(); i++) {
+        if (is_zero_coeff(a.coeffs_[i]))
+            continue;
+        const unsigned di = l.degree(i);
+        const unsigned *ei = l.exponents(i);
+        const size_t jend = l.offset(prec - di);
+        for (size_t j = 0; j < jend; j++) {
+            if (is_zero_coeff(b.coeffs_[j]))
+                continue;
+            const unsigned *ej = l.exponents(j);
+            for (unsigned v = 0; v < n; v++)
+                e[v] = ei[v] + ej[v];
+            terms[l.index(e.data(), di + l.degree(j))].push_back(
+                mul(a.coeffs_[i], b.coeffs_[j]));
+        }
+    }
+    JetDict r = JetDict::zero(a.layout_);
+    for (size_t k = 0; k < terms.size(); k++)
+        if (not terms[k].empty())
+            r.coeffs_[k] = add(terms[k]);
+    return r;
+}
+
+namespace
+{
+
+// f(s), where `f` is the expansion of f(c + y) around y = 0 for the constant
+// term `c` of `s`. Since t = s - c has no constant term, t**k only matters
+// for k < prec and the sum is evaluated by Horner's rule.
+JetDict compose(const UExprDict &f, const JetDict &s)
+{
+    const auto &d = f.get_dict();
+    if (not d.empty() and d.begin()->first < 0)
+        throw NotImplementedError(
+            "Negative powers in multivariate series not implemented");
+    if (s.is_constant()) {
+        auto c = d.find(0);
+        return JetDict(c == d.end() ? Expression(0) : c->second);
+    }
+    const unsigned prec = s.get_layout()->get_prec();
+    const JetDict t = s.nonconstant_part();
+    JetDict r(0);
+    for (auto it = d.rbegin(); it != d.rend(); ++it) {
+        if (it->first >= static_cast<int>(prec))
+            continue;
+        // Multiply by t once for each power skipped since the last term
+        int k = it->first;
+        auto next = std::next(it);
+        const int lower = (next == d.rend()) ? 0 : next->first;
+        r += JetDict(it->second);
+        for (; k > lower; k--)
+            r = r * t;
+    }
+    return r;
+}
+
+// The univariate series c + y for the constant term `c` of `s`
+UExprDict shifted_variable(const JetDict &s)
+{
+    map_int_Expr m;
+    m[1] = Expression(1);
+    const RCP<const Basic> c = s.constant_term();
+    if (not is_zero_coeff(c))
+        m[0] = Expression(c);
+    return UExprDict(m);
+}
+
+template <typename F>
+JetDict apply_univariate(const JetDict &s, unsigned prec, F &&f)
+{
+    return compose(f(shifted_variable(s), UnivariateSeries::var("y"), prec),
+                   s);
+}
+
+} // namespace
+
+MultivariateSeries MultivariateSeries::series(const RCP<const Basic> &t,
+                                              const vec_sym &vars,
+                                              unsigned prec)
+{
+    std::vector<std::string> names;
+    for (const auto &v : vars)
+        names.push_back(v->get_name());
+    auto layout = std::make_shared<const JetLayout>(names, prec);
+    SeriesVisitor<JetDict, Expression, MultivariateSeries> visitor(
+        JetDict::zero(layout), "", prec);
+    JetDict p = visitor.apply(t);
+    if (p.is_constant())
+        p = JetDict::zero(layout) + p;
+    return MultivariateSeries(p, vars, prec);
+}
+
+RCP<const Basic>
+MultivariateSeries::get_coeff(const vec_uint &exponents) const
+{
+    const JetLayout &l = *p_.get_layout();
+    if (exponents.size() != l.nvars())
+        throw SymEngineException("MultivariateSeries: wrong number of "
+                                 "exponents");
+    unsigned d = 0;
+    for (unsigned e : exponents)
+        d += e;
+    if (d >= prec_)
+        return zero;
+    return p_.get_coeff(l.index(exponents.data(), d));
+}
+
+RCP<const Basic> MultivariateSeries::as_basic() const
+{
+    const JetLayout &l = *p_.get_layout();
+    vec_basic terms;
+    for (size_t i = 0; i < l.size(); i++) {
+        const RCP<const Basic> &c = p_.get_coeffs()[i];
+        if (is_zero_coeff(c))
+            continue;
+        vec_basic factors = {c};
+        const unsigned *e = l.exponents(i);
+        for (unsigned v = 0; v < l.nvars(); v++)
+            if (e[v] != 0)
+                factors.push_back(SymEngine::pow(vars_[v], integer(e[v])));
+        terms.push_back(SymEngine::mul(factors));
+    }
+    return add(terms);
+}
+
+JetDict MultivariateSeries::convert(const Basic &x)
+{
+    return JetDict(Expression(x.rcp_from_this()));
+}
+
+JetDict MultivariateSeries::mul(const JetDict &s, const JetDict &r,
+                                unsigned prec)
+{
+    return s * r;
+}
+
+JetDict MultivariateSeries::pow(const JetDict &s, int n, unsigned prec)
+{
+    if (n < 0)
+        return pow(series_invert(s, s, prec), -n, prec);
+    return apply_univariate(
+        s, prec, [n](const UExprDict &u, const UExprDict &var, unsigned p) {
+            return UnivariateSeries::pow(u, n, p);
+        });
+}
+
+JetDict MultivariateSeries::series_function(const Basic &f,
+                                            const JetDict &var)
+{
+    const std::shared_ptr<const JetLayout> &layout = var.get_layout();
+    const JetLayout &l = *layout;
+    vec_sym syms;
+    map_basic_basic origin;
+    bool depends = false;
+    for (const auto &name : l.get_names()) {
+        syms.push_back(symbol(name));
+        origin[syms.back()] = zero;
+        depends = depends or has_symbol(f, *syms.back());
+    }
+    if (not depends)
+        return convert(f);
+    // The derivative for each monomial is taken from the one with the
+    // exponent of its first variable lowered by one, which precedes it
+    vec_basic derivs(l.size());
+    vec_basic coeffs(l.size());
+    std::vector<unsigned> e(l.nvars());
+    for (size_t i = 0; i < l.size(); i++) {
+        const unsigned *ei = l.exponents(i);
+        integer_class fact(1);
+        for (unsigned v = 0; v < l.nvars(); v++)
+            for (unsigned k = 2; k <= ei[v]; k++)
+                fact *= integer_class(long(k));
+        if (i == 0) {
+            derivs[i] = f.rcp_from_this();
+        } else {
+            unsigned v = 0;
+            while (ei[v] == 0)
+                v++;
+            std::copy(ei, ei + l.nvars(), e.begin());
+            e[v]--;
+            derivs[i] = derivs[l.index(e.data(), l.degree(i) - 1)]->diff(
+                syms[v]);
+        }
+        coeffs[i] = div(expand(derivs[i]->subs(origin)), integer(fact));
+    }
+    return JetDict(layout, coeffs);
+}
+
+JetDict MultivariateSeries::series_invert(const JetDict &s,
+                                          const JetDict &var, unsigned prec)
+{
+    if (s.is_constant() and is_zero_coeff(s.constant_term()))
+        throw DivisionByZeroError(
+            "MultivariateSeries::series_invert: Division By Zero");
+    return apply_univariate(s, prec, UnivariateSeries::series_invert);
+}
+
+JetDict MultivariateSeries::series_nthroot(const JetDict &s, int n,
+                                           const JetDict &var, unsigned prec)
+{
+    return apply_univariate(
+        s, prec, [n](const UExprDict &u, const UExprDict &var, unsigned p) {
+            return UnivariateSeries::series_nthroot(u, n, var, p);
+        });
+}
+
+JetDict MultivariateSeries::series_sin(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_sin);
+}
+
+JetDict MultivariateSeries::series_cos(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_cos);
+}
+
+JetDict MultivariateSeries::series_tan(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_tan);
+}
+
+JetDict MultivariateSeries::series_cot(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_cot);
+}
+
+JetDict MultivariateSeries::series_csc(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_csc);
+}
+
+JetDict MultivariateSeries::series_sec(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_sec);
+}
+
+JetDict MultivariateSeries::series_asin(const JetDict &s, const JetDict &var,
+                                        unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_asin);
+}
+
+JetDict MultivariateSeries::series_acos(const JetDict &s, const JetDict &var,
+                                        unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_acos);
+}
+
+JetDict MultivariateSeries::series_atan(const JetDict &s, const JetDict &var,
+                                        unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_atan);
+}
+
+JetDict MultivariateSeries::series_sinh(const JetDict &s, const JetDict &var,
+                                        unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_sinh);
+}
+
+JetDict MultivariateSeries::series_cosh(const JetDict &s, const JetDict &var,
+                                        unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_cosh);
+}
+
+JetDict MultivariateSeries::series_tanh(const JetDict &s, const JetDict &var,
+                                        unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_tanh);
+}
+
+JetDict MultivariateSeries::series_asinh(const JetDict &s, const JetDict &var,
+                                         unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_asinh);
+}
+
+JetDict MultivariateSeries::series_atanh(const JetDict &s, const JetDict &var,
+                                         unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_atanh);
+}
+
+JetDict MultivariateSeries::series_lambertw(const JetDict &s,
+                                            const JetDict &var, unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_lambertw);
+}
+
+JetDict MultivariateSeries::series_exp(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_exp);
+}
+
+JetDict MultivariateSeries::series_log(const JetDict &s, const JetDict &var,
+                                       unsigned prec)
+{
+    return apply_univariate(s, prec, UnivariateSeries::series_log);
+}
+
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Symbol &x)
+{
+    const std::shared_ptr<const JetLayout> &layout = var.get_layout();
+    const unsigned i = layout->find(x.get_name());
+    if (i < layout->nvars()) {
+        p = JetDict::generator(layout, i);
+    } else {
+        p = MultivariateSeries::convert(x);
+    }
+}
+
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Function &x)
+{
+    p = MultivariateSeries::series_function(x, var);
+}
+
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Gamma &x)
+{
+    p = MultivariateSeries::series_function(x, var);
+}
+
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Basic &x)
+{
+    for (const auto &name : var.get_layout()->get_names()) {
+        if (has_symbol(x, *symbol(name)))
+            throw NotImplementedError("Not Implemented");
+    }
+    p = MultivariateSeries::convert(x);
+}
+
+} // namespace SymEngine
@@ -0,0 +1,240 @@
+/**
+ *  \file series_jet.h
+ *  Class for multivariate series truncated in total degree (jets).
+ *
+ **/
+#ifndef SYMENGINE_SERIES_JET_H
+#define SYMENGINE_SERIES_JET_H
+
+#include <memory>
+
+#include <symengine/expression.h>
+#include <symengine/series_visitor.h>
+
+namespace SymEngine
+{
+
+//! Monomials of total degree less than `prec` in a fixed list of variables,
+//! numbered degree by degree. Inside a degree they are ordered by decreasing
+//! exponent of the first variable, then of the second and so on, which gives
+//! 1, x, y, x**2, x*y, y**2, ... for the variables (x, y).
+class JetLayout
+{
+private:
+    std::vector<std::string> names_;
+    unsigned prec_;
+    //! offset_[d] is the index of the first monomial of degree `d`
+    std::vector<size_t> offset_;
+    //! Total degree of each monomial
+    std::vector<unsigned> degree_;
+    //! Exponents of monomial `i` are exps_[i * nvars, (i + 1) * nvars)
+    std::vector<unsigned> exps_;
+    //! binom_[m][k] is binomial(m, k)
+    std::vector<std::vector<size_t>> binom_;
+
+public:
+    JetLayout(const std::vector<std::string> &names, unsigned prec);
+
+    inline unsigned nvars() const
+    {
+        return numeric_cast<unsigned>(names_.size());
+    }
+    inline unsigned get_prec() const
+    {
+        return prec_;
+    }
+    inline const std::vector<std::string> &get_names() const
+    {
+        return names_;
+    }
+    //! Number of monomials of total degree less than `prec`
+    inline size_t size() const
+    {
+        return offset_.back();
+    }
+    //! Index of the first monomial of degree `d`, or size() if `d >= prec`
+    inline size_t offset(unsigned d) const
+    {
+        return offset_[std::min(d, prec_)];
+    }
+    inline unsigned degree(size_t i) const
+    {
+        return degree_[i];
+    }
+    inline const unsigned *exponents(size_t i) const
+    {
+        return exps_.data() + i * nvars();
+    }
+    //! Index of the monomial with exponents `e` and total degree `d < prec`
+    size_t index(const unsigned *e, unsigned d) const;
+    //! Position of the variable `name`, or nvars() if it is not one of them
+    unsigned find(const std::string &name) const;
+};
+
+//! Coefficients of a jet, stored densely in the order of its layout. A jet
+//! without a layout is a constant.
+class JetDict
+{
+private:
+    std::shared_ptr<const JetLayout> layout_;
+    vec_basic coeffs_;
+
+public:
+    JetDict(const int &i);
+    JetDict(const Expression &c);
+    JetDict(const std::shared_ptr<const JetLayout> &layout, vec_basic coeffs);
+    JetDict() : JetDict(0) {}
+
+    //! The jet with the layout `layout` and all coefficients zero
+    static JetDict zero(const std::shared_ptr<const JetLayout> &layout);
+    //! The `i`-th variable of `layout`
+    static JetDict generator(const std::shared_ptr<const JetLayout> &layout,
+                             unsigned i);
+
+    inline const std::shared_ptr<const JetLayout> &get_layout() const
+    {
+        return layout_;
+    }
+    inline bool is_constant() const
+    {
+        return not layout_;
+    }
+    inline const vec_basic &get_coeffs() const
+    {
+        return coeffs_;
+    }
+    //! Coefficient of the monomial with index `i` in the layout
+    RCP<const Basic> get_coeff(size_t i) const;
+    RCP<const Basic> constant_term() const;
+    //! The jet with its constant term dropped
+    JetDict nonconstant_part() const;
+
+    JetDict &operator+=(const JetDict &o);
+    JetDict &operator-=(const JetDict &o);
+    JetDict &operator*=(const JetDict &o);
+    JetDict operator-() const;
+
+    friend JetDict operator+(JetDict a, const JetDict &b)
+    {
+        a += b;
+        return a;
+    }
+    friend JetDict operator-(JetDict a, const JetDict &b)
+    {
+        a -= b;
+        return a;
+    }
+    friend JetDict operator*(const JetDict &a, const JetDict &b);
+};
+
+//! MultivariateSeries Class
+//! The expansion of an expression in several variables, truncated at total
+//! degree `prec`. It is computed by the same `SeriesVisitor` as the
+//! univariate series, with this class as the series policy: elementary
+//! functions are applied to a jet `c + t` by evaluating their univariate
+//! expansion around `c` at the nilpotent part `t`.
+class MultivariateSeries
+{
+private:
+    JetDict p_;
+    vec_sym vars_;
+    unsigned prec_;
+
+public:
+    MultivariateSeries(const JetDict &p, const vec_sym &vars, unsigned prec)
+        : p_(p), vars_(vars), prec_(prec)
+    {
+    }
+
+    static MultivariateSeries series(const RCP<const Basic> &t,
+                                     const vec_sym &vars, unsigned prec);
+
+    inline const JetDict &get_poly() const
+    {
+        return p_;
+    }
+    inline const vec_sym &get_vars() const
+    {
+        return vars_;
+    }
+    inline unsigned get_degree() const
+    {
+        return prec_;
+    }
+    //! Coefficient of the monomial with the given exponents of get_vars(),
+    //! zero if its total degree is at least get_degree()
+    RCP<const Basic> get_coeff(const vec_uint &exponents) const;
+    RCP<const Basic> as_basic() const;
+
+    static JetDict convert(const Basic &x);
+    static JetDict mul(const JetDict &s, const JetDict &r, unsigned prec);
+    static JetDict pow(const JetDict &s, int n, unsigned prec);
+    //! Taylor expansion of `f` from its partial derivatives at the origin
+    static JetDict series_function(const Basic &f, const JetDict &var);
+
+    static JetDict series_invert(const JetDict &s, const JetDict &var,
+                                 unsigned prec);
+    static JetDict series_nthroot(const JetDict &s, int n, const JetDict &var,
+                                  unsigned prec);
+    static JetDict series_sin(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_cos(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_tan(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_cot(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_csc(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_sec(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_asin(const JetDict &s, const JetDict &var,
+                               unsigned prec);
+    static JetDict series_acos(const JetDict &s, const JetDict &var,
+                               unsigned prec);
+    static JetDict series_atan(const JetDict &s, const JetDict &var,
+                               unsigned prec);
+    static JetDict series_sinh(const JetDict &s, const JetDict &var,
+                               unsigned prec);
+    static JetDict series_cosh(const JetDict &s, const JetDict &var,
+                               unsigned prec);
+    static JetDict series_tanh(const JetDict &s, const JetDict &var,
+                               unsigned prec);
+    static JetDict series_asinh(const JetDict &s, const JetDict &var,
+                                unsigned prec);
+    static JetDict series_atanh(const JetDict &s, const JetDict &var,
+                                unsigned prec);
+    static JetDict series_lambertw(const JetDict &s, const JetDict &var,
+                                   unsigned prec);
+    static JetDict series_exp(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+    static JetDict series_log(const JetDict &s, const JetDict &var,
+                              unsigned prec);
+};
+
+// The univariate SeriesVisitor compares symbols with a single variable name
+// and differentiates with respect to it; for jets the variables are taken
+// from the layout of `var` instead.
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Symbol &x);
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Function &x);
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Gamma &x);
+template <>
+void SeriesVisitor<JetDict, Expression, MultivariateSeries>::bvisit(
+    const Basic &x);
+
+inline MultivariateSeries multivariate_series(const RCP<const Basic> &t,
+                                              const vec_sym &vars,
+                                              unsigned prec)
+{
+    return MultivariateSeries::series(t, vars, prec);
+}
+
+} // namespace SymEngine
+
+#endif
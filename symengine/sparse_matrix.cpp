@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <numeric>
+#include <queue>
+#include <set>
 #include <symengine/matrix.h>
 #include <symengine/add.h>
 #include <symengine/functions.h>
@@ -6,6 +9,7 @@
 #include <symengine/constants.h>
 #include <symengine/symengine_exception.h>
 #include <symengine/visitor.h>
+#include <symengine/derivative.h>
 #include <symengine/test_visitors.h>
 
 namespace SymEngine
@@ -179,9 +183,79 @@ unsigned CSRMatrix::rank() const
     throw NotImplementedError("Not Implemented");
 }
 
+DenseMatrix csr_to_dense(const CSRMatrix &A)
+{
+    DenseMatrix D(A.nrows(), A.ncols());
+    zeros(D);
+    std::vector<unsigned> p, j;
+    vec_basic x;
+    std::tie(p, j, x) = A.as_vectors();
+    for (unsigned i = 0; i < A.nrows(); i++) {
+        for (unsigned k = p[i]; k < p[i + 1]; k++) {
+            D.set(i, j[k], x[k]);
+        }
+    }
+    return D;
+}
+
+CSRMatrix dense_to_csr(const DenseMatrix &A)
+{
+    std::vector<unsigned> p(A.nrows() + 1, 0), j;
+    vec_basic x;
+    for (unsigned i = 0; i < A.nrows(); i++) {
+        for (unsigned k = 0; k < A.ncols(); k++) {
+            RCP<const Basic> e = A.get(i, k);
+            if (not is_true(is_zero(*e))) {
+                j.push_back(k);
+                x.push_back(e);
+            }
+        }
+        p[i + 1] = numeric_cast<unsigned>(j.size());
+    }
+    return CSRMatrix(A.nrows(), A.ncols(), std::move(p), std::move(j),
+                     std::move(x));
+}
+
+namespace
+{
+// Stores `A` in `result`, converting it to the type of `result`
+void assign_matrix(CSRMatrix &&A, MatrixBase &result)
+{
+    if (is_a<CSRMatrix>(result)) {
+        down_cast<CSRMatrix &>(result) = std::move(A);
+    } else if (is_a<DenseMatrix>(result)) {
+        SYMENGINE_ASSERT(result.nrows() == A.nrows()
+                         and result.ncols() == A.ncols());
+        down_cast<DenseMatrix &>(result) = csr_to_dense(A);
+    } else {
+        throw NotImplementedError("Not Implemented");
+    }
+}
+
+void assign_matrix(DenseMatrix &&A, MatrixBase &result)
+{
+    if (is_a<DenseMatrix>(result)) {
+        SYMENGINE_ASSERT(result.nrows() == A.nrows()
+                         and result.ncols() == A.ncols());
+        down_cast<DenseMatrix &>(result) = std::move(A);
+    } else if (is_a<CSRMatrix>(result)) {
+        down_cast<CSRMatrix &>(result) = dense_to_csr(A);
+    } else {
+        throw NotImplementedError("Not Implemented");
+    }
+}
+} // namespace
+
 RCP<const Basic> CSRMatrix::det() const
 {
-    throw NotImplementedError("Not Implemented");
+    SYMENGINE_ASSERT(row_ == col_);
+    SparseLUAnalysis analysis(*this);
+    SparseLU lu(analysis, *this);
+    if (lu.has_zero_pivot()) {
+        // Use the dense algorithm, which chooses the pivots from the values
+        return det_bareis(csr_to_dense(*this));
+    }
+    return lu.det();
 }
 
 void CSRMatrix::inv(MatrixBase &result) const
@@ -189,36 +263,143 @@ void CSRMatrix::inv(MatrixBase &result) const
     throw NotImplementedError("Not Implemented");
 }
 
+// The result can be a CSRMatrix or a DenseMatrix. The sum of two CSR
+// matrices is sparse, and the sum with a DenseMatrix is dense.
 void CSRMatrix::add_matrix(const MatrixBase &other, MatrixBase &result) const
 {
-    throw NotImplementedError("Not Implemented");
+    SYMENGINE_ASSERT(row_ == other.nrows() and col_ == other.ncols());
+
+    if (is_a<CSRMatrix>(other)) {
+        const CSRMatrix &o = down_cast<const CSRMatrix &>(other);
+        CSRMatrix r(row_, col_);
+        csr_binop_csr_canonical(*this, o, r, add);
+        assign_matrix(std::move(r), result);
+    } else if (is_a<DenseMatrix>(other)) {
+        DenseMatrix r = down_cast<const DenseMatrix &>(other);
+        for (unsigned i = 0; i < row_; i++) {
+            for (unsigned k = p_[i]; k < p_[i + 1]; k++) {
+                r.m_[i * col_ + j_[k]] = add(r.m_[i * col_ + j_[k]], x_[k]);
+            }
+        }
+        assign_matrix(std::move(r), result);
+    } else {
+        throw NotImplementedError("Not Implemented");
+    }
 }
 
+// The result can be a CSRMatrix or a DenseMatrix. The product of two CSR
+// matrices is computed in two passes: the first one finds the pattern of the
+// result, and the second one its entries. Both run over the rows in parallel.
 void CSRMatrix::mul_matrix(const MatrixBase &other, MatrixBase &result) const
 {
-    throw NotImplementedError("Not Implemented");
+    SYMENGINE_ASSERT(col_ == other.nrows());
+
+    if (is_a<CSRMatrix>(other)) {
+        const CSRMatrix &o = down_cast<const CSRMatrix &>(other);
+        CSRMatrix r(row_, o.col_);
+        csr_matmat_pass1(*this, o, r);
+        csr_matmat_pass2(*this, o, r);
+        assign_matrix(std::move(r), result);
+    } else if (is_a<DenseMatrix>(other)) {
+        const DenseMatrix &o = down_cast<const DenseMatrix &>(other);
+        const unsigned ncol = o.col_;
+        DenseMatrix r(row_, ncol);
+#pragma omp parallel for schedule(dynamic, 16)
+        for (unsigned i = 0; i < row_; i++) {
+            vec_basic terms;
+            for (unsigned c = 0; c < ncol; c++) {
+                terms.clear();
+                for (unsigned k = p_[i]; k < p_[i + 1]; k++) {
+                    terms.push_back(mul(x_[k], o.m_[j_[k] * ncol + c]));
+                }
+                r.m_[i * ncol + c] = SymEngine::add(terms);
+            }
+        }
+        assign_matrix(std::move(r), result);
+    } else {
+        throw NotImplementedError("Not Implemented");
+    }
 }
 
+// The product only has nonzero entries where this matrix has, so the result
+// is computed as a CSRMatrix in all cases.
 void CSRMatrix::elementwise_mul_matrix(const MatrixBase &other,
                                        MatrixBase &result) const
 {
-    if (is_a<CSRMatrix>(result)) {
+    SYMENGINE_ASSERT(row_ == other.nrows() and col_ == other.ncols());
+
+    if (is_a<CSRMatrix>(other)) {
         auto &o = down_cast<const CSRMatrix &>(other);
-        auto &r = down_cast<CSRMatrix &>(result);
+        CSRMatrix r(row_, col_);
         csr_binop_csr_canonical(*this, o, r, mul);
+        assign_matrix(std::move(r), result);
+    } else if (is_a<DenseMatrix>(other)) {
+        auto &o = down_cast<const DenseMatrix &>(other);
+        std::vector<unsigned> p(row_ + 1, 0), j;
+        vec_basic x;
+        for (unsigned i = 0; i < row_; i++) {
+            for (unsigned k = p_[i]; k < p_[i + 1]; k++) {
+                RCP<const Basic> e = mul(x_[k], o.m_[i * col_ + j_[k]]);
+                if (not is_true(is_zero(*e))) {
+                    j.push_back(j_[k]);
+                    x.push_back(e);
+                }
+            }
+            p[i + 1] = numeric_cast<unsigned>(j.size());
+        }
+        assign_matrix(
+            CSRMatrix(row_, col_, std::move(p), std::move(j), std::move(x)),
+            result);
+    } else {
+        throw NotImplementedError("Not Implemented");
     }
 }
 
-// Add a scalar
+// Add a scalar. The scalar is added to every entry, so the result is dense
+// unless `k` is zero.
 void CSRMatrix::add_scalar(const RCP<const Basic> &k, MatrixBase &result) const
 {
-    throw NotImplementedError("Not Implemented");
+    if (is_true(is_zero(*k))) {
+        assign_matrix(CSRMatrix(*this), result);
+        return;
+    }
+    DenseMatrix r(row_, col_);
+    for (unsigned i = 0; i < row_; i++) {
+        unsigned l = p_[i];
+        for (unsigned c = 0; c < col_; c++) {
+            if (l < p_[i + 1] and j_[l] == c) {
+                r.m_[i * col_ + c] = add(x_[l], k);
+                l++;
+            } else {
+                r.m_[i * col_ + c] = k;
+            }
+        }
+    }
+    assign_matrix(std::move(r), result);
 }
 
 // Multiply by a scalar
 void CSRMatrix::mul_scalar(const RCP<const Basic> &k, MatrixBase &result) const
 {
-    throw NotImplementedError("Not Implemented");
+    std::vector<unsigned> p(row_ + 1, 0), j;
+    vec_basic x;
+    if (not is_true(is_zero(*k))) {
+        j.reserve(j_.size());
+        x.reserve(x_.size());
+        for (unsigned i = 0; i < row_; i++) {
+            for (unsigned l = p_[i]; l < p_[i + 1]; l++) {
+                RCP<const Basic> e = mul(x_[l], k);
+                if (not is_true(is_zero(*e))) {
+                    j.push_back(j_[l]);
+                    x.push_back(e);
+                }
+            }
+            p[i + 1] = numeric_cast<unsigned>(j.size());
+        }
+    }
+    assign_matrix(
+        CSRMatrix(row_, col_, std::move(p), std::move(j), std::move(x)),
+        result);
 }
 
 // Matrix conjugate
@@ -309,7 +490,20 @@ void CSRMatrix::LDL(MatrixBase &L, MatrixBase &D) const
 // Solve Ax = b using LU factorization
 void CSRMatrix::LU_solve(const MatrixBase &b, MatrixBase &x) const
 {
-    throw NotImplementedError("Not Implemented");
+    if (is_a<DenseMatrix>(b) and is_a<DenseMatrix>(x)) {
+        const DenseMatrix &b_ = down_cast<const DenseMatrix &>(b);
+        DenseMatrix &x_ = down_cast<DenseMatrix &>(x);
+        SparseLUAnalysis analysis(*this);
+        SparseLU lu(analysis, *this);
+        if (lu.has_zero_pivot() and not analysis.is_structurally_singular()) {
+            // Use the dense algorithm, which chooses the pivots from the values
+            pivoted_LU_solve(csr_to_dense(*this), b_, x_);
+            return;
+        }
+        lu.solve(b_, x_);
+    } else {
+        throw NotImplementedError("Not Implemented");
+    }
 }
 
 // Fraction free LU factorization
@@ -495,21 +689,29 @@ CSRMatrix CSRMatrix::jacobian(const vec_basic &exprs, const vec_sym &x,
 {
     const unsigned nrows = static_cast<unsigned>(exprs.size());
     const unsigned ncols = static_cast<unsigned>(x.size());
+    // The nonzero entries of each row, computed in parallel. The derivatives
+    // w.r.t. the symbols that do not appear in a row are not computed.
+    std::vector<std::vector<unsigned>> row_j(nrows);
+    std::vector<vec_basic> row_elems(nrows);
+#pragma omp parallel for schedule(dynamic)
+    for (unsigned ri = 0; ri < nrows; ++ri) {
+        vec_basic row = diff(exprs[ri], x, diff_cache);
+        for (unsigned ci = 0; ci < ncols; ++ci) {
+            if (!is_true(is_zero(*row[ci]))) {
+                row_j[ri].push_back(ci);
+                row_elems[ri].emplace_back(std::move(row[ci]));
+            }
+        }
+    }
     std::vector<unsigned> p(1, 0), j;
     vec_basic elems;
     p.reserve(nrows + 1);
     j.reserve(nrows);
     elems.reserve(nrows);
     for (unsigned ri = 0; ri < nrows; ++ri) {
-        p.push_back(p.back());
-        for (unsigned ci = 0; ci < ncols; ++ci) {
-            auto elem = exprs[ri]->diff(x[ci], diff_cache);
-            if (!is_true(is_zero(*elem))) {
-                p.back()++;
-                j.push_back(ci);
-                elems.emplace_back(std::move(elem));
-            }
-        }
+        p.push_back(p.back() + static_cast<unsigned>(row_j[ri].size()));
+        j.insert(j.end(), row_j[ri].begin(), row_j[ri].end());
+        elems.insert(elems.end(), row_elems[ri].begin(), row_elems[ri].end());
     }
     return CSRMatrix(nrows, ncols, std::move(p), std::move(j),
                      std::move(elems));
@@ -531,29 +733,39 @@ CSRMatrix CSRMatrix::jacobian(const DenseMatrix &A, const DenseMatrix &x,
     return CSRMatrix::jacobian(A.m_, syms, diff_cache);
 }
 
+// Pass 1 computes the row pointer Cp[] of C = A*B, i.e. the number of
+// structurally nonzero entries of each row. The rows are counted in parallel.
 void csr_matmat_pass1(const CSRMatrix &A, const CSRMatrix &B, CSRMatrix &C)
 {
-    // method that uses O(n) temp storage
-    std::vector<unsigned> mask(A.col_, -1);
+    SYMENGINE_ASSERT(A.col_ == B.row_ and C.p_.size() == A.row_ + 1);
     C.p_[0] = 0;
 
-    unsigned nnz = 0;
-    for (unsigned i = 0; i < A.row_; i++) {
-        // npy_intp row_nnz = 0;
-        unsigned row_nnz = 0;
-
-        for (unsigned jj = A.p_[i]; jj < A.p_[i + 1]; jj++) {
-            unsigned j = A.j_[jj];
-            for (unsigned kk = B.p_[j]; kk < B.p_[j + 1]; kk++) {
-                unsigned k = B.j_[kk];
-                if (mask[k] != i) {
-                    mask[k] = i;
-                    row_nnz++;
+#pragma omp parallel
+    {
+        // method that uses O(n) temp storage per thread
+        std::vector<unsigned> mask(B.col_, -1);
+
+#pragma omp for schedule(dynamic, 64)
+        for (unsigned i = 0; i < A.row_; i++) {
+            unsigned row_nnz = 0;
+
+            for (unsigned jj = A.p_[i]; jj < A.p_[i + 1]; jj++) {
+                unsigned j = A.j_[jj];
+                for (unsigned kk = B.p_[j]; kk < B.p_[j + 1]; kk++) {
+                    unsigned k = B.j_[kk];
+                    if (mask[k] != i) {
+                        mask[k] = i;
+                        row_nnz++;
+                    }
                 }
             }
+            C.p_[i + 1] = row_nnz;
         }
+    }
 
-        unsigned next_nnz = nnz + row_nnz;
+    unsigned nnz = 0;
+    for (unsigned i = 0; i < A.row_; i++) {
+        unsigned next_nnz = nnz + C.p_[i + 1];
 
         // Addition overflow: http://www.cplusplus.com/articles/DE18T05o/
         if (next_nnz < nnz) {
@@ -566,58 +778,72 @@ void csr_matmat_pass1(const CSRMatrix &A, const CSRMatrix &B, CSRMatrix &C)
 }
 
 // Pass 2 computes CSR entries for matrix C = A*B using the
-// row pointer Cp[] computed in Pass 1.
+// row pointer Cp[] computed in Pass 1. Each row is computed in parallel in its
+// slot, with sorted columns. The entries that turn out to be zero are then
+// removed, so that C is in canonical format.
 void csr_matmat_pass2(const CSRMatrix &A, const CSRMatrix &B, CSRMatrix &C)
 {
-    std::vector<int> next(A.col_, -1);
-    vec_basic sums(A.col_, zero);
-
-    unsigned nnz = 0;
-
-    C.p_[0] = 0;
-
-    for (unsigned i = 0; i < A.row_; i++) {
-        int head = -2;
-        unsigned length = 0;
-
-        unsigned jj_start = A.p_[i];
-        unsigned jj_end = A.p_[i + 1];
-        for (unsigned jj = jj_start; jj < jj_end; jj++) {
-            unsigned j = A.j_[jj];
-            RCP<const Basic> v = A.x_[jj];
-
-            unsigned kk_start = B.p_[j];
-            unsigned kk_end = B.p_[j + 1];
-            for (unsigned kk = kk_start; kk < kk_end; kk++) {
-                unsigned k = B.j_[kk];
-
-                sums[k] = add(sums[k], mul(v, B.x_[kk]));
-
-                if (next[k] == -1) {
-                    next[k] = head;
-                    head = k;
-                    length++;
+    SYMENGINE_ASSERT(A.col_ == B.row_ and C.p_.size() == A.row_ + 1);
+    C.col_ = B.col_;
+    C.j_.resize(C.p_[A.row_]);
+    C.x_.resize(C.p_[A.row_]);
+    std::vector<unsigned> row_nnz(A.row_);
+
+#pragma omp parallel
+    {
+        std::vector<int> next(B.col_, -1);
+        vec_basic sums(B.col_, zero);
+        std::vector<unsigned> cols;
+
+#pragma omp for schedule(dynamic, 16)
+        for (unsigned i = 0; i < A.row_; i++) {
+            cols.clear();
+
+            for (unsigned jj = A.p_[i]; jj < A.p_[i + 1]; jj++) {
+                unsigned j = A.j_[jj];
+                const RCP<const Basic> &v = A.x_[jj];
+
+                for (unsigned kk = B.p_[j]; kk < B.p_[j + 1]; kk++) {
+                    unsigned k = B.j_[kk];
+
+                    sums[k] = add(sums[k], mul(v, B.x_[kk]));
+
+                    if (next[k] == -1) {
+                        next[k] = 0;
+                        cols.push_back(k);
+                    }
                 }
             }
-        }
-
-        for (unsigned jj = 0; jj < length; jj++) {
 
-            if (!is_true(is_zero(*sums[head]))) {
-                C.j_[nnz] = head;
-                C.x_[nnz] = sums[head];
-                nnz++;
+            std::sort(cols.begin(), cols.end());
+            unsigned nnz = C.p_[i];
+            for (unsigned k : cols) {
+                if (!is_true(is_zero(*sums[k]))) {
+                    C.j_[nnz] = k;
+                    C.x_[nnz] = sums[k];
+                    nnz++;
+                }
+                next[k] = -1; // clear arrays
+                sums[k] = zero;
             }
-
-            unsigned temp = head;
-            head = next[head];
-
-            next[temp] = -1; // clear arrays
-            sums[temp] = zero;
+            row_nnz[i] = nnz - C.p_[i];
         }
+    }
 
-        C.p_[i + 1] = nnz;
+    // Remove the gaps left by the zero entries
+    unsigned nnz = 0;
+    for (unsigned i = 0; i < A.row_; i++) {
+        unsigned start = C.p_[i];
+        for (unsigned k = 0; k < row_nnz[i]; k++) {
+            C.j_[nnz + k] = C.j_[start + k];
+            C.x_[nnz + k] = C.x_[start + k];
+        }
+        nnz += row_nnz[i];
+        C.p_[i] = nnz - row_nnz[i];
     }
+    C.p_[A.row_] = nnz;
+    C.j_.resize(nnz);
+    C.x_.resize(nnz);
 }
 
 // Extract main diagonal of CSR matrix A
@@ -773,4 +999,356 @@ void csr_binop_csr_canonical(
         CSRMatrix::csr_sum_duplicates(C.p_, C.j_, C.x_, A.row_);
 }
 
+// ----------------------------- Sparse LU ------------------------------------
+
+namespace
+{
+
+// Finds a row for each column such that the entry in that row and column is
+// nonzero, using augmenting paths. The result is stored in `row_of_col`.
+// Returns false if no such assignment exists, i.e. if the matrix is
+// structurally singular.
+bool maximum_transversal(unsigned n, const std::vector<unsigned> &p,
+                         const std::vector<unsigned> &j,
+                         std::vector<unsigned> &row_of_col)
+{
+    row_of_col.assign(n, n);
+    std::vector<unsigned> visited(n, n), next(n), via(n), stack;
+    for (unsigned r0 = 0; r0 < n; r0++) {
+        bool found = false;
+        // Try a free column first
+        for (unsigned k = p[r0]; k < p[r0 + 1]; k++) {
+            if (row_of_col[j[k]] == n) {
+                row_of_col[j[k]] = r0;
+                found = true;
+                break;
+            }
+        }
+        if (found)
+            continue;
+        // Depth first search of an augmenting path
+        stack.assign(1, r0);
+        next[r0] = p[r0];
+        while (not stack.empty()) {
+            unsigned r = stack.back();
+            if (next[r] == p[r + 1]) {
+                stack.pop_back();
+                continue;
+            }
+            unsigned c = j[next[r]++];
+            if (visited[c] == r0)
+                continue;
+            visited[c] = r0;
+            if (row_of_col[c] == n) {
+                // Shift the assignments along the path
+                for (size_t i = stack.size(); i-- > 0;) {
+                    row_of_col[c] = stack[i];
+                    c = via[stack[i]];
+                }
+                found = true;
+                break;
+            }
+            unsigned r2 = row_of_col[c];
+            via[r2] = c;
+            next[r2] = p[r2];
+            stack.push_back(r2);
+        }
+        if (not found)
+            return false;
+    }
+    return true;
+}
+
+// Minimum degree ordering of the graph given by the adjacency sets `adj`. The
+// neighbours of an eliminated vertex are connected to each other, like the
+// fill-in of Gaussian elimination. Ties are broken by the smallest index.
+std::vector<unsigned> minimum_degree_ordering(
+    std::vector<std::set<unsigned>> &adj)
+{
+    const unsigned n = numeric_cast<unsigned>(adj.size());
+    typedef std::pair<size_t, unsigned> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+    for (unsigned v = 0; v < n; v++) {
+        queue.push({adj[v].size(), v});
+    }
+    std::vector<bool> eliminated(n, false);
+    std::vector<unsigned> order;
+    order.reserve(n);
+    while (order.size() < n) {
+        entry e = queue.top();
+        queue.pop();
+        unsigned v = e.second;
+        // Skip entries whose degree is out of date
+        if (eliminated[v] or e.first != adj[v].size())
+            continue;
+        eliminated[v] = true;
+        order.push_back(v);
+        std::vector<unsigned> nbrs(adj[v].begin(), adj[v].end());
+        for (unsigned u : nbrs) {
+            adj[u].erase(v);
+            for (unsigned w : nbrs) {
+                if (w != u)
+                    adj[u].insert(w);
+            }
+        }
+        for (unsigned u : nbrs) {
+            queue.push({adj[u].size(), u});
+        }
+        adj[v].clear();
+    }
+    return order;
+}
+
+// Returns 1 if the permutation `perm` is even and -1 otherwise
+int permutation_sign(const std::vector<unsigned> &perm)
+{
+    std::vector<bool> seen(perm.size(), false);
+    int sign = 1;
+    for (size_t i = 0; i < perm.size(); i++) {
+        if (seen[i])
+            continue;
+        size_t len = 0;
+        for (size_t k = i; not seen[k]; k = perm[k]) {
+            seen[k] = true;
+            len++;
+        }
+        if (len % 2 == 0)
+            sign = -sign;
+    }
+    return sign;
+}
+
+} // namespace
+
+SparseLUAnalysis::SparseLUAnalysis(const CSRMatrix &A)
+    : n_(A.row_), structurally_singular_(false), a_p_(A.p_), a_j_(A.j_)
+{
+    SYMENGINE_ASSERT(A.row_ == A.col_);
+    const unsigned n = n_;
+
+    // Permute the rows so that the diagonal is structurally nonzero
+    std::vector<unsigned> row_of_col;
+    if (not maximum_transversal(n, a_p_, a_j_, row_of_col)) {
+        structurally_singular_ = true;
+        return;
+    }
+
+    // Fill reducing ordering of the graph of B + B^T, where B is A with the
+    // rows permuted. The same permutation is applied to the rows and columns
+    // of B, so that its diagonal stays nonzero.
+    std::vector<std::set<unsigned>> adj(n);
+    for (unsigned c = 0; c < n; c++) {
+        unsigned r = row_of_col[c];
+        for (unsigned k = a_p_[r]; k < a_p_[r + 1]; k++) {
+            if (a_j_[k] != c) {
+                adj[c].insert(a_j_[k]);
+                adj[a_j_[k]].insert(c);
+            }
+        }
+    }
+    col_perm_ = minimum_degree_ordering(adj);
+    row_perm_.resize(n);
+    std::vector<unsigned> col_pos(n), row_pos(n);
+    for (unsigned i = 0; i < n; i++) {
+        row_perm_[i] = row_of_col[col_perm_[i]];
+        col_pos[col_perm_[i]] = i;
+        row_pos[row_perm_[i]] = i;
+    }
+
+    // Pattern of L + U of the permuted matrix C. The pattern of row `i` is the
+    // pattern of row `i` of C, together with the pattern of U in the rows `k`
+    // that eliminate its entries in column `k < i`.
+    p_.assign(n + 1, 0);
+    diag_.resize(n);
+    std::vector<unsigned> mark(n, n), cols;
+    std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>>
+        lower;
+    for (unsigned i = 0; i < n; i++) {
+        unsigned r = row_perm_[i];
+        cols.clear();
+        for (unsigned k = a_p_[r]; k < a_p_[r + 1]; k++) {
+            unsigned c = col_pos[a_j_[k]];
+            mark[c] = i;
+            cols.push_back(c);
+            if (c < i)
+                lower.push(c);
+        }
+        // The columns are processed in increasing order, so that the fill-in
+        // from a row is taken into account for the following rows
+        while (not lower.empty()) {
+            unsigned k = lower.top();
+            lower.pop();
+            for (unsigned t = diag_[k] + 1; t < p_[k + 1]; t++) {
+                unsigned c = j_[t];
+                if (mark[c] != i) {
+                    mark[c] = i;
+                    cols.push_back(c);
+                    if (c < i)
+                        lower.push(c);
+                }
+            }
+        }
+        std::sort(cols.begin(), cols.end());
+        diag_[i] = p_[i]
+                   + numeric_cast<unsigned>(
+                       std::lower_bound(cols.begin(), cols.end(), i)
+                       - cols.begin());
+        j_.insert(j_.end(), cols.begin(), cols.end());
+        p_[i + 1] = numeric_cast<unsigned>(j_.size());
+        SYMENGINE_ASSERT(j_[diag_[i]] == i);
+    }
+
+    // Position of each entry of A in the pattern of L + U
+    scatter_.resize(a_j_.size());
+    for (unsigned r = 0; r < n; r++) {
+        unsigned i = row_pos[r];
+        for (unsigned k = a_p_[r]; k < a_p_[r + 1]; k++) {
+            auto it = std::lower_bound(j_.begin() + p_[i],
+                                       j_.begin() + p_[i + 1],
+                                       col_pos[a_j_[k]]);
+            scatter_[k] = numeric_cast<unsigned>(it - j_.begin());
+        }
+    }
+}
+
+bool SparseLUAnalysis::matches(const CSRMatrix &A) const
+{
+    return A.row_ == n_ and A.col_ == n_ and A.p_ == a_p_ and A.j_ == a_j_;
+}
+
+/*
+ * The factorization is the fraction free LU of Bareiss applied to the permuted
+ * matrix C, computed one row at a time. The value of row `i` after step `k` is
+ *
+ *   a_ij^(k) = (p_k a_ij^(k-1) - a_ik^(k-1) a_kj^(k-1)) / p_(k-1),
+ *
+ * where p_k is the k-th pivot and p_(-1) = 1. When a_ik is zero, this reduces
+ * to a_ij^(k) = p_k a_ij^(k-1) / p_(k-1), so that a row which was last
+ * updated at step s satisfies a_ij^(k-1) = a_ij^(s) p_(k-1) / p_s. This gives
+ *
+ *   a_ij^(k) = (p_k a_ij^(s) - a_ik^(s) a_kj^(k-1)) / p_s,
+ *
+ * so that a row is only updated at the steps where it has a nonzero entry in
+ * the pivot column. The entries of L are stored as a_ik^(s), and the rows of U
+ * are brought to step `i - 1` once they are finished.
+ */
+SparseLU::SparseLU(const SparseLUAnalysis &analysis, const CSRMatrix &A)
+    : analysis_(analysis), zero_pivot_(false)
+{
+    if (not analysis.matches(A)) {
+        throw SymEngineException(
+            "The sparsity pattern of the matrix does not match the analysis");
+    }
+    if (analysis.structurally_singular_)
+        return;
+
+    const std::vector<unsigned> &p = analysis.p_, &j = analysis.j_,
+                                &diag = analysis.diag_;
+    const unsigned n = analysis.n_;
+    x_.assign(j.size(), zero);
+    for (size_t k = 0; k < A.x_.size(); k++) {
+        x_[analysis.scatter_[k]] = A.x_[k];
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        // The last step at which the row was updated, n for none
+        unsigned s = n;
+        for (unsigned t = p[i]; t < diag[i]; t++) {
+            const RCP<const Basic> l = x_[t];
+            if (eq(*l, *zero))
+                continue;
+            const unsigned k = j[t];
+            const RCP<const Basic> &pk = x_[diag[k]];
+            // Merge the rest of row `i` with the U part of row `k`
+            unsigned u = diag[k] + 1;
+            for (unsigned v = t + 1; v < p[i + 1]; v++) {
+                RCP<const Basic> d = mul(pk, x_[v]);
+                while (u < p[k + 1] and j[u] < j[v])
+                    u++;
+                if (u < p[k + 1] and j[u] == j[v])
+                    d = sub(d, mul(l, x_[u]));
+                if (s != n)
+                    d = div(d, x_[diag[s]]);
+                x_[v] = d;
+            }
+            s = k;
+        }
+        if (i > 0 and s != i - 1) {
+            // Bring the row to step `i - 1`
+            for (unsigned v = diag[i]; v < p[i + 1]; v++) {
+                x_[v] = mul(x_[v], x_[diag[i - 1]]);
+                if (s != n)
+                    x_[v] = div(x_[v], x_[diag[s]]);
+            }
+        }
+        if (is_true(is_zero(*x_[diag[i]]))) {
+            zero_pivot_ = true;
+            return;
+        }
+    }
+}
+
+RCP<const Basic> SparseLU::det() const
+{
+    if (analysis_.structurally_singular_)
+        return zero;
+    if (zero_pivot_)
+        throw SymEngineException("Zero pivot in the sparse LU factorization");
+    const unsigned n = analysis_.n_;
+    if (n == 0)
+        return one;
+    RCP<const Basic> d = x_[analysis_.diag_[n - 1]];
+    if (permutation_sign(analysis_.row_perm_)
+            * permutation_sign(analysis_.col_perm_)
+        < 0)
+        d = neg(d);
+    return d;
+}
+
+void SparseLU::solve(const DenseMatrix &b, DenseMatrix &x) const
+{
+    const unsigned n = analysis_.n_;
+    SYMENGINE_ASSERT(b.nrows() == n);
+    SYMENGINE_ASSERT(x.nrows() == n and x.ncols() == b.ncols());
+    if (analysis_.structurally_singular_)
+        throw SymEngineException("Matrix is singular");
+    if (zero_pivot_)
+        throw SymEngineException("Zero pivot in the sparse LU factorization");
+
+    const std::vector<unsigned> &p = analysis_.p_, &j = analysis_.j_,
+                                &diag = analysis_.diag_;
+    vec_basic y(n);
+    for (unsigned c = 0; c < b.ncols(); c++) {
+        // Apply the same elimination steps to the right hand side
+        for (unsigned i = 0; i < n; i++) {
+            RCP<const Basic> yi = b.get(analysis_.row_perm_[i], c);
+            unsigned s = n;
+            for (unsigned t = p[i]; t < diag[i]; t++) {
+                if (eq(*x_[t], *zero))
+                    continue;
+                const unsigned k = j[t];
+                yi = sub(mul(x_[diag[k]], yi), mul(x_[t], y[k]));
+                if (s != n)
+                    yi = div(yi, x_[diag[s]]);
+                s = k;
+            }
+            if (i > 0 and s != i - 1) {
+                yi = mul(yi, x_[diag[i - 1]]);
+                if (s != n)
+                    yi = div(yi, x_[diag[s]]);
+            }
+            y[i] = yi;
+        }
+        // Back substitution, reusing `y` for the solution
+        for (unsigned i = n; i-- > 0;) {
+            RCP<const Basic> yi = y[i];
+            for (unsigned t = diag[i] + 1; t < p[i + 1]; t++) {
+                yi = sub(yi, mul(x_[t], y[j[t]]));
+            }
+            y[i] = div(yi, x_[diag[i]]);
+            x.set(analysis_.col_perm_[i], c, y[i]);
+        }
+    }
+}
+
 } // namespace SymEngine
@@ -7,6 +7,7 @@
 #define SYMENGINE_SYMBOL_H
 
 #include <symengine/basic.h>
+#include <symengine/intern.h>
 
 namespace SymEngine
 {
@@ -86,7 +87,7 @@ public:
 //! inline version to return `Symbol`
 inline RCP<const Symbol> symbol(const std::string &name)
 {
-    return make_rcp<const Symbol>(name);
+    return make_interned<Symbol>(name);
 }
 
 //! inline version to return `Dummy`
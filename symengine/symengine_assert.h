@@ -5,6 +5,9 @@
 // so that there is no effect with NDEBUG
 #if defined(WITH_SYMENGINE_ASSERT)
 
+#include <cstdlib>
+#include <iostream>
+
 #if !defined(SYMENGINE_ASSERT)
 #define stringize(s) #s
 #define XSTR(s) stringize(s)
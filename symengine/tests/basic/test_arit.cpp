@@ -546,6 +546,41 @@ TEST_CASE("Mul: arit", "[arit]")
     REQUIRE(eq(*exp(s2), *s3));
 }
 
+TEST_CASE("Add compare: arit", "[arit]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+
+    RCP<const Basic> a = add(add(x, y), mul(integer(2), z));
+    RCP<const Basic> b = add(add(x, y), mul(integer(3), z));
+    RCP<const Basic> c = add(add(x, y), mul(integer(2), w));
+
+    // The cached order agrees with comparing the terms as sorted maps
+    for (const auto &p : {std::make_pair(a, b), std::make_pair(a, c),
+                          std::make_pair(b, c)}) {
+        const Add &u = down_cast<const Add &>(*p.first);
+        const Add &v = down_cast<const Add &>(*p.second);
+        SymEngine::map_basic_num ud(u.get_dict().begin(), u.get_dict().end());
+        SymEngine::map_basic_num vd(v.get_dict().begin(), v.get_dict().end());
+        int expected = SymEngine::unified_compare(ud, vd);
+        REQUIRE(expected != 0);
+        REQUIRE(u.compare(v) == expected);
+        REQUIRE(v.compare(u) == -expected);
+        // Second call uses the cached terms
+        REQUIRE(u.compare(v) == expected);
+    }
+
+    RCP<const Basic> a2 = add(mul(integer(2), z), add(y, x));
+    REQUIRE(a->compare(*a2) == 0);
+    REQUIRE(a2->compare(*a) == 0);
+
+    const Add &s = down_cast<const Add &>(*a);
+    REQUIRE(s.get_sorted_terms().size() == 3);
+    REQUIRE(&s.get_sorted_terms() == &s.get_sorted_terms());
+}
+
 TEST_CASE("Sub: arit", "[arit]")
 {
     RCP<const Basic> x = symbol("x");
@@ -1485,3 +1520,42 @@ TEST_CASE("Expand3: arit", "[arit]")
                      .count()
               << "ms" << std::endl;
 }
+
+TEST_CASE("Expand parallel: arit", "[arit]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+    RCP<const Basic> e, f, r1, r2;
+
+    RCP<const Basic> s = add(add(add(add(x, y), z), w), one);
+
+    // (x + y + z + w + 1)**12 has 1820 terms, so the multinomial expansion
+    // is split among threads
+    e = pow(s, integer(12));
+    r1 = expand(e);
+    for (unsigned nthreads : {1u, 2u, 3u, 8u}) {
+        r2 = expand(e, true, nthreads);
+        REQUIRE(eq(*r1, *r2));
+    }
+
+    // A product of two sums with 35 and 36 terms
+    e = pow(s, integer(3));
+    f = mul(e, add(e, mul(integer(3), w)));
+    r1 = expand(f);
+    for (unsigned nthreads : {2u, 5u}) {
+        r2 = expand(f, true, nthreads);
+        REQUIRE(eq(*r1, *r2));
+    }
+
+    // Small expressions stay on the serial path
+    e = mul(add(x, y), add(x, mul(integer(2), z)));
+    r2 = expand(e, true, 4);
+    REQUIRE(eq(*r2, *expand(e)));
+
+    // Non-deep expansion leaves the arguments of functions alone
+    e = mul(sin(pow(add(x, y), integer(2))), add(x, one));
+    r1 = expand(e, false, 4);
+    REQUIRE(eq(*r1, *expand(e, false)));
+}
@@ -4,11 +4,15 @@
 #include <symengine/eval_double.h>
 #include <symengine/derivative.h>
 #include <symengine/symengine_exception.h>
+#include <symengine/pool_allocator.h>
 #include <cstring>
 
 using SymEngine::Add;
+using SymEngine::ArgView;
 using SymEngine::atoms;
 using SymEngine::Basic;
+using SymEngine::BaseVisitor;
+using SymEngine::clear_interned;
 using SymEngine::coeff;
 using SymEngine::Complex;
 using SymEngine::complex_double;
@@ -16,8 +20,10 @@ using SymEngine::ComplexInf;
 using SymEngine::diff;
 using SymEngine::down_cast;
 using SymEngine::EulerGamma;
+using SymEngine::ExprArena;
 using SymEngine::free_symbols;
 using SymEngine::function_symbol;
+using SymEngine::gradient;
 using SymEngine::FunctionSymbol;
 using SymEngine::has_basic;
 using SymEngine::has_symbol;
@@ -26,6 +32,9 @@ using SymEngine::Inf;
 using SymEngine::infty;
 using SymEngine::Integer;
 using SymEngine::integer;
+using SymEngine::interned_count;
+using SymEngine::interning_enabled;
+using SymEngine::InterningScope;
 using SymEngine::is_a;
 using SymEngine::make_rcp;
 using SymEngine::map_basic_basic;
@@ -36,6 +45,7 @@ using SymEngine::Mul;
 using SymEngine::multiset_basic;
 using SymEngine::Nan;
 using SymEngine::NegInf;
+using SymEngine::NodePool;
 using SymEngine::NotImplementedError;
 using SymEngine::Number;
 using SymEngine::one;
@@ -47,8 +57,11 @@ using SymEngine::rational_class;
 using SymEngine::RCP;
 using SymEngine::rcp_static_cast;
 using SymEngine::real_double;
+using SymEngine::postorder_traversal_stop;
+using SymEngine::preorder_traversal_stop;
 using SymEngine::sdiff;
 using SymEngine::set_basic;
+using SymEngine::StopVisitor;
 using SymEngine::Symbol;
 using SymEngine::symbol;
 using SymEngine::umap_basic_basic;
@@ -600,6 +613,62 @@ TEST_CASE("Diff: Basic", "[basic]")
     REQUIRE(eq(*r1, *r2));
 }
 
+TEST_CASE("gradient: Basic", "[basic]")
+{
+    RCP<const Symbol> x = symbol("x");
+    RCP<const Symbol> y = symbol("y");
+    RCP<const Symbol> z = symbol("z");
+    RCP<const Basic> r1;
+    vec_basic g;
+
+    r1 = add(mul(integer(3), pow(x, integer(2))), mul(x, y));
+    g = gradient(r1, {x, y, z});
+    REQUIRE(g.size() == 3);
+    REQUIRE(eq(*g[0], *add(mul(integer(6), x), y)));
+    REQUIRE(eq(*g[1], *x));
+    REQUIRE(eq(*g[2], *zero));
+
+    r1 = sin(mul(x, y));
+    g = gradient(r1, {x, y});
+    REQUIRE(eq(*g[0], *r1->diff(x)));
+    REQUIRE(eq(*g[1], *r1->diff(y)));
+
+    // Symbolic exponents, functions of several arguments, an opaque
+    // Derivative, and a symbol given twice
+    RCP<const Basic> f = function_symbol("f", {x, mul(x, z)});
+    vec_basic exprs = {
+        pow(x, y),
+        mul(pow(x, y), pow(y, x)),
+        add(mul(integer(2), f), log(add(x, z))),
+        mul(function_symbol("g", x)->diff(x), y),
+        atan2(mul(x, y), add(x, z)),
+    };
+    for (const auto &e : exprs) {
+        g = gradient(e, {x, y, z, x});
+        REQUIRE(eq(*g[0], *g[3]));
+        for (unsigned i = 0; i < 3; i++) {
+            RCP<const Symbol> s = i == 0 ? x : (i == 1 ? y : z);
+            // Rational functions are only equal up to cancellation, so the
+            // difference is checked at a point
+            RCP<const Basic> d = expand(sub(g[i], e->diff(s)));
+            d = d->subs({{x, integer(2)}, {y, integer(3)}, {z, integer(5)}});
+            REQUIRE(eq(*expand(d), *zero));
+        }
+    }
+
+    // Shared subexpressions are only differentiated once
+    RCP<const Basic> t = sin(add(x, y));
+    r1 = add(mul(t, pow(t, integer(2))), mul(t, z));
+    g = gradient(r1, {x, y, z});
+    REQUIRE(eq(*expand(sub(g[0], r1->diff(x))), *zero));
+    REQUIRE(eq(*expand(sub(g[1], r1->diff(y))), *zero));
+    REQUIRE(eq(*g[2], *t));
+
+    g = gradient(integer(5), {x});
+    REQUIRE(eq(*g[0], *zero));
+    REQUIRE(gradient(x, {}).empty());
+}
+
 TEST_CASE("compare: Basic", "[basic]")
 {
     RCP<const Basic> r1, r2;
@@ -999,6 +1068,15 @@ TEST_CASE("has_symbol: Basic", "[basic]")
     REQUIRE(has_symbol(*r1, *x));
     REQUIRE(has_symbol(*r1, *y));
     REQUIRE(not has_symbol(*r1, *z));
+
+    RCP<const Basic> f = function_symbol("f", mul(integer(3), z));
+    r1 = add(mul(integer(2), pow(x, y)), mul(integer(-5), f));
+    REQUIRE(has_symbol(*r1, *x));
+    REQUIRE(has_symbol(*r1, *y));
+    REQUIRE(has_symbol(*r1, *z));
+    REQUIRE(has_symbol(*r1, *f));
+    REQUIRE(not has_symbol(*r1, *symbol("w")));
+    REQUIRE(not has_symbol(*r1, *function_symbol("f", z)));
 }
 
 TEST_CASE("coeff: Basic", "[basic]")
@@ -1167,3 +1245,250 @@ TEST_CASE("args: Basic", "[basic]")
     r1 = log(pi);
     REQUIRE(vec_basic_eq_perm(r1->get_args(), {pi}));
 }
+
+TEST_CASE("for_each_arg: Basic", "[basic]")
+{
+    RCP<const Symbol> x, y, z;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+
+    vec_basic exprs = {add(add(x, mul(integer(2), y)), integer(3)),
+                       add(x, pow(y, integer(2))),
+                       mul(mul(integer(3), x), pow(y, z)),
+                       mul(x, y),
+                       pow(x, y),
+                       sin(x),
+                       atan2(x, y),
+                       SymEngine::max({x, y, z}),
+                       function_symbol("f", {x, y}),
+                       Eq(x, y),
+                       x,
+                       integer(2),
+                       pi};
+    for (const auto &e : exprs) {
+        vec_basic args;
+        REQUIRE(e->for_each_arg([&](const RCP<const Basic> &p) {
+            args.push_back(p);
+            return true;
+        }));
+        REQUIRE(unified_eq(args, e->get_args()));
+
+        // Stopping after the first argument
+        args.clear();
+        bool done = e->for_each_arg([&](const RCP<const Basic> &p) {
+            args.push_back(p);
+            return false;
+        });
+        vec_basic first;
+        if (not e->get_args().empty()) {
+            first.push_back(e->get_args()[0]);
+        }
+        REQUIRE(done == first.empty());
+        REQUIRE(unified_eq(args, first));
+    }
+}
+
+TEST_CASE("ArgView: Basic", "[basic]")
+{
+    RCP<const Symbol> x, y, z;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+
+    vec_basic exprs = {add(add(x, mul(integer(2), y)), integer(3)),
+                       add(mul(integer(-3), pow(x, integer(2))),
+                           mul(Rational::from_two_ints(1, 2), mul(x, y))),
+                       add(x, pow(y, integer(2))),
+                       mul(mul(integer(3), x), pow(y, z)),
+                       mul(x, pow(add(x, y), integer(-1))),
+                       pow(x, y),
+                       sin(add(mul(integer(2), x), y)),
+                       function_symbol("f", {x, y}),
+                       x};
+    for (const auto &e : exprs) {
+        vec_basic args = e->get_args();
+        std::vector<ArgView> views;
+        REQUIRE(ArgView(e).for_each_arg([&](const ArgView &p) {
+            views.push_back(p);
+            return true;
+        }));
+        REQUIRE(views.size() == args.size());
+        for (size_t i = 0; i < args.size(); i++) {
+            const ArgView &v = views[i];
+            REQUIRE(eq(*v.get(), *args[i]));
+            REQUIRE(v.get_type_code() == args[i]->get_type_code());
+            REQUIRE(v.hash() == args[i]->hash());
+            REQUIRE(v.equals(ArgView(args[i])));
+            REQUIRE(ArgView(args[i]).equals(v));
+            for (size_t j = 0; j < args.size(); j++) {
+                REQUIRE(v.equals(views[j]) == eq(*args[i], *args[j]));
+            }
+
+            // The arguments of an argument
+            vec_basic args2;
+            REQUIRE(v.for_each_arg([&](const ArgView &p) {
+                args2.push_back(p.get());
+                return true;
+            }));
+            REQUIRE(unified_eq(args2, args[i]->get_args()));
+        }
+    }
+
+    // The views of the terms keep the Add alive
+    std::vector<ArgView> terms;
+    ArgView(add(mul(integer(2), x), mul(integer(3), y)))
+        .for_each_arg([&](const ArgView &p) {
+            terms.push_back(p);
+            return true;
+        });
+    REQUIRE(terms.size() == 2);
+    for (const auto &v : terms) {
+        REQUIRE(not v.is_stored());
+        REQUIRE(v.get()->hash() == v.hash());
+    }
+
+    // A term is equal to a Mul that is stored elsewhere
+    RCP<const Basic> t = mul(integer(2), mul(x, y));
+    RCP<const Basic> e = add(t, z);
+    std::vector<ArgView> views;
+    ArgView(e).for_each_arg([&](const ArgView &p) {
+        views.push_back(p);
+        return true;
+    });
+    size_t n = 0;
+    for (const auto &v : views) {
+        if (not v.is_stored()) {
+            REQUIRE(v.equals(ArgView(t)));
+            n++;
+        }
+    }
+    REQUIRE(n == 1);
+}
+
+// Counts the nodes it visits, and stops at `last_`
+class CountUntilVisitor : public BaseVisitor<CountUntilVisitor, StopVisitor>
+{
+public:
+    RCP<const Basic> last_;
+    size_t count_ = 0;
+
+    CountUntilVisitor(const RCP<const Basic> &last) : last_(last)
+    {
+        stop_ = false;
+    }
+    void bvisit(const Basic &x)
+    {
+        count_++;
+        if (eq(x, *last_)) {
+            stop_ = true;
+        }
+    }
+};
+
+TEST_CASE("traversal_stop: Basic", "[basic]")
+{
+    RCP<const Symbol> x, y, z;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+    RCP<const Basic> e = function_symbol("f", {x, y, sin(z)});
+
+    CountUntilVisitor v1(y);
+    preorder_traversal_stop(*e, v1);
+    REQUIRE(v1.count_ == 3);
+
+    CountUntilVisitor v2(y);
+    postorder_traversal_stop(*e, v2);
+    REQUIRE(v2.count_ == 2);
+
+    CountUntilVisitor v3(z);
+    postorder_traversal_stop(*e, v3);
+    REQUIRE(v3.count_ == 3);
+}
+
+TEST_CASE("interning: Basic", "[basic]")
+{
+    RCP<const Basic> r1, r2;
+    RCP<const Symbol> x, y;
+
+    REQUIRE(not interning_enabled());
+    x = symbol("x");
+    REQUIRE(x.get() != symbol("x").get());
+    {
+        InterningScope scope;
+        REQUIRE(interning_enabled());
+        x = symbol("x");
+        y = symbol("y");
+        REQUIRE(x.get() == symbol("x").get());
+        REQUIRE(x.get() != y.get());
+
+        r1 = add(mul(integer(2), x), pow(y, integer(3)));
+        r2 = add(pow(y, integer(3)), mul(x, integer(2)));
+        REQUIRE(r1.get() == r2.get());
+        REQUIRE(pow(x, y).get() == pow(x, y).get());
+        REQUIRE(mul(x, y).get() == mul(y, x).get());
+        REQUIRE(interned_count() > 0);
+    }
+    REQUIRE(not interning_enabled());
+    REQUIRE(symbol("y").get() != y.get());
+    REQUIRE(eq(*symbol("y"), *y));
+
+    clear_interned();
+    REQUIRE(interned_count() == 0);
+    // Nodes obtained while interning was enabled are still valid
+    REQUIRE(eq(*r1, *add(mul(integer(2), x), pow(y, integer(3)))));
+}
+
+TEST_CASE("NodePool: Basic", "[basic]")
+{
+    NodePool pool;
+    std::vector<void *> blocks;
+    for (size_t i = 1; i <= 1000; i++) {
+        void *p = pool.allocate(i % NodePool::max_block_size + 1);
+        REQUIRE(reinterpret_cast<uintptr_t>(p) % NodePool::granularity == 0);
+        blocks.push_back(p);
+    }
+    REQUIRE(pool.live_blocks() == 1000);
+    for (size_t i = 1; i <= 1000; i++) {
+        NodePool::deallocate(blocks[i - 1], i % NodePool::max_block_size + 1);
+    }
+    REQUIRE(pool.live_blocks() == 0);
+    size_t chunks = pool.num_chunks();
+
+    // Freed blocks are reused
+    void *p = pool.allocate(40);
+    NodePool::deallocate(p, 40);
+    REQUIRE(pool.allocate(40) == p);
+    NodePool::deallocate(p, 40);
+    REQUIRE(pool.num_chunks() == chunks);
+
+    // Large blocks bypass the pool
+    p = pool.allocate(2 * NodePool::max_block_size);
+    REQUIRE(pool.live_blocks() == 0);
+    NodePool::deallocate(p, 2 * NodePool::max_block_size);
+}
+
+TEST_CASE("ExprArena: Basic", "[basic]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> r1, r2;
+    {
+        ExprArena arena;
+        REQUIRE(&SymEngine::current_node_pool() == &arena.pool());
+        {
+            ExprArena inner;
+            REQUIRE(&SymEngine::current_node_pool() == &inner.pool());
+        }
+        REQUIRE(&SymEngine::current_node_pool() == &arena.pool());
+        r1 = expand(pow(add(x, integer(1)), integer(10)));
+        r2 = r1->diff(symbol("x"));
+#ifdef WITH_SYMENGINE_POOL_ALLOCATOR
+        REQUIRE(arena.pool().live_blocks() > 0);
+#endif
+    }
+    // Nodes that outlive the arena stay valid
+    REQUIRE(eq(*r2, *expand(mul(integer(10),
+                                pow(add(x, integer(1)), integer(9))))));
+    r1 = r2 = RCP<const Basic>();
+}
@@ -6,6 +6,7 @@
 #include <symengine/mul.h>
 #include <symengine/functions.h>
 #include <symengine/logic.h>
+#include <symengine/subs.h>
 
 using SymEngine::add;
 using SymEngine::Basic;
@@ -332,6 +333,58 @@ TEST_CASE("CSE: simple", "[cse]")
     }
 }
 
+TEST_CASE("CSE: match budget", "[cse]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    RCP<const Basic> w = symbol("w");
+
+    // With a budget of 1, the Adds are not matched against each other, but
+    // the repeated subexpressions are still eliminated
+    auto e1 = add(add(x, y), z);
+    auto e2 = add(add(x, y), w);
+    auto e3 = sin(e1);
+    vec_pair substs, substs0;
+    vec_basic reduced, reduced0;
+    cse(substs, reduced, {e1, e2, e3}, 1);
+    cse(substs0, reduced0, {e1, e2, e3}, 0);
+    REQUIRE(substs.size() == 1);
+    REQUIRE(unified_eq(substs[0].second, e1));
+    REQUIRE(substs0.size() == 2);
+    REQUIRE(unified_eq(substs0[0].second, add(x, y)));
+
+    // Many Adds that share arguments, and a deep expression, all give the
+    // expressions back once the replacements are substituted
+    vec_basic syms, exprs;
+    for (unsigned i = 0; i < 20; i++) {
+        syms.push_back(symbol("s" + std::to_string(i)));
+    }
+    for (unsigned i = 0; i < 200; i++) {
+        exprs.push_back(add({syms[i % 20], syms[(i * 7 + 1) % 20],
+                             syms[(i * 3 + 2) % 20], integer(i)}));
+    }
+    RCP<const Basic> deep = x;
+    for (unsigned i = 0; i < 1000; i++) {
+        deep = sin(add(deep, y));
+    }
+    exprs.push_back(add(deep, cos(deep)));
+    for (size_t budget : {size_t(0), size_t(100), size_t(100000)}) {
+        substs.clear();
+        reduced.clear();
+        cse(substs, reduced, exprs, budget);
+        REQUIRE(reduced.size() == exprs.size());
+        // Each replacement only refers to the ones before it
+        SymEngine::map_basic_basic m;
+        for (const auto &p : substs) {
+            m[p.first] = SymEngine::xreplace(p.second, m);
+        }
+        for (unsigned i = 0; i < exprs.size(); i++) {
+            REQUIRE(eq(*SymEngine::xreplace(reduced[i], m), *exprs[i]));
+        }
+    }
+}
+
 TEST_CASE("CSE: regression test gh-1463", "[cse]")
 {
     RCP<const Basic> x1 = symbol("x1");
@@ -363,3 +416,33 @@ TEST_CASE("CSE: regression test gh-1463", "[cse]")
         cse(substs, reduced, {e1, e1, e3, e4, e4, e6, e7, e7, e9});
     }
 }
+
+TEST_CASE("CSE: deep expressions", "[cse]")
+{
+    // Each level uses the previous one twice, so that all of them are
+    // eliminated. The nesting is far too deep for a recursive walk. The
+    // nodes are destroyed recursively, so every level is kept in `levels`
+    // and they are released from the top: each release then destroys a
+    // single level.
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> i2 = integer(2);
+    const unsigned depth = 100000;
+    vec_basic levels;
+    levels.reserve(depth + 1);
+    levels.push_back(x);
+    for (unsigned i = 0; i < depth; i++) {
+        levels.push_back(add(sin(levels.back()), pow(levels.back(), i2)));
+    }
+    {
+        vec_pair substs;
+        vec_basic reduced;
+        cse(substs, reduced, {levels.back()});
+        REQUIRE(substs.size() == depth - 1);
+        RCP<const Basic> last = substs.back().first;
+        REQUIRE(eq(*reduced[0], *add(sin(last), pow(last, i2))));
+        REQUIRE(eq(*substs[0].second, *add(sin(x), pow(x, i2))));
+    }
+    while (not levels.empty()) {
+        levels.pop_back();
+    }
+}
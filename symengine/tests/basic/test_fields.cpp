@@ -15,6 +15,7 @@ using SymEngine::gf_poly;
 using SymEngine::integer;
 using SymEngine::integer_class;
 using SymEngine::map_uint_mpz;
+using SymEngine::outArg;
 using SymEngine::pow;
 using SymEngine::RCP;
 using SymEngine::Symbol;
@@ -1073,3 +1074,61 @@ TEST_CASE("GaloisFieldDict eval : Basic", "[basic]")
     std::vector<integer_class> resa = {1_z, 6_z, 6_z, 1_z};
     REQUIRE(d1.gf_multi_eval({0_z, 1_z, 2_z, 3_z}) == resa);
 }
+
+TEST_CASE("GaloisFieldDict word-size and multi-precision moduli : Basic",
+          "[basic]")
+{
+    // The first modulus fits in 32 bits and uses machine words, the second
+    // is just above it and uses integer_class arithmetic.
+    for (const integer_class &p : {4294967291_z, 4294967311_z}) {
+        GaloisFieldDict one = GaloisFieldDict::from_vec({1_z}, p);
+        REQUIRE(one.is_word_modulus() == (p == 4294967291_z));
+
+        // sum (p - 1) x**i squared has coefficients (k + 1) * (p - 1)**2,
+        // i.e. k + 1, for k < 60; this overflows a 64 bit accumulator
+        std::vector<integer_class> v(60, p - 1);
+        GaloisFieldDict a = GaloisFieldDict::from_vec(v, p);
+        GaloisFieldDict sq = a * a;
+        REQUIRE(sq.degree() == 118);
+        for (unsigned k = 0; k < 60; k++)
+            REQUIRE(sq.get_coeff(k) == integer_class(k + 1));
+
+        std::vector<integer_class> u(25), w(11);
+        integer_class s = 12345_z;
+        for (auto &c : u) {
+            s = (s * 1103515245_z + 12345_z) % p;
+            c = s;
+        }
+        for (auto &c : w) {
+            s = (s * 1103515245_z + 12345_z) % p;
+            c = s;
+        }
+        w.back() = p - 2;
+        GaloisFieldDict f = GaloisFieldDict::from_vec(u, p);
+        GaloisFieldDict g = GaloisFieldDict::from_vec(w, p);
+
+        std::vector<integer_class> ref(u.size() + w.size() - 1, 0_z);
+        for (unsigned i = 0; i < u.size(); i++)
+            for (unsigned j = 0; j < w.size(); j++)
+                ref[i + j] = (ref[i + j] + u[i] * w[j]) % p;
+        REQUIRE(f * g == GaloisFieldDict::from_vec(ref, p));
+
+        GaloisFieldDict quo, rem;
+        f.gf_div(g, outArg(quo), outArg(rem));
+        REQUIRE(rem.degree() < g.degree());
+        REQUIRE(quo * g + rem == f);
+        REQUIRE(f / g == quo);
+        REQUIRE(f % g == rem);
+
+        REQUIRE(g.gf_pow_mod(f, 37) == f.gf_pow(37) % g);
+        GaloisFieldDict x = GaloisFieldDict::from_vec({0_z, 1_z}, p);
+        REQUIRE(g.gf_compose_mod(f, x) == f % g);
+        REQUIRE(g.gf_compose_mod(x * x, f) == f.gf_sqr() % g);
+
+        integer_class lc;
+        GaloisFieldDict monic;
+        g.gf_monic(lc, outArg(monic));
+        REQUIRE(lc == p - 2);
+        REQUIRE((f * g).gf_gcd(g * (f + one)) == monic);
+    }
+}
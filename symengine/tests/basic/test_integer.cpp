@@ -3,6 +3,7 @@
 #include <symengine/integer.h>
 #include <symengine/mul.h>
 #include <symengine/symengine_exception.h>
+#include <limits>
 
 using SymEngine::Basic;
 using SymEngine::Integer;
@@ -122,3 +123,53 @@ TEST_CASE("fix#461: integer", "[integer]")
     CHECK(ir->__str__() == "-12345");
     CHECK(mp_get_hex_str(val) == "-3039");
 }
+
+TEST_CASE("small integer arithmetic: integer", "[integer]")
+{
+    const long max = std::numeric_limits<long>::max();
+    const long min = std::numeric_limits<long>::min();
+    RCP<const Integer> imax = integer(max);
+    RCP<const Integer> imin = integer(min);
+    RCP<const Integer> i1 = integer(1);
+    RCP<const Integer> i2 = integer(2);
+    RCP<const Integer> r;
+
+    // Small values share a preallocated instance
+    REQUIRE(integer(2).get() == i2.get());
+    REQUIRE(integer(integer_class(2)).get() == i2.get());
+    REQUIRE(i1->addint(*i1).get() == i2.get());
+    REQUIRE(integer(SymEngine::integer_cache_max + 1)->is_small());
+
+    REQUIRE(imax->is_small());
+    REQUIRE(imin->is_small());
+    REQUIRE(eq(*imax->subint(*i1), *integer(max - 1)));
+    REQUIRE(eq(*imin->addint(*i1), *integer(min + 1)));
+    REQUIRE(eq(*integer(-3)->mulint(*integer(5)), *integer(-15)));
+
+    // Results that overflow a long are promoted to integer_class
+    r = imax->addint(*i1);
+    REQUIRE(not r->is_small());
+    REQUIRE(r->as_integer_class() == integer_class(max) + 1);
+    REQUIRE(r->is_positive());
+    REQUIRE(not r->is_zero());
+    CHECK_THROWS_AS(r->as_int(), SymEngineException);
+    REQUIRE(r->subint(*i1)->is_small());
+    REQUIRE(eq(*r->subint(*i1), *imax));
+
+    r = imin->subint(*i1);
+    REQUIRE(not r->is_small());
+    REQUIRE(r->as_integer_class() == integer_class(min) - 1);
+    REQUIRE(r->is_negative());
+
+    r = imax->mulint(*i2);
+    REQUIRE(not r->is_small());
+    REQUIRE(r->as_integer_class() == integer_class(max) * 2);
+
+    r = imin->neg();
+    REQUIRE(not r->is_small());
+    REQUIRE(r->as_integer_class() == -integer_class(min));
+    REQUIRE(eq(*r->neg(), *imin));
+    REQUIRE(r->compare(*imax) == 1);
+    REQUIRE(imax->compare(*r) == -1);
+    REQUIRE(imin->compare(*imax) == -1);
+}
@@ -12,9 +12,13 @@ using SymEngine::Basic;
 using SymEngine::expr2poly;
 using SymEngine::Integer;
 using SymEngine::integer;
+using SymEngine::integer_class;
 using SymEngine::map_vec_mpz;
 using SymEngine::monomial_mul;
+using SymEngine::MonomialPacker;
 using SymEngine::Mul;
+using SymEngine::packed_monomial;
+using SymEngine::PackedMonomialMap;
 using SymEngine::poly_mul;
 using SymEngine::Pow;
 using SymEngine::print_stack_on_segfault;
@@ -88,3 +92,78 @@ TEST_CASE("expand: poly", "[poly]")
                      .count()
               << "ms" << std::endl;
 }
+
+TEST_CASE("packed monomials: poly", "[poly]")
+{
+    vec_int a = {1, 2, 3, 4}, b = {2, 3, 2, 5}, c(4);
+    packed_monomial pa, pb, pc;
+
+    MonomialPacker packer(4, 9);
+    REQUIRE(packer.is_valid());
+    REQUIRE(packer.max_exponent() == 15);
+    REQUIRE(packer.pack(a, pa));
+    REQUIRE(packer.pack(b, pb));
+    REQUIRE(packer.mul(pa, pb, pc));
+    packer.unpack(pc, c);
+    REQUIRE(c == vec_int({3, 5, 5, 9}));
+
+    // Overflow of a single exponent is detected
+    REQUIRE(packer.pack(vec_int({0, 0, 15, 0}), pa));
+    REQUIRE(packer.pack(vec_int({0, 0, 1, 0}), pb));
+    REQUIRE(not packer.mul(pa, pb, pc));
+
+    REQUIRE(not packer.pack(vec_int({0, 16, 0, 0}), pa));
+    REQUIRE(not packer.pack(vec_int({0, -1, 0, 0}), pa));
+    REQUIRE(not MonomialPacker(20, 100).is_valid());
+    REQUIRE(MonomialPacker(64, 0).is_valid());
+
+    PackedMonomialMap<integer_class> m;
+    for (long i = 0; i < 1000; i++) {
+        m[packed_monomial(i) * 7] += integer_class(i);
+        m[packed_monomial(i) * 7] += 1;
+    }
+    REQUIRE(m.size() == 1000);
+    REQUIRE(m[7 * 999] == 1000);
+    integer_class sum(0);
+    m.for_each([&](packed_monomial, const integer_class &c) { sum += c; });
+    REQUIRE(sum == 1000 * 1001 / 2);
+}
+
+TEST_CASE("poly_mul: poly", "[poly]")
+{
+    RCP<const Basic> x = symbol("x");
+    RCP<const Basic> y = symbol("y");
+    RCP<const Basic> z = symbol("z");
+    umap_basic_num syms;
+    insert(syms, x, integer(0));
+    insert(syms, y, integer(1));
+    insert(syms, z, integer(2));
+
+    RCP<const Basic> e1, e2;
+    umap_vec_mpz P1, P2, C, D;
+    // expr2poly() drops the constant term of a sum, so there is none here
+    e1 = expand(pow(add(add(x, y), mul(integer(2), z)), integer(3)));
+    e2 = expand(add(pow(add(y, z), integer(2)), mul(integer(5), x)));
+    expr2poly(e1, syms, P1);
+    expr2poly(e2, syms, P2);
+    poly_mul(P1, P2, C);
+    expr2poly(expand(mul(e1, e2)), syms, D);
+    // poly_mul() keeps terms that cancel with a zero coefficient
+    for (auto it = C.begin(); it != C.end();) {
+        if (it->second == 0)
+            it = C.erase(it);
+        else
+            ++it;
+    }
+    REQUIRE(C == D);
+
+    // Negative exponents are multiplied unpacked
+    P1.clear();
+    C.clear();
+    D.clear();
+    e1 = add(div(x, y), z);
+    expr2poly(e1, syms, P1);
+    poly_mul(P1, P1, C);
+    expr2poly(expand(mul(e1, e1)), syms, D);
+    REQUIRE(C == D);
+}
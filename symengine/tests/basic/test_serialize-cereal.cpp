@@ -3,7 +3,13 @@
 #include <symengine/basic.h>
 #include <symengine/parser.h>
 #include <symengine/serialize-cereal.h>
+#include <symengine/serialize-compact.h>
+#include <symengine/serialize-stream.h>
 #include <cereal/archives/binary.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cstdlib>
+#include <unistd.h>
+#endif
 
 using std::string;
 
@@ -11,6 +17,9 @@ using SymEngine::add;
 using SymEngine::Basic;
 using SymEngine::complex_double;
 using SymEngine::cos;
+using SymEngine::CompactInputArchive;
+using SymEngine::CompactOutputArchive;
+using SymEngine::DenseMatrix;
 using SymEngine::dummy;
 using SymEngine::Integer;
 using SymEngine::is_a;
@@ -18,8 +27,12 @@ using SymEngine::Number;
 using SymEngine::RCP;
 using SymEngine::RCPBasicAwareInputArchive;
 using SymEngine::RCPBasicAwareOutputArchive;
+using SymEngine::SerializationReader;
+using SymEngine::SerializationWriter;
 using SymEngine::sin;
 using SymEngine::Symbol;
+using SymEngine::symbol;
+using SymEngine::vec_basic;
 #ifdef HAVE_SYMENGINE_MPFR
 using SymEngine::mpfr_class;
 using SymEngine::RealMPFR;
@@ -125,3 +138,183 @@ TEST_CASE("Test serialization shared pointer", "[serialize-cereal]")
     REQUIRE(new_expr->get_args()[0]->get_args()[0].get()
             == new_expr->get_args()[1]->get_args()[0].get());
 }
+
+TEST_CASE("Test compact serialization", "[serialize-cereal]")
+{
+    RCP<const Basic> x = symbol("x"), y = symbol("y");
+    std::vector<RCP<const Basic>> exprs = {
+        x,
+        dummy("foo"),
+        se::integer(0),
+        se::integer(-1),
+        se::integer(1000),
+        se::integer(se::integer_class("123456789012345678901234567890")),
+        se::integer(se::integer_class("-4611686018427387904")),
+        se::integer(se::integer_class("4611686018427387904")),
+        se::Rational::from_two_ints(*se::integer(-3), *se::integer(7)),
+        se::real_double(-0.0),
+        se::real_double(1.5),
+        se::complex_double(std::complex<double>(1.0, -2.0)),
+        se::pi,
+        se::parse("x**2 + 3*y - sin(x*y)/cos(2*x) + f(x, y)"),
+        se::parse("2**(1/3) + (x + y)**100 + exp(x) + Max(x, y)"),
+        add(se::real_double(0.0), se::mul(se::real_double(-0.0), x)),
+        se::reals(),
+        se::interval(se::integer(1), se::integer(2), true, false),
+        se::Eq(x, y),
+    };
+    for (const auto &e : exprs) {
+        std::string data = e->dumps_compact();
+        RCP<const Basic> r = Basic::loads(data);
+        REQUIRE(eq(*e, *r));
+        REQUIRE(e->__str__() == r->__str__());
+    }
+
+    // The archive can be used directly
+    std::ostringstream oss;
+    CompactOutputArchive{oss}(x, exprs[13]);
+    RCP<const Symbol> x2;
+    RCP<const Basic> e2;
+    std::istringstream iss(oss.str());
+    CompactInputArchive{iss}(x2, e2);
+    REQUIRE(eq(*x2, *x));
+    REQUIRE(eq(*e2, *exprs[13]));
+
+    // Equal subexpressions are written once, even if they are not shared
+    RCP<const Basic> e = add(sin(add(x, y)), cos(add(y, x)));
+    RCP<const Basic> r = Basic::loads(e->dumps_compact());
+    REQUIRE(r->get_args()[0]->get_args()[0].get()
+            == r->get_args()[1]->get_args()[0].get());
+
+    // Large integers are stored as bytes, instead of as strings
+    RCP<const Basic> big = se::pow(se::integer(3), se::integer(300));
+    REQUIRE(big->dumps_compact().size() < big->dumps().size() / 2);
+    e = se::parse("x**2 + 3*y - sin(x*y)/cos(2*x)");
+    REQUIRE(e->dumps_compact().size() < e->dumps().size());
+}
+
+TEST_CASE("Test compact serialization exception", "[serialize-cereal]")
+{
+    RCP<const Basic> expr = se::parse("x + y**1000000000000 - f(x, 2**100)");
+    std::string orig_data = expr->dumps_compact();
+
+    // Truncated data should always throw. Data shorter than the magic bytes
+    // is read in the format of dumps().
+    const size_t magic_size = sizeof(se::compact_serialization_magic) - 1;
+    for (size_t size = magic_size; size < orig_data.size(); size++) {
+        CHECK_THROWS_AS(Basic::loads(orig_data.substr(0, size)),
+                        se::SerializationError);
+    }
+
+    // Wrong version of the format
+    std::string data = orig_data;
+    data[3] = char(100);
+    CHECK_THROWS_AS(Basic::loads(data), se::SerializationError);
+
+    // Back references to nodes that do not exist
+    std::ostringstream oss;
+    CompactOutputArchive oarchive{oss};
+    oarchive.save_header();
+    oarchive.save_varint(5);
+    CHECK_THROWS_AS(Basic::loads(oss.str()), se::SerializationError);
+
+    // Invalid type
+    oss.str("");
+    CompactOutputArchive oarchive2{oss};
+    oarchive2.save_header();
+    oarchive2.save_varint(0);
+    oarchive2.save_varint(255);
+    CHECK_THROWS_AS(Basic::loads(oss.str()), se::SerializationError);
+
+    // Wrong type requested
+    std::istringstream iss(se::integer(2)->dumps_compact());
+    CompactInputArchive iarchive{iss};
+    iarchive.load_header();
+    RCP<const Symbol> s;
+    CHECK_THROWS_AS(iarchive(s), se::SerializationError);
+}
+
+static void write_objects(SerializationWriter &writer, const vec_basic &v)
+{
+    writer.write(v[0]);
+    writer.write(v);
+    writer.write(DenseMatrix(2, 2, {v[1], v[0], v[2], v[0]}));
+}
+
+static void check_objects(SerializationReader &reader, const vec_basic &v)
+{
+    REQUIRE(not reader.at_end());
+    REQUIRE(reader.next_kind() == SerializationReader::Kind::Expression);
+    CHECK_THROWS_AS(reader.read_vec(), se::SerializationError);
+    RCP<const Basic> e = reader.read_basic();
+    REQUIRE(eq(*e, *v[0]));
+
+    vec_basic w = reader.read_vec();
+    REQUIRE(se::unified_eq(v, w));
+    // The nodes are shared across the objects of a stream
+    REQUIRE(w[0].get() == e.get());
+    bool shared = false;
+    for (const auto &a : e->get_args()) {
+        for (const auto &b : w[2]->get_args()) {
+            shared = shared or a.get() == b.get();
+        }
+    }
+    REQUIRE(shared);
+
+    REQUIRE(reader.next_kind() == SerializationReader::Kind::Matrix);
+    DenseMatrix m = reader.read_matrix();
+    REQUIRE(m == DenseMatrix(2, 2, {v[1], v[0], v[2], v[0]}));
+    REQUIRE(m.get(0, 1).get() == e.get());
+
+    REQUIRE(reader.at_end());
+    CHECK_THROWS_AS(reader.read_basic(), se::SerializationError);
+}
+
+TEST_CASE("Test streaming serialization", "[serialize-cereal]")
+{
+    RCP<const Basic> x = symbol("x"), y = symbol("y");
+    RCP<const Basic> t = se::parse("sin(x + y)**2");
+    RCP<const Basic> e = add(t, se::parse("2**100*x"));
+    vec_basic v = {e, se::integer(3), add(t, cos(y)), x};
+
+    std::stringstream ss;
+    {
+        SerializationWriter writer(ss);
+        write_objects(writer, v);
+    }
+    SerializationReader reader(ss);
+    check_objects(reader, v);
+
+    // Truncated streams throw
+    std::string data = ss.str();
+    std::istringstream iss(data.substr(0, data.size() - 1));
+    SerializationReader reader2(iss);
+    reader2.read_basic();
+    reader2.read_vec();
+    CHECK_THROWS_AS(reader2.read_matrix(), se::SerializationError);
+
+#if defined(__unix__) || defined(__APPLE__)
+    char filename[] = "/tmp/symengine_serializeXXXXXX";
+    int fd = mkstemp(filename);
+    REQUIRE(fd >= 0);
+    {
+        SerializationWriter writer(fd);
+        write_objects(writer, v);
+        writer.flush();
+    }
+    {
+        SerializationReader reader(filename);
+        check_objects(reader, v);
+    }
+    REQUIRE(lseek(fd, 0, SEEK_SET) == 0);
+    {
+        SerializationReader reader(fd);
+        check_objects(reader, v);
+    }
+    close(fd);
+    unlink(filename);
+
+    CHECK_THROWS_AS(SerializationReader("/nonexistent/symengine"),
+                    se::SerializationError);
+#endif
+}
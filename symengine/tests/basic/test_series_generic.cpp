@@ -165,6 +165,92 @@ TEST_CASE("Exponentiation of UExprDict with precision", "[UnivariateSeries]")
     REQUIRE(f == d);
     REQUIRE(g == one);
     REQUIRE_THROWS_AS(UnivariateSeries::pow(zero, 0, 1), DomainError);
+    REQUIRE(UnivariateSeries::pow(UExprDict(), 2, 3) == UExprDict());
+
+    // The base is truncated to zero before it is raised to the power
+    auto p = pow(add(pow(x, integer(5)), pow(x, integer(6))), integer(2));
+    REQUIRE(UnivariateSeries::series(p, "x", 3)->get_poly() == UExprDict());
+}
+
+TEST_CASE("Dense arithmetic of UExprDict with precision", "[UnivariateSeries]")
+{
+    UExprDict var = UnivariateSeries::var("x");
+
+    // Long enough to be multiplied with Karatsuba's method
+    map_int_Expr ones, squares;
+    for (int i = 0; i < 100; i++)
+        ones[i] = 1;
+    for (int i = 0; i < 199; i++)
+        squares[i] = i < 100 ? i + 1 : 199 - i;
+    UExprDict a(ones), a2(squares);
+    REQUIRE(UnivariateSeries::mul(a, a, 200) == a2);
+    // Truncated products, computed in full or only up to the precision
+    for (unsigned prec : {50, 100, 150}) {
+        REQUIRE(UnivariateSeries::mul(a, a, prec)
+                == UnivariateSeries::mul(a2, UExprDict(1), prec));
+    }
+    REQUIRE(UnivariateSeries::mul(a / Expression(3), a / Expression(2), 200)
+            == a2 / Expression(6));
+    // Operands of different lengths
+    map_int_Expr short_ones, prod;
+    for (int i = 0; i < 40; i++)
+        short_ones[i] = 1;
+    for (int k = 0; k < 120; k++)
+        prod[k] = std::min(std::min(k + 1, 40), std::min(139 - k, 100));
+    REQUIRE(UnivariateSeries::mul(a, UExprDict(short_ones), 120)
+            == UExprDict(prod));
+    REQUIRE(UnivariateSeries::mul(UExprDict(short_ones), a, 120)
+            == UExprDict(prod));
+
+    UExprDict l({{-1, 1}, {0, 1}});
+    REQUIRE(UnivariateSeries::mul(l, l, 1)
+            == UExprDict({{-2, 1}, {-1, 2}, {0, 1}}));
+    REQUIRE(UnivariateSeries::pow(l, 3, 1)
+            == UExprDict({{-3, 1}, {-2, 3}, {-1, 3}, {0, 1}}));
+
+    UExprDict b({{0, 1}, {1, 1}});
+    // Short operands at a high precision
+    REQUIRE(UnivariateSeries::mul(b, b, 8000)
+            == UExprDict({{0, 1}, {1, 2}, {2, 1}}));
+    REQUIRE(UnivariateSeries::pow(b, 3, 8000)
+            == UExprDict({{0, 1}, {1, 3}, {2, 3}, {3, 1}}));
+    map_int_Expr ones_b;
+    for (int k = 0; k <= 100; k++)
+        ones_b[k] = k == 0 or k == 100 ? 1 : 2;
+    REQUIRE(UnivariateSeries::mul(a, b, 8000) == UExprDict(ones_b));
+    REQUIRE(UnivariateSeries::find_cf(UnivariateSeries::pow(b, 50, 30), var, 10)
+            == Expression(integer(integer_class(10272278170L))));
+    UExprDict h({{0, 2}, {1, Expression(rational(1, 3))}});
+    REQUIRE(UnivariateSeries::pow(h, 4, 3)
+            == UExprDict({{0, 16},
+                          {1, Expression(rational(32, 3))},
+                          {2, Expression(rational(8, 3))}}));
+
+    // Symbolic coefficients
+    UExprDict s({{0, Expression("a")}, {1, 1}});
+    REQUIRE(UnivariateSeries::find_cf(UnivariateSeries::pow(s, 3, 4), var, 1)
+            == 3 * Expression("a") * Expression("a"));
+
+    // 1/(1 - x - x**2) generates the Fibonacci numbers
+    UExprDict f({{0, 1}, {1, -1}, {2, -1}});
+    REQUIRE(UnivariateSeries::find_cf(
+                UnivariateSeries::series_invert(f, var, 61), var, 60)
+            == Expression(integer(integer_class(2504730781961L))));
+    UExprDict t(map_int_Expr{{1, 2}});
+    REQUIRE(UnivariateSeries::series_invert(t, var, 3)
+            == UExprDict({{-1, Expression(rational(1, 2))}}));
+
+    UExprDict geo = UnivariateSeries::series_invert(1 - var, var, 40);
+    REQUIRE(UnivariateSeries::find_cf(geo, var, 39) == 1);
+    UExprDict lg = UnivariateSeries::series_log(geo, var, 40);
+    REQUIRE(UnivariateSeries::find_cf(lg, var, 39)
+            == Expression(rational(1, 39)));
+    REQUIRE(UnivariateSeries::series_exp(lg, var, 40) == geo);
+
+    UExprDict e = UnivariateSeries::series_exp(
+        UExprDict({{0, Expression("a")}, {1, 1}}), var, 3);
+    REQUIRE(UnivariateSeries::find_cf(e, var, 2)
+            == Expression(SymEngine::exp(symbol("a"))) / 2);
 }
 
 TEST_CASE("Differentiation of UnivariateSeries", "[UnivariateSeries]")
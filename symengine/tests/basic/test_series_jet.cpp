@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include <symengine/series_jet.h>
+#include <symengine/symengine_exception.h>
+
+using SymEngine::add;
+using SymEngine::Basic;
+using SymEngine::cos;
+using SymEngine::div;
+using SymEngine::exp;
+using SymEngine::expand;
+using SymEngine::integer;
+using SymEngine::integer_class;
+using SymEngine::JetLayout;
+using SymEngine::log;
+using SymEngine::map_basic_basic;
+using SymEngine::mul;
+using SymEngine::multivariate_series;
+using SymEngine::MultivariateSeries;
+using SymEngine::NotImplementedError;
+using SymEngine::one;
+using SymEngine::pow;
+using SymEngine::rational;
+using SymEngine::RCP;
+using SymEngine::sin;
+using SymEngine::sqrt;
+using SymEngine::sub;
+using SymEngine::symbol;
+using SymEngine::Symbol;
+using SymEngine::vec_sym;
+using SymEngine::vec_uint;
+using SymEngine::zero;
+
+TEST_CASE("Monomial layout of jets", "[MultivariateSeries]")
+{
+    JetLayout l({"x", "y", "z"}, 4);
+    REQUIRE(l.size() == 20);
+    REQUIRE(l.offset(0) == 0);
+    REQUIRE(l.offset(1) == 1);
+    REQUIRE(l.offset(2) == 4);
+    REQUIRE(l.offset(3) == 10);
+    REQUIRE(l.offset(4) == 20);
+    for (size_t i = 0; i < l.size(); i++) {
+        REQUIRE(l.index(l.exponents(i), l.degree(i)) == i);
+    }
+    const unsigned xy[] = {1, 1, 0}, z2[] = {0, 0, 2};
+    REQUIRE(l.index(xy, 2) == 5);
+    REQUIRE(l.index(z2, 2) == 9);
+    REQUIRE(l.find("y") == 1);
+    REQUIRE(l.find("w") == 3);
+}
+
+TEST_CASE("Expansion of polynomials and rational functions",
+          "[MultivariateSeries]")
+{
+    RCP<const Symbol> x = symbol("x"), y = symbol("y");
+    const vec_sym xy = {x, y};
+
+    auto ex = pow(add(one, add(x, y)), integer(2));
+    auto s = multivariate_series(ex, xy, 3);
+    REQUIRE(s.get_degree() == 3);
+    REQUIRE(eq(*expand(s.as_basic()), *expand(ex)));
+    s = multivariate_series(ex, xy, 2);
+    REQUIRE(eq(*expand(s.as_basic()), *expand(add(one, mul(integer(2),
+                                                             add(x, y))))));
+
+    // 1/(1 - x - y) = sum binomial(a + b, a) x**a y**b
+    ex = div(one, sub(one, add(x, y)));
+    s = multivariate_series(ex, xy, 6);
+    REQUIRE(eq(*s.get_coeff({0, 0}), *one));
+    REQUIRE(eq(*s.get_coeff({1, 1}), *integer(2)));
+    REQUIRE(eq(*s.get_coeff({2, 3}), *integer(10)));
+    REQUIRE(eq(*s.get_coeff({0, 5}), *one));
+    REQUIRE(eq(*s.get_coeff({3, 3}), *zero));
+
+    CHECK_THROWS_AS(multivariate_series(div(one, x), xy, 3),
+                    NotImplementedError);
+}
+
+TEST_CASE("Elementary functions of jets", "[MultivariateSeries]")
+{
+    RCP<const Symbol> x = symbol("x"), y = symbol("y"), a = symbol("a");
+    const vec_sym xy = {x, y};
+
+    // exp(x + y) = sum x**i y**j / (i! j!)
+    auto s = multivariate_series(exp(add(x, y)), xy, 5);
+    REQUIRE(eq(*s.get_coeff({2, 2}), *rational(1, 4)));
+    REQUIRE(eq(*s.get_coeff({1, 3}), *rational(1, 6)));
+    REQUIRE(eq(*s.get_coeff({4, 0}), *rational(1, 24)));
+
+    // d^2/dxdy log(2 + x + y) = -1/(2 + x + y)**2
+    s = multivariate_series(log(add(integer(2), add(x, y))), xy, 3);
+    REQUIRE(eq(*expand(s.get_coeff({0, 0})), *log(integer(2))));
+    REQUIRE(eq(*expand(s.get_coeff({1, 1})), *rational(-1, 4)));
+
+    // Symbols outside of the expansion variables are constants
+    s = multivariate_series(exp(add(a, mul(x, y))), xy, 5);
+    REQUIRE(eq(*expand(s.get_coeff({0, 0})), *exp(a)));
+    REQUIRE(eq(*expand(s.get_coeff({2, 2})), *div(exp(a), integer(2))));
+    REQUIRE(eq(*s.get_coeff({1, 0}), *zero));
+
+    s = multivariate_series(sqrt(add(one, add(x, y))), xy, 3);
+    REQUIRE(eq(*expand(s.get_coeff({1, 1})), *rational(-1, 4)));
+}
+
+TEST_CASE("Jets agree with partial derivatives", "[MultivariateSeries]")
+{
+    RCP<const Symbol> x = symbol("x"), y = symbol("y");
+    const vec_sym xy = {x, y};
+    const unsigned prec = 5;
+    const map_basic_basic origin = {{x, zero}, {y, zero}};
+    auto ex = div(mul(exp(x), sin(add(x, mul(integer(2), y)))),
+                  add(one, mul(x, y)));
+    ex = add(ex, cos(mul(x, y)));
+    auto s = multivariate_series(ex, xy, prec);
+    RCP<const Basic> dx = ex;
+    integer_class fx(1);
+    for (unsigned i = 0; i < prec; i++) {
+        RCP<const Basic> d = dx;
+        integer_class f = fx;
+        for (unsigned j = 0; i + j < prec; j++) {
+            auto expected = expand(div(d->subs(origin), integer(f)));
+            REQUIRE(eq(*expand(s.get_coeff({i, j})), *expected));
+            d = d->diff(y);
+            f *= integer_class(long(j + 1));
+        }
+        dx = dx->diff(x);
+        fx *= integer_class(long(i + 1));
+    }
+}
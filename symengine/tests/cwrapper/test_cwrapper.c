@@ -299,6 +299,33 @@ void test_as_two_terms()
     basic_free_stack(term4);
 }
 
+void test_expand_parallel()
+{
+    char *s;
+    basic e, f, g;
+    basic_new_stack(e);
+    basic_new_stack(f);
+    basic_new_stack(g);
+
+    s = "(1 + x + y + z + w)**6*(x - y + 2*z)**4";
+    basic_parse(e, s);
+    basic_expand(f, e);
+    basic_expand_parallel(g, e, 1, 4);
+    SYMENGINE_C_ASSERT(basic_eq(f, g) == 1);
+
+    // Without deep, the powers of sums are left as they are
+    s = "(x + y)*(z + w)**2";
+    basic_parse(e, s);
+    basic_expand_parallel(g, e, 0, 1);
+    s = basic_str(g);
+    SYMENGINE_C_ASSERT(strcmp(s, "x*(w + z)**2 + y*(w + z)**2") == 0);
+    basic_str_free(s);
+
+    basic_free_stack(e);
+    basic_free_stack(f);
+    basic_free_stack(g);
+}
+
 void test_basic()
 {
     basic x;
@@ -2270,21 +2297,38 @@ void test_lambda_double()
     vecbasic_push_back(exprs, s);
 
     for (perform_cse = 0; perform_cse <= 1; ++perform_cse) {
+        // Two points, the second one with x = 0.5
+        double inps_batch[6] = {1.5, 2.0, 3.0, 0.5, 2.0, 3.0};
+        double outs_batch[4];
         CLambdaRealDoubleVisitor *vis = lambda_real_double_visitor_new();
         lambda_real_double_visitor_init(vis, args, exprs, perform_cse);
         lambda_real_double_visitor_call(vis, outs, inps);
+        lambda_real_double_visitor_call_batch(vis, outs_batch, inps_batch, 2,
+                                              3);
         lambda_real_double_visitor_free(vis);
         SYMENGINE_C_ASSERT(fabs(outs[0] - 43.5) < 1e-12);
         SYMENGINE_C_ASSERT(fabs(outs[1] - 45.0) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_batch[0] - 43.5) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_batch[1] - 45.0) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_batch[2] - 42.5) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_batch[3] - 43.0) < 1e-12);
 #ifdef HAVE_SYMENGINE_LLVM
         // double
         int symbolic_cse = 1, opt_level = 2;
         CLLVMDoubleVisitor *vis2 = llvm_double_visitor_new();
         llvm_double_visitor_init(vis2, args, exprs, symbolic_cse, opt_level);
         llvm_double_visitor_call(vis2, outs, inps);
-        llvm_double_visitor_free(vis2);
         SYMENGINE_C_ASSERT(fabs(outs[0] - 43.5) < 1e-12);
         SYMENGINE_C_ASSERT(fabs(outs[1] - 45.0) < 1e-12);
+        // Same points as above, the outputs padded to three entries
+        double outs_llvm[6];
+        llvm_double_visitor_call_batch(vis2, outs_llvm, inps_batch, 2, 3, 3,
+                                       2);
+        llvm_double_visitor_free(vis2);
+        SYMENGINE_C_ASSERT(fabs(outs_llvm[0] - 43.5) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_llvm[1] - 45.0) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_llvm[3] - 42.5) < 1e-12);
+        SYMENGINE_C_ASSERT(fabs(outs_llvm[4] - 43.0) < 1e-12);
 
         // float
         float outs_f[2];
@@ -2476,6 +2520,7 @@ int main(int argc, char *argv[])
     test_version();
     test_cwrapper();
     test_as_two_terms();
+    test_expand_parallel();
     test_complex();
     test_complex_double();
     test_basic();
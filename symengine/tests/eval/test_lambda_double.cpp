@@ -8,12 +8,16 @@
 #include <symengine/symengine_exception.h>
 #include <symengine/eval.h>
 #include <symengine/rational.h>
+#include <symengine/derivative.h>
 
 #ifdef HAVE_SYMENGINE_LLVM
 #include <symengine/llvm_double.h>
 #include <symengine/eval_mpfr.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
 using SymEngine::LLVMDoubleVisitor;
 using SymEngine::LLVMFloatVisitor;
+using SymEngine::LLVMVisitor;
 
 #ifdef HAVE_SYMENGINE_MPFR
 using SymEngine::RealMPFR;
@@ -53,7 +57,9 @@ using SymEngine::floor;
 using SymEngine::gamma;
 using SymEngine::Inf;
 using SymEngine::integer;
+using SymEngine::LambdaComplexDoubleBytecode;
 using SymEngine::LambdaComplexDoubleVisitor;
+using SymEngine::LambdaRealDoubleBytecode;
 using SymEngine::LambdaRealDoubleVisitor;
 using SymEngine::Le;
 using SymEngine::log;
@@ -215,6 +221,57 @@ TEST_CASE("Evaluate double cse", "[lambda_double_cse]")
     REQUIRE(::fabs(d[1] - 45.0) < 1e-12);
 }
 
+TEST_CASE("Evaluate gradient", "[lambda_double_cse]")
+{
+    // A sum of many terms, that share an inner product
+    const unsigned n = 30;
+    vec_basic args;
+    SymEngine::vec_sym syms;
+    for (unsigned i = 0; i < n; i++) {
+        syms.push_back(symbol("p" + std::to_string(i)));
+        args.push_back(syms.back());
+    }
+    RCP<const Basic> inner = integer(0);
+    for (unsigned i = 0; i < n; i++) {
+        inner = add(inner, mul(integer(i + 1), args[i]));
+    }
+    RCP<const Basic> f = integer(0);
+    for (unsigned i = 0; i < n; i++) {
+        f = add(f, mul(sin(mul(args[i], inner)),
+                       pow(args[(i + 1) % n], integer(2))));
+    }
+    f = add(f, exp(div(inner, integer(100))));
+
+    vec_basic grad = SymEngine::gradient(f, syms);
+    vec_basic expected;
+    for (unsigned i = 0; i < n; i++) {
+        expected.push_back(f->diff(syms[i]));
+    }
+
+    std::vector<double> inps(n), outs(n), outs_expected(n);
+    for (unsigned i = 0; i < n; i++) {
+        inps[i] = 0.1 + 0.02 * i;
+    }
+    LambdaRealDoubleVisitor v, v_expected;
+    v.init(args, grad, true);
+    v_expected.init(args, expected);
+    v.call(outs.data(), inps.data());
+    v_expected.call(outs_expected.data(), inps.data());
+    for (unsigned i = 0; i < n; i++) {
+        REQUIRE(::fabs(outs[i] - outs_expected[i])
+                < 1e-12 * (1 + ::fabs(outs_expected[i])));
+    }
+#ifdef HAVE_SYMENGINE_LLVM
+    LLVMDoubleVisitor v2;
+    v2.init(args, grad, true);
+    v2.call(outs.data(), inps.data());
+    for (unsigned i = 0; i < n; i++) {
+        REQUIRE(::fabs(outs[i] - outs_expected[i])
+                < 1e-12 * (1 + ::fabs(outs_expected[i])));
+    }
+#endif
+}
+
 TEST_CASE("LambdaRealDoubleVisitor with cse can be moved",
           "[lambda_double_cse]")
 {
@@ -243,6 +300,135 @@ TEST_CASE("LambdaRealDoubleVisitor with cse can be moved",
     REQUIRE(::fabs(d[1] - 45.0) < 1e-12);
 }
 
+TEST_CASE("Evaluate double in batches", "[lambda_double]")
+{
+    RCP<const Basic> x, y, z, r, s, t, u, w;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+
+    r = add(mul(integer(3), sin(add(x, y))),
+            pow(add(mul(y, z), integer(2)), rational(3, 2)));
+    s = add(mul(integer(2), x), add(mul(y, z), pow(mul(y, z), integer(2))));
+    // exp(), a symbolic exponent, an atan2() without a batch operation, and
+    // a constant
+    t = add(mul(pow(E, x), pow(z, y)), atan2(mul(y, z), x));
+    // E in the dict of a Mul, with a numeric and a symbolic exponent. Both
+    // paths evaluate these with pow(), not exp().
+    u = add(mul(E, x), mul(pow(E, integer(2)), y));
+    w = mul(x, pow(E, mul(y, z)));
+
+    // 300 points in 3 blocks, with one unused input per point
+    const size_t npoints = 300, stride = 4;
+    std::vector<double> inps(npoints * stride);
+    for (size_t i = 0; i < inps.size(); i++) {
+        inps[i] = 0.25 + 0.01 * i;
+    }
+
+    for (bool cse : {false, true}) {
+        LambdaRealDoubleVisitor v;
+        v.init({x, y, z}, {r, s, t, u, w, pi}, cse);
+        std::vector<double> outs(npoints * 6), expected(6);
+        v.call_batch(outs.data(), inps.data(), npoints, stride);
+        for (size_t p = 0; p < npoints; p++) {
+            v.call(expected.data(), &inps[p * stride]);
+            for (size_t j = 0; j < 6; j++) {
+                REQUIRE(outs[p * 6 + j] == expected[j]);
+            }
+        }
+
+        // init() discards the compiled batch operations
+        v.init({x, y, z}, *y, cse);
+        v.call_batch(outs.data(), inps.data(), npoints, stride);
+        for (size_t p = 0; p < npoints; p++) {
+            REQUIRE(outs[p] == inps[p * stride + 1]);
+        }
+    }
+}
+
+TEST_CASE("Evaluate double with bytecode", "[lambda_double]")
+{
+    RCP<const Basic> x, y, z, r, s, t;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+
+    r = add(mul(integer(3), sin(add(x, y))),
+            pow(add(mul(y, z), integer(2)), rational(3, 2)));
+    s = add(mul(integer(2), x), add(mul(y, z), pow(mul(y, z), integer(2))));
+    // gamma() and max() have no instructions, and are evaluated by a
+    // LambdaRealDoubleVisitor of their own
+    t = add(mul(pow(E, x), pow(z, y)),
+            add(div(gamma(x), y), max({x, mul(y, z), sec(pi)})));
+    vec_basic outputs = {r, s, t, pi, div(x, y), cosh(integer(2))};
+
+    for (bool cse : {false, true}) {
+        LambdaRealDoubleVisitor ref;
+        ref.init({x, y, z}, outputs, cse);
+        LambdaRealDoubleBytecode v;
+        v.init({x, y, z}, outputs, cse);
+        double expected[6], d[6];
+        for (double inps : {0.5, 1.25, 2.75}) {
+            double xs[] = {inps, 2 * inps, 3 - inps};
+            ref.call(expected, xs);
+            v.call(d, xs);
+            for (unsigned i = 0; i < 6; i++) {
+                REQUIRE(d[i] == Approx(expected[i]));
+            }
+        }
+    }
+
+    // Squares of temporaries combined with other subexpressions, where the
+    // register of the square must not be handed out again
+    RCP<const Basic> xy2 = pow(add(x, y), integer(2));
+    outputs = {mul(xy2, sin(z)), add(mul(sin(z), xy2), cos(x)),
+               add(xy2, add(pow(add(x, z), integer(2)),
+                            pow(add(y, z), integer(2))))};
+    for (bool cse : {false, true}) {
+        LambdaRealDoubleVisitor ref;
+        ref.init({x, y, z}, outputs, cse);
+        LambdaRealDoubleBytecode v;
+        v.init({x, y, z}, outputs, cse);
+        // The last slot is a guard, nothing may be written past the outputs
+        double expected[3], d[4];
+        for (double inps : {0.5, 1.25, 2.75}) {
+            double xs[] = {inps, 2 * inps, 3 - inps};
+            d[3] = -12345.0;
+            ref.call(expected, xs);
+            v.call(d, xs);
+            for (unsigned i = 0; i < 3; i++) {
+                REQUIRE(d[i] == Approx(expected[i]));
+            }
+            REQUIRE(d[3] == -12345.0);
+        }
+    }
+
+    // Constant subexpressions are folded
+    LambdaRealDoubleBytecode v;
+    v.init({x}, *mul(add(sin(integer(2)), pi), x));
+    REQUIRE(v.get_code().size() == 1);
+    REQUIRE(v.call({2.0}) == Approx(2.0 * (std::sin(2.0) + std::acos(-1.0))));
+
+    CHECK_THROWS_AS(v.init({x}, *add(x, y)), SymEngineException);
+    CHECK_THROWS_AS(
+        v.init({x}, *add(complex_double(std::complex<double>(1, 2)), x)),
+        NotImplementedError);
+
+    LambdaComplexDoubleBytecode c;
+    r = add(x,
+            add(mul(y, z), pow(x, complex_double(std::complex<double>(3, 4)))));
+    c.init({x, y, z}, *r);
+    std::complex<double> cd = c.call({std::complex<double>(1.5, 1.0),
+                                      std::complex<double>(2.5, 4.0),
+                                      std::complex<double>(-6.0, 3.5)});
+    LambdaComplexDoubleVisitor cref;
+    cref.init({x, y, z}, *r);
+    std::complex<double> cexpected = cref.call(
+        {std::complex<double>(1.5, 1.0), std::complex<double>(2.5, 4.0),
+         std::complex<double>(-6.0, 3.5)});
+    REQUIRE(std::abs(cd - cexpected) < 1e-12 * std::abs(cexpected));
+}
+
 TEST_CASE("Evaluate to std::complex<double>", "[lambda_complex_double]")
 {
     RCP<const Basic> x, y, z, r;
@@ -525,6 +711,113 @@ TEST_CASE("Check llvm save and load", "[llvm_double]")
     REQUIRE(::fabs((d - d3) / d) < 1e-12);
 }
 
+TEST_CASE("Check llvm batch evaluation", "[llvm_double]")
+{
+    RCP<const Basic> x, y, z, r, s;
+    x = symbol("x");
+    y = symbol("y");
+    z = symbol("z");
+    r = add(sin(x), mul(pow(y, integer(3)), exp(z)));
+    s = div(add(x, y), add(integer(2), cos(z)));
+
+    const size_t npoints = 1000, in_stride = 4, out_stride = 3;
+    std::vector<double> inps(npoints * in_stride);
+    for (size_t i = 0; i < inps.size(); i++) {
+        inps[i] = 0.001 * i - 1.5;
+    }
+    std::vector<double> expected(npoints * out_stride, -1.0);
+
+    for (bool cse : {false, true}) {
+        LLVMDoubleVisitor v;
+        v.init({x, y, z}, {r, s}, cse);
+        for (size_t i = 0; i < npoints; i++) {
+            v.call(&expected[i * out_stride], &inps[i * in_stride]);
+        }
+        LLVMDoubleVisitor v2;
+        v2.loads(v.dumps());
+
+        for (unsigned nthreads : {0u, 1u, 3u}) {
+            std::vector<double> outs(npoints * out_stride, -1.0);
+            v.call_batch(outs.data(), inps.data(), npoints, in_stride,
+                         out_stride, nthreads);
+            REQUIRE(outs == expected);
+
+            std::fill(outs.begin(), outs.end(), -1.0);
+            v2.call_batch(outs.data(), inps.data(), npoints, in_stride,
+                          out_stride, nthreads);
+            REQUIRE(outs == expected);
+        }
+    }
+
+    LLVMFloatVisitor vf;
+    vf.init({x, y, z}, {r, s});
+    std::vector<float> inps_f(inps.begin(), inps.end());
+    std::vector<float> outs_f(2 * npoints), expected_f(2 * npoints);
+    for (size_t i = 0; i < npoints; i++) {
+        vf.call(&expected_f[2 * i], &inps_f[i * in_stride]);
+    }
+    vf.call_batch(outs_f.data(), inps_f.data(), npoints, in_stride, 2, 2);
+    REQUIRE(outs_f == expected_f);
+}
+
+TEST_CASE("Check llvm compile cache", "[llvm_double]")
+{
+    RCP<const Basic> x, y, r;
+    x = symbol("x");
+    y = symbol("y");
+    r = add(sin(x), mul(pow(y, integer(3)), exp(x)));
+
+    // A fresh directory in the temporary directory, removed at the end
+    llvm::SmallString<128> tmp;
+    REQUIRE(not llvm::sys::fs::createUniqueDirectory("symengine-llvm-cache",
+                                                     tmp));
+    const std::string dir = tmp.str().str();
+    LLVMVisitor::set_compile_cache(dir);
+    size_t hits = LLVMVisitor::compile_cache_hits();
+    size_t misses = LLVMVisitor::compile_cache_misses();
+
+    LLVMDoubleVisitor v, v2;
+    v.init({x, y}, *r);
+    REQUIRE(LLVMVisitor::compile_cache_misses() == misses + 1);
+    v2.init({x, y}, *r);
+    REQUIRE(LLVMVisitor::compile_cache_hits() == hits + 1);
+    REQUIRE(v.call({0.5, 1.5}) == v2.call({0.5, 1.5}));
+    // Structurally equal expressions share the entry
+    v2.init({symbol("x"), symbol("y")},
+            *add(mul(exp(x), pow(y, integer(3))), sin(x)));
+    REQUIRE(LLVMVisitor::compile_cache_hits() == hits + 2);
+    REQUIRE(v.call({0.5, 1.5}) == v2.call({0.5, 1.5}));
+
+    // Anything that changes the code is a different entry
+    v2.init({x, y}, *r, true);
+    v2.init({y, x}, *r);
+    v2.init({x, y}, *r, false, 2);
+    v2.init({x, y}, *add(r, real_double(0.1)));
+    v2.init({x, y}, *add(r, real_double(std::nextafter(0.1, 1.0))));
+    LLVMFloatVisitor vf;
+    vf.init({x, y}, *r);
+    REQUIRE(LLVMVisitor::compile_cache_hits() == hits + 2);
+    REQUIRE(LLVMVisitor::compile_cache_misses() == misses + 7);
+    v2.init({x, y}, *add(r, real_double(0.1)));
+    REQUIRE(LLVMVisitor::compile_cache_hits() == hits + 3);
+    REQUIRE(std::fabs(v2.call({0.5, 1.5}) - v.call({0.5, 1.5}) - 0.1) < 1e-12);
+
+    // Entries that do not fit are evicted
+    LLVMVisitor::set_compile_cache(dir, 0);
+    v2.init({x, y}, *r);
+    v2.init({x, y}, *r);
+    REQUIRE(LLVMVisitor::compile_cache_misses() == misses + 9);
+
+    // Disabled
+    LLVMVisitor::set_compile_cache("");
+    v2.init({x, y}, *r);
+    REQUIRE(LLVMVisitor::compile_cache_hits() == hits + 3);
+    REQUIRE(LLVMVisitor::compile_cache_misses() == misses + 9);
+    REQUIRE(v.call({0.5, 1.5}) == v2.call({0.5, 1.5}));
+
+    llvm::sys::fs::remove_directories(dir);
+}
+
 TEST_CASE("LLVMDoubleVisitor Exceptions", "[llvm_double]")
 {
     RCP<const Basic> x, y, r;
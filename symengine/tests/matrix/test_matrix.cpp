@@ -9,6 +9,7 @@
 #include <symengine/pow.h>
 #include <symengine/symengine_exception.h>
 #include <symengine/visitor.h>
+#include <symengine/derivative.h>
 #include <symengine/assumptions.h>
 
 using SymEngine::Add;
@@ -18,6 +19,7 @@ using SymEngine::Basic;
 using SymEngine::Complex;
 using SymEngine::complex_double;
 using SymEngine::conjugate;
+using SymEngine::csr_to_dense;
 using SymEngine::CSRMatrix;
 using SymEngine::DenseMatrix;
 using SymEngine::diag;
@@ -26,10 +28,14 @@ using SymEngine::eigen_values;
 using SymEngine::eye;
 using SymEngine::finiteset;
 using SymEngine::function_symbol;
+using SymEngine::Inf;
 using SymEngine::integer;
+using SymEngine::Integer;
 using SymEngine::is_a;
+using SymEngine::map_basic_basic;
 using SymEngine::minus_one;
 using SymEngine::mul;
+using SymEngine::Nan;
 using SymEngine::NotImplementedError;
 using SymEngine::one;
 using SymEngine::permutelist;
@@ -40,11 +46,14 @@ using SymEngine::real_double;
 using SymEngine::RealDouble;
 using SymEngine::reals;
 using SymEngine::set_basic;
+using SymEngine::SparseLU;
+using SymEngine::SparseLUAnalysis;
 using SymEngine::sub;
 using SymEngine::symbol;
 using SymEngine::Symbol;
 using SymEngine::SymEngineException;
 using SymEngine::vec_basic;
+using SymEngine::vec_sym;
 
 TEST_CASE("test_get_set(): matrices", "[matrices]")
 {
@@ -279,6 +288,44 @@ TEST_CASE("test_dense_dense_multiplication(): matrices", "[matrices]")
                             add(add(mul(symbol("u"), symbol("x")),
                                     mul(symbol("v"), symbol("y"))),
                                 mul(symbol("w"), symbol("z")))}));
+
+    // Spans several tiles and mixes zeros, integers and symbolic entries
+    RCP<const Basic> x = symbol("x");
+    unsigned n = 19, m = 17, p = 18;
+    A = DenseMatrix(n, m);
+    B = DenseMatrix(m, p);
+    C = DenseMatrix(n, p);
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < m; j++)
+            if ((i + j) % 5 == 0)
+                A.set(i, j, integer(0));
+            else
+                A.set(i, j, add(x, integer(int((i * j) % 7))));
+    for (unsigned i = 0; i < m; i++)
+        for (unsigned j = 0; j < p; j++)
+            if ((i + 2 * j) % 3 == 0)
+                B.set(i, j, mul(x, integer(int(j))));
+            else
+                B.set(i, j, integer(int(i) - int(j)));
+    mul_dense_dense(A, B, C);
+
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < p; j++) {
+            vec_basic terms;
+            for (unsigned k = 0; k < m; k++)
+                terms.push_back(mul(A.get(i, k), B.get(k, j)));
+            REQUIRE(eq(*C.get(i, j), *add(terms)));
+        }
+
+    // Zero times a ComplexDouble or oo is not an exact zero
+    A = DenseMatrix(1, 2, {integer(0), x});
+    B = DenseMatrix(2, 3, {complex_double(std::complex<double>(1, 2)), Inf,
+                           integer(1), integer(0), integer(0), x});
+    C = DenseMatrix(1, 3);
+    mul_dense_dense(A, B, C);
+    REQUIRE(eq(*C.get(0, 0), *complex_double(std::complex<double>(0, 0))));
+    REQUIRE(eq(*C.get(0, 1), *Nan));
+    REQUIRE(eq(*C.get(0, 2), *pow(x, integer(2))));
 }
 
 TEST_CASE("test_elementwise_dense_dense_multiplication(): matrices",
@@ -691,6 +738,13 @@ TEST_CASE("test_pivoted_gaussian_elimination(): matrices", "[matrices]")
                            {integer(1), integer(1), integer(1), integer(0),
                             integer(1), integer(2), integer(0), integer(0),
                             integer(3)}));
+
+    // Zero times oo is not an exact zero
+    A = DenseMatrix(2, 2, {integer(1), Inf, integer(0), integer(1)});
+    B = DenseMatrix(2, 2);
+    pivoted_gaussian_elimination(A, B, pl);
+
+    REQUIRE(B == DenseMatrix(2, 2, {integer(1), Inf, integer(0), Nan}));
 }
 
 TEST_CASE("test_fraction_free_gaussian_elimination(): matrices", "[matrices]")
@@ -1679,6 +1733,21 @@ TEST_CASE("test_determinant(): matrices", "[matrices]")
                            integer(1)});
     REQUIRE(eq(*det_bareis(M), *integer(350)));
 
+    // Large enough for the elimination steps to be split across threads
+    unsigned n = 20;
+    M = DenseMatrix(n, n);
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < n; j++)
+            M.set(i, j,
+                  i == j ? integer(int(100 + i))
+                         : integer(int((7 * i + 3 * j) % 11) - 5));
+    RCP<const Basic> d = det_bareis(M);
+    REQUIRE(eq(*d, *det_berkowitz(M)));
+
+    DenseMatrix LU = DenseMatrix(n, n);
+    fraction_free_LU(M, LU);
+    REQUIRE(eq(*LU.get(n - 1, n - 1), *d));
+
     CHECK_THROWS_AS(M.rank(), NotImplementedError);
 }
 
@@ -1733,6 +1802,14 @@ TEST_CASE("test_berkowitz(): matrices", "[matrices]")
     REQUIRE(polys[1]
             == DenseMatrix(3, 1, {integer(1), integer(-3), integer(1)}));
     REQUIRE(polys[0] == DenseMatrix(2, 1, {integer(1), integer(-1)}));
+
+    polys.clear();
+
+    // Zero times oo is not an exact zero
+    M = DenseMatrix(2, 2, {Inf, integer(0), integer(0), integer(1)});
+    berkowitz(M, polys);
+
+    REQUIRE(polys[1] == DenseMatrix(3, 1, {Nan, mul(minus_one, Inf), Inf}));
 }
 
 TEST_CASE("test_solve_functions(): matrices", "[matrices]")
@@ -1893,6 +1970,114 @@ TEST_CASE("test_inverse(): matrices", "[matrices]")
     REQUIRE(C == I2);
 }
 
+TEST_CASE("test_numeric_fast_paths(): matrices", "[matrices]")
+{
+    RCP<const Basic> x = symbol("x");
+    DenseMatrix I3 = DenseMatrix(3, 3);
+    eye(I3);
+
+    // Integer entries
+    DenseMatrix A = DenseMatrix(3, 3, {integer(2), integer(3), integer(5),
+                                       integer(3), integer(6), integer(2),
+                                       integer(8), integer(3), integer(6)});
+    RCP<const Basic> d;
+    REQUIRE(numeric_det(A, d));
+    REQUIRE(eq(*d, *det_bareis(A)));
+    REQUIRE(eq(*A.det(), *integer(-141)));
+
+    DenseMatrix B = DenseMatrix(3, 3), C = DenseMatrix(3, 3);
+    A.inv(B);
+    mul_dense_dense(A, B, C);
+    REQUIRE(C == I3);
+    A.mul_matrix(B, C);
+    REQUIRE(C == I3);
+
+    // A zero leading pivot needs row exchanges
+    A = DenseMatrix(3, 3, {integer(0), integer(1), integer(2), integer(1),
+                           rational(1, 2), integer(0), integer(3), integer(0),
+                           rational(-2, 3)});
+    DenseMatrix b = DenseMatrix(3, 1, {integer(1), rational(3, 4), integer(2)});
+    DenseMatrix X = DenseMatrix(3, 1), Y = DenseMatrix(3, 1);
+    A.LU_solve(b, X);
+    mul_dense_dense(A, X, Y);
+    REQUIRE(Y == b);
+    REQUIRE(eq(*A.det(), *det_bareis(A)));
+
+    // Singular matrices fall back to the symbolic algorithms
+    A = DenseMatrix(2, 2, {integer(1), integer(2), integer(2), integer(4)});
+    B = DenseMatrix(2, 2);
+    REQUIRE(not numeric_inverse(A, B));
+    REQUIRE(eq(*A.det(), *integer(0)));
+
+    // RealDouble entries
+    A = DenseMatrix(2, 2, {real_double(0.0), real_double(2.0),
+                           real_double(4.0), real_double(1.0)});
+    d = A.det();
+    REQUIRE(is_a<RealDouble>(*d));
+    CHECK(std::abs(down_cast<const RealDouble &>(*d).i + 8.0) < 1e-12);
+    A.inv(B);
+    REQUIRE(is_a<RealDouble>(*B.get(0, 0)));
+    CHECK(std::abs(down_cast<const RealDouble &>(*B.get(0, 0)).i + 0.125)
+          < 1e-12);
+    CHECK(std::abs(down_cast<const RealDouble &>(*B.get(1, 0)).i - 0.5)
+          < 1e-12);
+    C = DenseMatrix(2, 2);
+    A.mul_matrix(A, C);
+    REQUIRE(is_a<RealDouble>(*C.get(1, 1)));
+    CHECK(std::abs(down_cast<const RealDouble &>(*C.get(1, 1)).i - 9.0)
+          < 1e-12);
+
+    // Exact and RealDouble entries mixed in a product keep the symbolic
+    // result types
+    A = DenseMatrix(2, 2,
+                    {integer(1), integer(0), integer(0), real_double(2.0)});
+    B = DenseMatrix(2, 2, {integer(3), integer(0), integer(0), integer(4)});
+    REQUIRE(not numeric_mul(A, B, C));
+    A.mul_matrix(B, C);
+    REQUIRE(is_a<Integer>(*C.get(0, 0)));
+
+    // and so do inverses and solutions of mixed systems
+    A = DenseMatrix(2, 2,
+                    {real_double(2.0), integer(0), integer(0), integer(1)});
+    REQUIRE(not numeric_inverse(A, B));
+    REQUIRE(not numeric_det(A, d));
+    A.inv(B);
+    inverse_pivoted_LU(A, C);
+    REQUIRE(B == C);
+    REQUIRE(is_a<Integer>(*B.get(1, 1)));
+    b = DenseMatrix(2, 1, {integer(1), integer(3)});
+    X = DenseMatrix(2, 1);
+    Y = DenseMatrix(2, 1);
+    REQUIRE(not numeric_LU_solve(A, b, X));
+    A.LU_solve(b, X);
+    LU_solve(A, b, Y);
+    REQUIRE(X == Y);
+    REQUIRE(is_a<Integer>(*X.get(1, 0)));
+
+    // Symbolic entries are left to the generic code
+    A = DenseMatrix(2, 2, {x, integer(1), integer(2), integer(3)});
+    REQUIRE(not numeric_det(A, d));
+    REQUIRE(eq(*A.det(), *sub(mul(integer(3), x), integer(2))));
+    CHECK_THROWS_AS(det_multimodular(A), SymEngineException);
+
+    // Large entries exercise the multimodular determinant
+    unsigned n = 12;
+    A = DenseMatrix(n, n);
+    for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < n; j++)
+            A.set(i, j,
+                  integer(int((i * 7919 + j * 104729 + i * j * 1299709)
+                              % 2147483647)
+                          - 1073741823));
+    REQUIRE(eq(*det_multimodular(A), *det_bareis(A)));
+    REQUIRE(eq(*A.det(), *det_bareis(A)));
+    A.set(3, 0, integer(0));
+    A.set(3, 1, integer(0));
+    for (unsigned j = 0; j < n; j++)
+        A.set(5, j, A.get(2, j));
+    REQUIRE(eq(*det_multimodular(A), *integer(0)));
+}
+
 TEST_CASE("test_dot(): matrices", "[matrices]")
 {
     DenseMatrix A = DenseMatrix(1, 3);
@@ -2153,6 +2338,240 @@ TEST_CASE("test_csr_elementwise_mul(): matrices", "[matrices]")
                           integer(25), integer(36)}));
 }
 
+// A symbolic banded matrix with a few entries far from the diagonal
+static CSRMatrix sparse_test_matrix(unsigned n)
+{
+    RCP<const Basic> x = symbol("x"), y = symbol("y"), z = symbol("z");
+    std::vector<unsigned> i, j;
+    vec_basic v;
+    for (unsigned k = 0; k < n; k++) {
+        i.push_back(k);
+        j.push_back(k);
+        v.push_back(add(x, integer(k)));
+        if (k + 1 < n) {
+            i.push_back(k);
+            j.push_back(k + 1);
+            v.push_back(y);
+            i.push_back(k + 1);
+            j.push_back(k);
+            v.push_back(mul(z, integer(k + 1)));
+        }
+        if (k % 3 == 0 and k + 5 < n) {
+            i.push_back(k + 5);
+            j.push_back(k);
+            v.push_back(integer(1));
+        }
+    }
+    return CSRMatrix::from_coo(n, n, i, j, v);
+}
+
+TEST_CASE("test_csr_det(): matrices", "[matrices]")
+{
+    // The diagonal is zero, so the rows have to be permuted
+    CSRMatrix A = CSRMatrix(4, 4, {0, 2, 4, 6, 8}, {1, 3, 0, 2, 1, 3, 0, 2},
+                            {integer(2), integer(1), integer(3), integer(-1),
+                             integer(5), integer(4), integer(1), integer(7)});
+    REQUIRE(eq(*A.det(), *csr_to_dense(A).det()));
+    REQUIRE(eq(*A.det(), *integer(66)));
+
+    // Structurally singular
+    A = CSRMatrix(3, 3, {0, 2, 4, 4}, {0, 1, 0, 1},
+                  {integer(1), integer(2), integer(3), integer(4)});
+    REQUIRE(eq(*A.det(), *integer(0)));
+
+    // The second pivot is zero, which is only known from the values
+    A = CSRMatrix(3, 3, {0, 2, 5, 7}, {0, 1, 0, 1, 2, 1, 2},
+                  {integer(1), integer(1), integer(1), integer(1), integer(1),
+                   integer(1), integer(1)});
+    REQUIRE(eq(*A.det(), *integer(-1)));
+
+    A = CSRMatrix(0, 0);
+    REQUIRE(eq(*A.det(), *one));
+
+    map_basic_basic values = {{symbol("x"), integer(10)},
+                              {symbol("y"), integer(-1)},
+                              {symbol("z"), rational(1, 3)}};
+    for (unsigned n : {1, 2, 5, 12}) {
+        A = sparse_test_matrix(n);
+        RCP<const Basic> d1 = A.det()->subs(values);
+        RCP<const Basic> d2 = csr_to_dense(A).det()->subs(values);
+        REQUIRE(eq(*d1, *d2));
+    }
+}
+
+TEST_CASE("test_csr_LU_solve(): matrices", "[matrices]")
+{
+    map_basic_basic values = {{symbol("x"), integer(10)},
+                              {symbol("y"), integer(-1)},
+                              {symbol("z"), rational(1, 3)}};
+    const unsigned n = 12;
+    CSRMatrix A = sparse_test_matrix(n);
+    DenseMatrix b(n, 2), x1(n, 2), x2(n, 2);
+    for (unsigned i = 0; i < n; i++) {
+        b.set(i, 0, integer(i));
+        b.set(i, 1, symbol("y"));
+    }
+    A.LU_solve(b, x1);
+    csr_to_dense(A).LU_solve(b, x2);
+    for (unsigned i = 0; i < n; i++) {
+        for (unsigned j = 0; j < 2; j++) {
+            REQUIRE(eq(*x1.get(i, j)->subs(values),
+                       *x2.get(i, j)->subs(values)));
+        }
+    }
+
+    // The analysis can be reused for matrices with the same pattern
+    SparseLUAnalysis analysis(A);
+    REQUIRE(not analysis.is_structurally_singular());
+    REQUIRE(analysis.size() == n);
+    REQUIRE(analysis.nnz() >= std::get<1>(A.as_vectors()).size());
+    auto vectors = A.as_vectors();
+    for (auto &e : std::get<2>(vectors)) {
+        e = e->subs(values);
+    }
+    CSRMatrix B(n, n, std::get<0>(vectors), std::get<1>(vectors),
+                std::get<2>(vectors));
+    REQUIRE(analysis.matches(B));
+    SparseLU lu(analysis, B);
+    REQUIRE(not lu.has_zero_pivot());
+    REQUIRE(eq(*lu.det(), *csr_to_dense(B).det()));
+    lu.solve(b, x1);
+    for (unsigned i = 0; i < n; i++) {
+        REQUIRE(eq(*x1.get(i, 0), *x2.get(i, 0)->subs(values)));
+    }
+
+    CHECK_THROWS_AS(SparseLU(analysis, CSRMatrix(n, n)), SymEngineException);
+
+    // Structurally singular
+    A = CSRMatrix(2, 2, {0, 2, 2}, {0, 1}, {integer(1), integer(2)});
+    b = DenseMatrix(2, 1, {integer(1), integer(2)});
+    x1 = DenseMatrix(2, 1);
+    CHECK_THROWS_AS(A.LU_solve(b, x1), SymEngineException);
+}
+
+TEST_CASE("test_csr_add_matrix(): matrices", "[matrices]")
+{
+    RCP<const Symbol> x = symbol("x"), y = symbol("y");
+    CSRMatrix A = CSRMatrix(3, 3, {0, 2, 3, 5}, {0, 2, 1, 0, 2},
+                            {x, integer(2), y, integer(-1), integer(3)});
+    CSRMatrix B = CSRMatrix(3, 3, {0, 1, 2, 4}, {2, 0, 0, 1},
+                            {integer(-2), x, integer(1), y});
+    DenseMatrix Ad = csr_to_dense(A), Bd = csr_to_dense(B);
+    DenseMatrix expected(3, 3), D(3, 3);
+    Ad.add_matrix(Bd, expected);
+
+    CSRMatrix C(3, 3);
+    A.add_matrix(B, C);
+    REQUIRE(C.is_canonical());
+    // The entries at (0, 2) and (2, 0) cancel
+    REQUIRE(std::get<1>(C.as_vectors()).size() == 5);
+    REQUIRE(C == expected);
+
+    A.add_matrix(B, D);
+    REQUIRE(D == expected);
+    A.add_matrix(Bd, D);
+    REQUIRE(D == expected);
+    Ad.add_matrix(B, D);
+    REQUIRE(D == expected);
+    A.add_matrix(Bd, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(C == expected);
+
+    Ad.add_scalar(x, expected);
+    A.add_scalar(x, D);
+    REQUIRE(D == expected);
+    A.add_scalar(x, C);
+    REQUIRE(C == expected);
+    A.add_scalar(integer(0), C);
+    REQUIRE(C == A);
+
+    Ad.mul_scalar(y, expected);
+    A.mul_scalar(y, C);
+    REQUIRE(C == expected);
+    A.mul_scalar(y, D);
+    REQUIRE(D == expected);
+    A.mul_scalar(integer(0), C);
+    REQUIRE(C == CSRMatrix(3, 3));
+
+    Ad.elementwise_mul_matrix(Bd, expected);
+    A.elementwise_mul_matrix(Bd, C);
+    REQUIRE(C == expected);
+    Ad.elementwise_mul_matrix(B, C);
+    REQUIRE(C == expected);
+    C = CSRMatrix(3, 3);
+    Ad.elementwise_mul_matrix(Bd, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(C == expected);
+
+    Ad.add_matrix(Bd, expected);
+    C = CSRMatrix(3, 3);
+    Ad.add_matrix(Bd, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(std::get<1>(C.as_vectors()).size() == 5);
+    REQUIRE(C == expected);
+}
+
+TEST_CASE("test_csr_mul_matrix(): matrices", "[matrices]")
+{
+    RCP<const Symbol> x = symbol("x"), y = symbol("y");
+    // 2 x 3 times 3 x 4
+    CSRMatrix A = CSRMatrix(2, 3, {0, 2, 4}, {0, 2, 1, 2},
+                            {x, integer(1), integer(2), y});
+    CSRMatrix B = CSRMatrix(3, 4, {0, 2, 3, 5}, {1, 3, 0, 1, 3},
+                            {integer(1), y, x, integer(-1),
+                             mul(integer(-1), mul(x, y))});
+    DenseMatrix Ad = csr_to_dense(A), Bd = csr_to_dense(B);
+    DenseMatrix expected(2, 4), D(2, 4);
+    Ad.mul_matrix(Bd, expected);
+
+    CSRMatrix C(2, 4);
+    A.mul_matrix(B, C);
+    REQUIRE(C.is_canonical());
+    // The entry at (0, 3) is x*y - x*y
+    REQUIRE(std::get<1>(C.as_vectors()).size() == 4);
+    REQUIRE(C == expected);
+
+    A.mul_matrix(B, D);
+    REQUIRE(D == expected);
+    A.mul_matrix(Bd, D);
+    REQUIRE(D == expected);
+    Ad.mul_matrix(B, D);
+    REQUIRE(D == expected);
+    // Products with a dense factor stored in a CSRMatrix
+    A.mul_matrix(Bd, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(C == expected);
+    C = CSRMatrix(2, 4);
+    Ad.mul_matrix(B, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(C == expected);
+    C = CSRMatrix(2, 4);
+    Ad.mul_matrix(Bd, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(std::get<1>(C.as_vectors()).size() == 4);
+    REQUIRE(C == expected);
+
+    // A larger product, compared with the dense one
+    const unsigned n = 30;
+    std::vector<unsigned> i, j;
+    vec_basic v;
+    for (unsigned k = 0; k < n; k++) {
+        for (unsigned l : {k, (3 * k + 1) % n, (7 * k + 5) % n}) {
+            i.push_back(k);
+            j.push_back(l);
+            v.push_back(add(x, integer(k + l)));
+        }
+    }
+    A = CSRMatrix::from_coo(n, n, i, j, v);
+    Ad = csr_to_dense(A);
+    expected = DenseMatrix(n, n);
+    Ad.mul_matrix(Ad, expected);
+    C = CSRMatrix(n, n);
+    A.mul_matrix(A, C);
+    REQUIRE(C.is_canonical());
+    REQUIRE(C == expected);
+}
+
 TEST_CASE("test_eye(): matrices", "[matrices]")
 {
     DenseMatrix A(3, 3);
@@ -2396,6 +2815,47 @@ TEST_CASE("Test Jacobian", "[matrices]")
     }
 }
 
+TEST_CASE("Test Jacobian of a larger system", "[matrices]")
+{
+    // Each equation depends on its neighbours in a chain, some of them share
+    // a subexpression and some of them contain a Derivative, whose symbols
+    // are not looked for
+    const unsigned n = 40;
+    vec_basic xs, exprs;
+    vec_sym syms;
+    for (unsigned i = 0; i < n; i++) {
+        syms.push_back(symbol("x" + std::to_string(i)));
+        xs.push_back(syms.back());
+    }
+    RCP<const Basic> shared = sin(add(xs[0], mul(integer(2), xs[1])));
+    for (unsigned i = 0; i < n; i++) {
+        RCP<const Basic> e = add(mul(xs[i], xs[(i + 1) % n]),
+                                 pow(xs[(i + n - 1) % n], integer(3)));
+        if (i % 7 == 0) {
+            e = mul(e, shared);
+        }
+        if (i % 11 == 0) {
+            e = add(e, function_symbol("f", xs[i])->diff(syms[i]));
+        }
+        exprs.push_back(e);
+    }
+
+    DenseMatrix A(n, 1, exprs), X(n, 1, xs), J(n, n);
+    jacobian(A, X, J);
+    for (unsigned i = 0; i < n; i++) {
+        vec_basic row = diff(exprs[i], syms);
+        for (unsigned j = 0; j < n; j++) {
+            RCP<const Basic> d = exprs[i]->diff(syms[j]);
+            REQUIRE(eq(*J.get(i, j), *d));
+            REQUIRE(eq(*row[j], *d));
+        }
+    }
+    REQUIRE(CSRMatrix::jacobian(A, X) == J);
+    DenseMatrix sJ(n, n);
+    sjacobian(A, X, sJ);
+    REQUIRE(sJ == J);
+}
+
 TEST_CASE("Test Diff", "[matrices]")
 {
     DenseMatrix A, J;
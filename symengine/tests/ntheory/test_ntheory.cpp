@@ -8,6 +8,10 @@
 #include <symengine/mul.h>
 #include <symengine/real_double.h>
 
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+#include <thread>
+#endif
+
 using SymEngine::Basic;
 using SymEngine::bernoulli;
 using SymEngine::carmichael;
@@ -370,6 +374,57 @@ TEST_CASE("test_sieve_iterator(): ntheory", "[ntheory]")
     REQUIRE(count == 9593);
 }
 
+TEST_CASE("test_sieve_segments(): ntheory", "[ntheory]")
+{
+    // Several segments of the default size, sieved with and without threads
+    const unsigned MAX = 10000019;
+    std::vector<unsigned> v, w;
+    SymEngine::Sieve::generate_primes(v, MAX);
+    SymEngine::Sieve::generate_primes(w, MAX, 1);
+    REQUIRE(v.size() == 664580);
+    REQUIRE(v == w);
+    REQUIRE(v.back() == 10000019);
+
+    // Small segments, kept in the cache between calls
+    SymEngine::Sieve::set_sieve_size(1);
+    SymEngine::Sieve::set_clear(false);
+    w.clear();
+    SymEngine::Sieve::generate_primes(w, 1000000);
+    REQUIRE(w.size() == 78498);
+    w.clear();
+    SymEngine::Sieve::generate_primes(w, 100003);
+    REQUIRE(w.size() == 9593);
+    SymEngine::Sieve::clear();
+    SymEngine::Sieve::set_clear(true);
+    SymEngine::Sieve::set_sieve_size(32);
+
+    // The iterator agrees with generate_primes and goes on without a limit
+    SymEngine::Sieve::iterator pi;
+    for (unsigned p : v)
+        REQUIRE(pi.next_prime() == p);
+    REQUIRE(pi.next_prime() == 10000079);
+}
+
+#if defined(WITH_SYMENGINE_THREAD_SAFE)
+TEST_CASE("test_sieve_iterator threads(): ntheory", "[ntheory]")
+{
+    const unsigned MAX = 2000003;
+    std::vector<unsigned> counts(4);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < counts.size(); i++) {
+        threads.emplace_back([&counts, i, MAX]() {
+            SymEngine::Sieve::iterator pi(MAX);
+            while (pi.next_prime() <= MAX)
+                counts[i]++;
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    for (unsigned c : counts)
+        REQUIRE(c == 148934);
+}
+#endif
+
 // helper function for test_primefactors
 void _test_primefactors(const RCP<const Integer> &a, unsigned size)
 {
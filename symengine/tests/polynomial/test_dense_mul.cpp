@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include <symengine/polys/dense_mul.h>
+#include <symengine/polys/uintpoly.h>
+
+using SymEngine::detail::dense_divrem_mod;
+using SymEngine::detail::dense_inv_series_mod;
+using SymEngine::dense_mul;
+using SymEngine::detail::dense_mul_mod;
+using SymEngine::dense_mul_uses_ntt;
+using SymEngine::integer_class;
+using SymEngine::map_uint_mpz;
+using SymEngine::ODictWrapper;
+using SymEngine::UIntDict;
+using SymEngine::detail::vec_word;
+using SymEngine::detail::WordModulus;
+
+using namespace SymEngine::literals;
+
+namespace
+{
+
+uint64_t next_random(uint64_t &s)
+{
+    s = s * 6364136223846793005ull + 1442695040888963407ull;
+    return s >> 33;
+}
+
+vec_word random_words(size_t n, uint64_t p, uint64_t &s)
+{
+    vec_word v(n);
+    for (auto &c : v)
+        c = (next_random(s) << 16 ^ next_random(s)) % p;
+    v.back() = p - 1;
+    return v;
+}
+
+} // namespace
+
+TEST_CASE("Schoolbook, Karatsuba and NTT products modulo a word",
+          "[dense_mul]")
+{
+    uint64_t s = 42;
+    for (uint64_t p : {uint64_t(7), uint64_t(1000003), uint64_t(4294967291)}) {
+        const WordModulus m(p);
+        for (size_t n : {size_t(5), size_t(70), size_t(300), size_t(4100)}) {
+            vec_word a = random_words(n, p, s);
+            vec_word b = random_words(n, p, s);
+            vec_word c = dense_mul_mod(a, b, m);
+            REQUIRE(c.size() == a.size() + b.size() - 1);
+            // Compare with the schoolbook product computed one reduced
+            // product at a time
+            vec_word ref(c.size(), 0);
+            for (size_t i = 0; i < a.size(); i++)
+                for (size_t j = 0; j < b.size(); j++)
+                    ref[i + j] = m.add(ref[i + j], m.mul(a[i], b[j]));
+            REQUIRE(c == ref);
+        }
+    }
+}
+
+TEST_CASE("Newton inversion and division modulo a word", "[dense_mul]")
+{
+    uint64_t s = 7;
+    const uint64_t p = 4294967291;
+    const WordModulus m(p);
+    vec_word a = random_words(5000, p, s);
+    vec_word b = random_words(2100, p, s);
+
+    vec_word inv = dense_inv_series_mod(b, 200, m);
+    REQUIRE(inv.size() == 200);
+    vec_word e = dense_mul_mod(b, inv, m);
+    e.resize(200);
+    vec_word one(200, 0);
+    one[0] = 1;
+    REQUIRE(e == one);
+
+    vec_word r = a, q;
+    dense_divrem_mod(r, b, m, &q);
+    REQUIRE(q.size() == a.size() - b.size() + 1);
+    REQUIRE(r.size() < b.size());
+    vec_word qb = dense_mul_mod(q, b, m);
+    for (size_t i = 0; i < r.size(); i++)
+        qb[i] = m.add(qb[i], r[i]);
+    REQUIRE(qb == a);
+}
+
+TEST_CASE("Integer products with transforms", "[dense_mul]")
+{
+    uint64_t s = 3;
+    for (unsigned bits : {16u, 48u, 160u}) {
+        std::vector<integer_class> a(200), b(150);
+        for (auto *v : {&a, &b}) {
+            for (auto &c : *v) {
+                c = 0;
+                for (unsigned k = 0; k < bits; k += 16) {
+                    c <<= 16;
+                    c += integer_class(static_cast<unsigned long>(
+                        next_random(s) & 0xFFFF));
+                }
+                if (next_random(s) & 1)
+                    c = -c;
+            }
+        }
+        REQUIRE(dense_mul_uses_ntt(a.size(), b.size(), bits, bits)
+                == (bits != 160u));
+        std::vector<integer_class> c = dense_mul(a, b);
+        std::vector<integer_class> ref(a.size() + b.size() - 1);
+        for (size_t i = 0; i < a.size(); i++)
+            for (size_t j = 0; j < b.size(); j++)
+                ref[i + j] += a[i] * b[j];
+        REQUIRE(c == ref);
+    }
+
+    map_uint_mpz m;
+    for (unsigned i = 0; i < 100; i++)
+        m[i] = integer_class(long(i % 7) - 3);
+    UIntDict h(m);
+    REQUIRE(UIntDict::mul(h, h)
+            == ODictWrapper<unsigned int, integer_class, UIntDict>::mul(h, h));
+
+    // (1 + x)**300 has coefficients up to about 2**296
+    UIntDict f({{0, 1_z}, {1, 1_z}});
+    UIntDict g = UIntDict::pow(f, 150);
+    REQUIRE(UIntDict::mul(g, g) == UIntDict::mul_dense(g, g));
+    REQUIRE(UIntDict::mul(g, g) == UIntDict::pow(f, 300));
+}
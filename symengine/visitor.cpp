@@ -16,40 +16,209 @@ namespace SymEngine
 #include "symengine/type_codes.inc"
 #undef SYMENGINE_ENUM
 
+bool ArgView::for_each_arg_of(const Basic &b, const RCP<const Basic> &owner,
+                              const std::function<bool(const ArgView &)> &f)
+{
+    // Same order as Add::for_each_arg() and Mul::for_each_arg()
+    if (is_a<Add>(b)) {
+        const Add &x = down_cast<const Add &>(b);
+        if (not x.get_coef()->is_zero()) {
+            if (not f(ArgView(x.get_coef())))
+                return false;
+        }
+        for (const auto &p : x.get_dict()) {
+            if (eq(*p.second, *one)) {
+                if (not f(ArgView(p.first)))
+                    return false;
+            } else {
+                if (not f(ArgView(owner, &p, nullptr)))
+                    return false;
+            }
+        }
+        return true;
+    } else if (is_a<Mul>(b)) {
+        const Mul &x = down_cast<const Mul &>(b);
+        if (not x.get_coef()->is_one()) {
+            if (not f(ArgView(x.get_coef())))
+                return false;
+        }
+        for (const auto &p : x.get_dict()) {
+            if (eq(*p.second, *one)) {
+                if (not f(ArgView(p.first)))
+                    return false;
+            } else {
+                if (not f(ArgView(owner, nullptr, &p)))
+                    return false;
+            }
+        }
+        return true;
+    }
+    return b.for_each_arg(
+        [&f](const RCP<const Basic> &p) { return f(ArgView(p)); });
+}
+
+TypeID ArgView::get_type_code() const
+{
+    if (arg_ != nullptr) {
+        return arg_->get_type_code();
+    }
+    return term_ != nullptr ? SYMENGINE_MUL : SYMENGINE_POW;
+}
+
+RCP<const Basic> ArgView::get() const
+{
+    if (arg_ != nullptr) {
+        return owner_.is_null() ? arg_->rcp_from_this() : owner_;
+    } else if (term_ != nullptr) {
+        return Add::from_dict(zero, {{term_->first, term_->second}});
+    } else {
+        return make_rcp<const Pow>(factor_->first, factor_->second);
+    }
+}
+
+hash_t ArgView::hash() const
+{
+    if (arg_ != nullptr) {
+        return arg_->hash();
+    }
+    hash_t seed;
+    if (term_ != nullptr) {
+        // Same as Mul::__hash__() for the Mul created by Add::from_dict()
+        const Basic &t = *term_->first;
+        seed = SYMENGINE_MUL;
+        hash_combine<Basic>(seed, *term_->second);
+        if (is_a<Mul>(t)) {
+            for (const auto &p : down_cast<const Mul &>(t).get_dict()) {
+                hash_combine<Basic>(seed, *p.first);
+                hash_combine<Basic>(seed, *p.second);
+            }
+        } else if (is_a<Pow>(t)) {
+            hash_combine<Basic>(seed, *down_cast<const Pow &>(t).get_base());
+            hash_combine<Basic>(seed, *down_cast<const Pow &>(t).get_exp());
+        } else {
+            hash_combine<Basic>(seed, t);
+            hash_combine<Basic>(seed, *one);
+        }
+    } else {
+        seed = SYMENGINE_POW;
+        hash_combine<Basic>(seed, *factor_->first);
+        hash_combine<Basic>(seed, *factor_->second);
+    }
+    SYMENGINE_ASSERT(seed == get()->hash());
+    return seed;
+}
+
+bool ArgView::equals(const ArgView &o) const
+{
+    if (arg_ != nullptr and o.arg_ != nullptr) {
+        return eq(*arg_, *o.arg_);
+    }
+    if (get_type_code() != o.get_type_code()) {
+        return false;
+    }
+    if (term_ != nullptr and o.term_ != nullptr) {
+        // The term determines the dictionary of the Mul
+        return eq(*term_->second, *o.term_->second)
+               and eq(*term_->first, *o.term_->first);
+    }
+    if (factor_ != nullptr and o.factor_ != nullptr) {
+        return eq(*factor_->first, *o.factor_->first)
+               and eq(*factor_->second, *o.factor_->second);
+    }
+    return eq(*get(), *o.get());
+}
+
+void ArgView::accept(Visitor &v) const
+{
+    if (arg_ != nullptr) {
+        arg_->accept(v);
+    } else {
+        get()->accept(v);
+    }
+}
+
+bool ArgView::for_each_arg(const std::function<bool(const ArgView &)> &f) const
+{
+    if (arg_ != nullptr) {
+        return for_each_arg_of(*arg_, owner_, f);
+    } else if (term_ != nullptr) {
+        // The arguments of the Mul `coef*term` are the coefficient and the
+        // factors of the term
+        if (not f(ArgView(term_->second)))
+            return false;
+        if (is_a<Mul>(*term_->first)) {
+            SYMENGINE_ASSERT(
+                down_cast<const Mul &>(*term_->first).get_coef()->is_one());
+            return for_each_arg_of(*term_->first, term_->first, f);
+        }
+        return f(ArgView(term_->first));
+    } else {
+        return f(ArgView(factor_->first)) and f(ArgView(factor_->second));
+    }
+}
+
+/* The traversals walk views of the arguments, so that the terms and factors
+   that Add and Mul do not store are only created to be accepted by the
+   visitor, and not to walk their own arguments. */
+
+static void preorder_traversal(const ArgView &b, Visitor &v)
+{
+    b.accept(v);
+    b.for_each_arg([&v](const ArgView &p) {
+        preorder_traversal(p, v);
+        return true;
+    });
+}
+
 void preorder_traversal(const Basic &b, Visitor &v)
 {
+    preorder_traversal(ArgView(b), v);
+}
+
+static void postorder_traversal(const ArgView &b, Visitor &v)
+{
+    b.for_each_arg([&v](const ArgView &p) {
+        postorder_traversal(p, v);
+        return true;
+    });
     b.accept(v);
-    for (const auto &p : b.get_args())
-        preorder_traversal(*p, v);
 }
 
 void postorder_traversal(const Basic &b, Visitor &v)
 {
-    for (const auto &p : b.get_args())
-        postorder_traversal(*p, v);
+    postorder_traversal(ArgView(b), v);
+}
+
+static void preorder_traversal_stop(const ArgView &b, StopVisitor &v)
+{
     b.accept(v);
+    if (v.stop_)
+        return;
+    b.for_each_arg([&v](const ArgView &p) {
+        preorder_traversal_stop(p, v);
+        return not v.stop_;
+    });
 }
 
 void preorder_traversal_stop(const Basic &b, StopVisitor &v)
 {
-    b.accept(v);
+    preorder_traversal_stop(ArgView(b), v);
+}
+
+static void postorder_traversal_stop(const ArgView &b, StopVisitor &v)
+{
+    b.for_each_arg([&v](const ArgView &p) {
+        postorder_traversal_stop(p, v);
+        return not v.stop_;
+    });
     if (v.stop_)
         return;
-    for (const auto &p : b.get_args()) {
-        preorder_traversal_stop(*p, v);
-        if (v.stop_)
-            return;
-    }
+    b.accept(v);
 }
 
 void postorder_traversal_stop(const Basic &b, StopVisitor &v)
 {
-    for (const auto &p : b.get_args()) {
-        postorder_traversal_stop(*p, v);
-        if (v.stop_)
-            return;
-    }
-    b.accept(v);
+    postorder_traversal_stop(ArgView(b), v);
 }
 
 bool has_basic(const Basic &b, const Basic &x)
@@ -105,13 +274,36 @@ public:
         }
     }
 
+    // The coefficients are numbers, so only the terms and exponents are
+    // visited, without creating the arguments of the Add or Mul
+    void bvisit(const Add &x)
+    {
+        for (const auto &p : x.get_dict()) {
+            visit_arg(p.first);
+        }
+    }
+
+    void bvisit(const Mul &x)
+    {
+        for (const auto &p : x.get_dict()) {
+            visit_arg(p.first);
+            visit_arg(p.second);
+        }
+    }
+
     void bvisit(const Basic &x)
     {
-        for (const auto &p : x.get_args()) {
-            auto iter = v.insert(p->rcp_from_this());
-            if (iter.second) {
-                p->accept(*this);
-            }
+        x.for_each_arg([this](const RCP<const Basic> &p) {
+            visit_arg(p);
+            return true;
+        });
+    }
+
+    void visit_arg(const RCP<const Basic> &p)
+    {
+        auto iter = v.insert(p);
+        if (iter.second) {
+            p->accept(*this);
         }
     }
 
@@ -244,16 +436,21 @@ void TransformVisitor::bvisit(const Piecewise &x)
     result_ = piecewise(new_pairs);
 }
 
-void preorder_traversal_local_stop(const Basic &b, LocalStopVisitor &v)
+static void preorder_traversal_local_stop(const ArgView &b,
+                                          LocalStopVisitor &v)
 {
     b.accept(v);
     if (v.stop_ or v.local_stop_)
         return;
-    for (const auto &p : b.get_args()) {
-        preorder_traversal_local_stop(*p, v);
-        if (v.stop_)
-            return;
-    }
+    b.for_each_arg([&v](const ArgView &p) {
+        preorder_traversal_local_stop(p, v);
+        return not v.stop_;
+    });
+}
+
+void preorder_traversal_local_stop(const Basic &b, LocalStopVisitor &v)
+{
+    preorder_traversal_local_stop(ArgView(b), v);
 }
 
 void CountOpsVisitor::apply(const Basic &b)
@@ -331,9 +528,10 @@ void CountOpsVisitor::bvisit(const Constant &x) {}
 void CountOpsVisitor::bvisit(const Basic &x)
 {
     count++;
-    for (const auto &p : x.get_args()) {
+    x.for_each_arg([this](const RCP<const Basic> &p) {
         apply(*p);
-    }
+        return true;
+    });
 }
 
 unsigned count_ops(const vec_basic &a)
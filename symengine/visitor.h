@@ -40,6 +40,71 @@ public:
 #undef SYMENGINE_ENUM
 };
 
+/*! A view of an argument of an expression, that is of an element of its
+    `get_args()`, which only creates the argument when it is asked for it.
+
+    `Add` does not store its terms `coef*term` whose coefficient is not one,
+    and `Mul` does not store its factors `base**exp` whose exponent is not
+    one. The view of such an argument refers to its entry in the dictionary,
+    and keeps the `Add` or `Mul` alive. The view of any other argument refers
+    to it.
+*/
+class ArgView
+{
+private:
+    //! The argument if it is stored, otherwise the `Add` or `Mul`. It is null
+    //! if the caller keeps the expression alive.
+    RCP<const Basic> owner_;
+    const Basic *arg_ = nullptr;
+    const umap_basic_num::value_type *term_ = nullptr;
+    const map_basic_basic::value_type *factor_ = nullptr;
+
+    ArgView(const RCP<const Basic> &owner,
+            const umap_basic_num::value_type *term,
+            const map_basic_basic::value_type *factor)
+        : owner_(owner), term_(term), factor_(factor)
+    {
+    }
+    // Calls `f` on views of the arguments of `b`, which is kept alive by
+    // `owner` unless it is null
+    static bool for_each_arg_of(const Basic &b, const RCP<const Basic> &owner,
+                                const std::function<bool(const ArgView &)> &f);
+
+public:
+    //! A view of `arg`, which the caller keeps alive
+    explicit ArgView(const Basic &arg) : arg_(&arg) {}
+    //! A view of `arg`, which the view keeps alive
+    explicit ArgView(const RCP<const Basic> &arg) : owner_(arg), arg_(arg.get())
+    {
+    }
+
+    //! Whether the argument is stored in the expression
+    inline bool is_stored() const
+    {
+        return arg_ != nullptr;
+    }
+    //! The stored argument. Only valid if `is_stored()`.
+    inline const Basic &stored() const
+    {
+        SYMENGINE_ASSERT(is_stored());
+        return *arg_;
+    }
+    //! The type code of the argument
+    TypeID get_type_code() const;
+    //! The argument, which is created if it is not stored
+    RCP<const Basic> get() const;
+    //! Same as `get()->hash()`, without creating the argument
+    hash_t hash() const;
+    //! Same as `eq(*get(), *o.get())`. The arguments are only created when one
+    //! of them is stored and the other is not.
+    bool equals(const ArgView &o) const;
+    //! Calls `get()->accept(v)`
+    void accept(Visitor &v) const;
+    //! Calls `f` on views of the elements of `get()->get_args()`, in the same
+    //! order, until it returns false. Returns false if it stopped that way.
+    bool for_each_arg(const std::function<bool(const ArgView &)> &f) const;
+};
+
 void preorder_traversal(const Basic &b, Visitor &v);
 void postorder_traversal(const Basic &b, Visitor &v);
 
@@ -137,15 +202,45 @@ public:
             has_ = true;
             stop_ = true;
         }
+        bvisit(static_cast<const Basic &>(x));
+    }
+
+    // The coefficients are numbers, so only the terms and exponents are
+    // searched, without creating the arguments of the Add or Mul
+    void bvisit(const Add &x)
+    {
+        for (const auto &p : x.get_dict()) {
+            if (stop_)
+                return;
+            p.first->accept(*this);
+        }
     }
 
-    void bvisit(const Basic &x) {}
+    void bvisit(const Mul &x)
+    {
+        for (const auto &p : x.get_dict()) {
+            if (stop_)
+                return;
+            p.first->accept(*this);
+            if (stop_)
+                return;
+            p.second->accept(*this);
+        }
+    }
+
+    void bvisit(const Basic &x)
+    {
+        x.for_each_arg([this](const RCP<const Basic> &p) {
+            p->accept(*this);
+            return not stop_;
+        });
+    }
 
     bool apply(const Basic &b)
     {
         has_ = false;
         stop_ = false;
-        preorder_traversal_stop(b, *this);
+        b.accept(*this);
         return has_;
     }
 };
@@ -319,12 +414,26 @@ public:
 
     void bvisit(const Basic &x)
     {
-        for (const auto &p : x.get_args()) {
-            auto iter = visited.insert(p->rcp_from_this());
-            if (iter.second) {
-                p->accept(*this);
+        visit_args(ArgView(x));
+    }
+
+    // The terms and factors that Add and Mul do not store are only created
+    // if they can be atoms, otherwise their arguments are visited
+    void visit_args(const ArgView &x)
+    {
+        x.for_each_arg([this](const ArgView &p) {
+            if (p.is_stored() or is_base_of_multiple<Mul, Args...>::value
+                or is_base_of_multiple<Pow, Args...>::value) {
+                auto arg = p.get();
+                auto iter = visited.insert(arg);
+                if (iter.second) {
+                    arg->accept(*this);
+                }
+            } else {
+                visit_args(p);
             }
-        }
+            return true;
+        });
     }
 
     set_basic apply(const Basic &b)